@@ -39,6 +39,13 @@
 #include <string.h>
 #include "crypto.h"
 #include "aes.h"
+#include "cpu_features.h"
+
+//AES-NI instruction set support?
+#if (AESNI_SUPPORT == ENABLED)
+   #include <emmintrin.h>
+   #include <wmmintrin.h>
+#endif
 
 //Check crypto library configuration
 #if (AES_SUPPORT == ENABLED)
@@ -186,10 +193,320 @@ const CipherAlgo aesCipherAlgo =
    NULL,
    NULL,
    (CipherAlgoEncryptBlock) aesEncryptBlock,
-   (CipherAlgoDecryptBlock) aesDecryptBlock
+   (CipherAlgoDecryptBlock) aesDecryptBlock,
+   (CipherAlgoEncryptBlocks) aesEncryptBlocks,
+   (CipherAlgoDecryptBlocks) aesDecryptBlocks
 };
 
 
+//AES-NI instruction set support?
+#if (AESNI_SUPPORT == ENABLED)
+
+/**
+ * @brief Key expansion using AES-NI instructions
+ * @param[in] context Pointer to the AES context
+ * @param[in] keyLength Number of 32-bit words in the key
+ **/
+
+CPU_TARGET("aes,sse2") static void aesniKeyExpansion(AesContext *context,
+   uint_t keyLength)
+{
+   uint_t i;
+   uint32_t temp;
+   size_t keyScheduleSize;
+   __m128i t;
+
+   //The size of the key schedule depends on the number of rounds
+   keyScheduleSize = 4 * (context->nr + 1);
+
+   //Generate the key schedule (encryption)
+   for(i = keyLength; i < keyScheduleSize; i++)
+   {
+      //Save previous word
+      temp = context->ek[i - 1];
+
+      //Apply transformation
+      if((i % keyLength) == 0 || (keyLength > 6 && (i % keyLength) == 4))
+      {
+         //AESKEYGENASSIST computes SubWord(X) in the first dword and
+         //RotWord(SubWord(X)) in the second dword of the result
+         t = _mm_aeskeygenassist_si128(_mm_set1_epi32((int) temp), 0x00);
+
+         //Select the relevant transformation
+         if((i % keyLength) == 0)
+         {
+            t = _mm_shuffle_epi32(t, 0x55);
+            temp = (uint32_t) _mm_cvtsi128_si32(t) ^ rcon[i / keyLength];
+         }
+         else
+         {
+            temp = (uint32_t) _mm_cvtsi128_si32(t);
+         }
+      }
+
+      //Update the key schedule
+      context->ek[i] = temp ^ context->ek[i - keyLength];
+   }
+
+   //The first and the last round keys are used as is
+   for(i = 0; i < 4; i++)
+   {
+      context->dk[i] = context->ek[i];
+      context->dk[keyScheduleSize - 4 + i] = context->ek[keyScheduleSize - 4 + i];
+   }
+
+   //Apply the InvMixColumns transformation to the remaining round keys
+   for(i = 4; i < (keyScheduleSize - 4); i += 4)
+   {
+      t = _mm_loadu_si128((__m128i *) (context->ek + i));
+      t = _mm_aesimc_si128(t);
+      _mm_storeu_si128((__m128i *) (context->dk + i), t);
+   }
+}
+
+
+/**
+ * @brief Encrypt a 16-byte block using AES-NI instructions
+ * @param[in] context Pointer to the AES context
+ * @param[in] input Plaintext block to encrypt
+ * @param[out] output Ciphertext block resulting from encryption
+ **/
+
+CPU_TARGET("aes,sse2") static void aesniEncryptBlock(AesContext *context,
+   const uint8_t *input, uint8_t *output)
+{
+   uint_t i;
+   __m128i s;
+   const __m128i *k;
+
+   //Point to the key schedule
+   k = (const __m128i *) context->ek;
+
+   //Initial round key addition
+   s = _mm_loadu_si128((const __m128i *) input);
+   s = _mm_xor_si128(s, _mm_loadu_si128(k));
+
+   //The number of rounds depends on the key length
+   for(i = 1; i < context->nr; i++)
+   {
+      s = _mm_aesenc_si128(s, _mm_loadu_si128(k + i));
+   }
+
+   //The last round differs slightly from the first rounds
+   s = _mm_aesenclast_si128(s, _mm_loadu_si128(k + context->nr));
+
+   //The final state is then copied to the output
+   _mm_storeu_si128((__m128i *) output, s);
+}
+
+
+/**
+ * @brief Decrypt a 16-byte block using AES-NI instructions
+ * @param[in] context Pointer to the AES context
+ * @param[in] input Ciphertext block to decrypt
+ * @param[out] output Plaintext block resulting from decryption
+ **/
+
+CPU_TARGET("aes,sse2") static void aesniDecryptBlock(AesContext *context,
+   const uint8_t *input, uint8_t *output)
+{
+   uint_t i;
+   __m128i s;
+   const __m128i *k;
+
+   //Point to the key schedule
+   k = (const __m128i *) context->dk;
+
+   //Initial round key addition
+   s = _mm_loadu_si128((const __m128i *) input);
+   s = _mm_xor_si128(s, _mm_loadu_si128(k + context->nr));
+
+   //The number of rounds depends on the key length
+   for(i = context->nr - 1; i >= 1; i--)
+   {
+      s = _mm_aesdec_si128(s, _mm_loadu_si128(k + i));
+   }
+
+   //The last round differs slightly from the first rounds
+   s = _mm_aesdeclast_si128(s, _mm_loadu_si128(k));
+
+   //The final state is then copied to the output
+   _mm_storeu_si128((__m128i *) output, s);
+}
+
+
+/**
+ * @brief Encrypt several 16-byte blocks using AES-NI instructions
+ * @param[in] context Pointer to the AES context
+ * @param[in] input Plaintext blocks to encrypt
+ * @param[out] output Ciphertext blocks resulting from encryption
+ * @param[in] n Number of blocks to encrypt
+ **/
+
+CPU_TARGET("aes,sse2") static void aesniEncryptBlocks(AesContext *context,
+   const uint8_t *input, uint8_t *output, size_t n)
+{
+   uint_t i;
+   __m128i k;
+   __m128i s0;
+   __m128i s1;
+   __m128i s2;
+   __m128i s3;
+   __m128i s4;
+   __m128i s5;
+   __m128i s6;
+   __m128i s7;
+   const __m128i *ek;
+
+   //Point to the key schedule
+   ek = (const __m128i *) context->ek;
+
+   //The blocks are independent, so the latency of the AESENC instruction
+   //can be hidden by interleaving the processing of 8 blocks
+   while(n >= 8)
+   {
+      //Initial round key addition
+      k = _mm_loadu_si128(ek);
+      s0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input), k);
+      s1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 1), k);
+      s2 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 2), k);
+      s3 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 3), k);
+      s4 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 4), k);
+      s5 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 5), k);
+      s6 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 6), k);
+      s7 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 7), k);
+
+      //The number of rounds depends on the key length
+      for(i = 1; i < context->nr; i++)
+      {
+         k = _mm_loadu_si128(ek + i);
+         s0 = _mm_aesenc_si128(s0, k);
+         s1 = _mm_aesenc_si128(s1, k);
+         s2 = _mm_aesenc_si128(s2, k);
+         s3 = _mm_aesenc_si128(s3, k);
+         s4 = _mm_aesenc_si128(s4, k);
+         s5 = _mm_aesenc_si128(s5, k);
+         s6 = _mm_aesenc_si128(s6, k);
+         s7 = _mm_aesenc_si128(s7, k);
+      }
+
+      //The last round differs slightly from the first rounds
+      k = _mm_loadu_si128(ek + context->nr);
+      _mm_storeu_si128((__m128i *) output, _mm_aesenclast_si128(s0, k));
+      _mm_storeu_si128((__m128i *) output + 1, _mm_aesenclast_si128(s1, k));
+      _mm_storeu_si128((__m128i *) output + 2, _mm_aesenclast_si128(s2, k));
+      _mm_storeu_si128((__m128i *) output + 3, _mm_aesenclast_si128(s3, k));
+      _mm_storeu_si128((__m128i *) output + 4, _mm_aesenclast_si128(s4, k));
+      _mm_storeu_si128((__m128i *) output + 5, _mm_aesenclast_si128(s5, k));
+      _mm_storeu_si128((__m128i *) output + 6, _mm_aesenclast_si128(s6, k));
+      _mm_storeu_si128((__m128i *) output + 7, _mm_aesenclast_si128(s7, k));
+
+      //Next blocks
+      input += 128;
+      output += 128;
+      n -= 8;
+   }
+
+   //Process the remaining blocks one at a time
+   while(n > 0)
+   {
+      aesniEncryptBlock(context, input, output);
+
+      //Next block
+      input += 16;
+      output += 16;
+      n--;
+   }
+}
+
+
+/**
+ * @brief Decrypt several 16-byte blocks using AES-NI instructions
+ * @param[in] context Pointer to the AES context
+ * @param[in] input Ciphertext blocks to decrypt
+ * @param[out] output Plaintext blocks resulting from decryption
+ * @param[in] n Number of blocks to decrypt
+ **/
+
+CPU_TARGET("aes,sse2") static void aesniDecryptBlocks(AesContext *context,
+   const uint8_t *input, uint8_t *output, size_t n)
+{
+   uint_t i;
+   __m128i k;
+   __m128i s0;
+   __m128i s1;
+   __m128i s2;
+   __m128i s3;
+   __m128i s4;
+   __m128i s5;
+   __m128i s6;
+   __m128i s7;
+   const __m128i *dk;
+
+   //Point to the key schedule
+   dk = (const __m128i *) context->dk;
+
+   //The blocks are independent, so the latency of the AESDEC instruction
+   //can be hidden by interleaving the processing of 8 blocks
+   while(n >= 8)
+   {
+      //Initial round key addition
+      k = _mm_loadu_si128(dk + context->nr);
+      s0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input), k);
+      s1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 1), k);
+      s2 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 2), k);
+      s3 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 3), k);
+      s4 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 4), k);
+      s5 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 5), k);
+      s6 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 6), k);
+      s7 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input + 7), k);
+
+      //The number of rounds depends on the key length
+      for(i = context->nr - 1; i >= 1; i--)
+      {
+         k = _mm_loadu_si128(dk + i);
+         s0 = _mm_aesdec_si128(s0, k);
+         s1 = _mm_aesdec_si128(s1, k);
+         s2 = _mm_aesdec_si128(s2, k);
+         s3 = _mm_aesdec_si128(s3, k);
+         s4 = _mm_aesdec_si128(s4, k);
+         s5 = _mm_aesdec_si128(s5, k);
+         s6 = _mm_aesdec_si128(s6, k);
+         s7 = _mm_aesdec_si128(s7, k);
+      }
+
+      //The last round differs slightly from the first rounds
+      k = _mm_loadu_si128(dk);
+      _mm_storeu_si128((__m128i *) output, _mm_aesdeclast_si128(s0, k));
+      _mm_storeu_si128((__m128i *) output + 1, _mm_aesdeclast_si128(s1, k));
+      _mm_storeu_si128((__m128i *) output + 2, _mm_aesdeclast_si128(s2, k));
+      _mm_storeu_si128((__m128i *) output + 3, _mm_aesdeclast_si128(s3, k));
+      _mm_storeu_si128((__m128i *) output + 4, _mm_aesdeclast_si128(s4, k));
+      _mm_storeu_si128((__m128i *) output + 5, _mm_aesdeclast_si128(s5, k));
+      _mm_storeu_si128((__m128i *) output + 6, _mm_aesdeclast_si128(s6, k));
+      _mm_storeu_si128((__m128i *) output + 7, _mm_aesdeclast_si128(s7, k));
+
+      //Next blocks
+      input += 128;
+      output += 128;
+      n -= 8;
+   }
+
+   //Process the remaining blocks one at a time
+   while(n > 0)
+   {
+      aesniDecryptBlock(context, input, output);
+
+      //Next block
+      input += 16;
+      output += 16;
+      n--;
+   }
+}
+
+#endif
+
+
 /**
  * @brief Key expansion
  * @param[in] context Pointer to the AES context to initialize
@@ -224,6 +541,17 @@ error_t aesInit(AesContext *context, const uint8_t *key, size_t keyLength)
    for(i = 0; i < keyLength; i++)
       context->ek[i] = LOAD32LE(key + (i * 4));
 
+#if (AESNI_SUPPORT == ENABLED)
+   //Check whether the CPU supports AES-NI instructions
+   if(cpuGetFeatures() & CPU_FEATURE_AESNI)
+   {
+      //Both key schedules are generated using AES-NI instructions
+      aesniKeyExpansion(context, keyLength);
+      //No error to report
+      return NO_ERROR;
+   }
+#endif
+
    //The size of the key schedule depends on the number of rounds
    keyScheduleSize = 4 * (context->nr + 1);
 
@@ -304,6 +632,16 @@ void aesEncryptBlock(AesContext *context, const uint8_t *input, uint8_t *output)
    uint32_t t3;
    uint32_t temp;
 
+#if (AESNI_SUPPORT == ENABLED)
+   //Check whether the CPU supports AES-NI instructions
+   if(cpuGetFeatures() & CPU_FEATURE_AESNI)
+   {
+      //Hardware-accelerated encryption
+      aesniEncryptBlock(context, input, output);
+      return;
+   }
+#endif
+
    //Copy the plaintext to the state array
    s0 = LOAD32LE(input + 0);
    s1 = LOAD32LE(input + 4);
@@ -414,6 +752,16 @@ void aesDecryptBlock(AesContext *context, const uint8_t *input, uint8_t *output)
    uint32_t t3;
    uint32_t temp;
 
+#if (AESNI_SUPPORT == ENABLED)
+   //Check whether the CPU supports AES-NI instructions
+   if(cpuGetFeatures() & CPU_FEATURE_AESNI)
+   {
+      //Hardware-accelerated decryption
+      aesniDecryptBlock(context, input, output);
+      return;
+   }
+#endif
+
    //Copy the ciphertext to the state array
    s0 = LOAD32LE(input + 0);
    s1 = LOAD32LE(input + 4);
@@ -503,4 +851,74 @@ void aesDecryptBlock(AesContext *context, const uint8_t *input, uint8_t *output)
    STORE32LE(s3, output + 12);
 }
 
+
+/**
+ * @brief Encrypt several 16-byte blocks using AES algorithm
+ * @param[in] context Pointer to the AES context
+ * @param[in] input Plaintext blocks to encrypt
+ * @param[out] output Ciphertext blocks resulting from encryption
+ * @param[in] n Number of blocks to encrypt
+ **/
+
+void aesEncryptBlocks(AesContext *context, const uint8_t *input,
+   uint8_t *output, size_t n)
+{
+#if (AESNI_SUPPORT == ENABLED)
+   //Check whether the CPU supports AES-NI instructions
+   if(cpuGetFeatures() & CPU_FEATURE_AESNI)
+   {
+      //Process several blocks in parallel
+      aesniEncryptBlocks(context, input, output, n);
+      return;
+   }
+#endif
+
+   //The blocks are processed in a block-by-block fashion
+   while(n > 0)
+   {
+      //Encrypt current block
+      aesEncryptBlock(context, input, output);
+
+      //Next block
+      input += AES_BLOCK_SIZE;
+      output += AES_BLOCK_SIZE;
+      n--;
+   }
+}
+
+
+/**
+ * @brief Decrypt several 16-byte blocks using AES algorithm
+ * @param[in] context Pointer to the AES context
+ * @param[in] input Ciphertext blocks to decrypt
+ * @param[out] output Plaintext blocks resulting from decryption
+ * @param[in] n Number of blocks to decrypt
+ **/
+
+void aesDecryptBlocks(AesContext *context, const uint8_t *input,
+   uint8_t *output, size_t n)
+{
+#if (AESNI_SUPPORT == ENABLED)
+   //Check whether the CPU supports AES-NI instructions
+   if(cpuGetFeatures() & CPU_FEATURE_AESNI)
+   {
+      //Process several blocks in parallel
+      aesniDecryptBlocks(context, input, output, n);
+      return;
+   }
+#endif
+
+   //The blocks are processed in a block-by-block fashion
+   while(n > 0)
+   {
+      //Decrypt current block
+      aesDecryptBlock(context, input, output);
+
+      //Next block
+      input += AES_BLOCK_SIZE;
+      output += AES_BLOCK_SIZE;
+      n--;
+   }
+}
+
 #endif
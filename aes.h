@@ -63,6 +63,12 @@ error_t aesInit(AesContext *context, const uint8_t *key, size_t keyLength);
 void aesEncryptBlock(AesContext *context, const uint8_t *input, uint8_t *output);
 void aesDecryptBlock(AesContext *context, const uint8_t *input, uint8_t *output);
 
+void aesEncryptBlocks(AesContext *context, const uint8_t *input,
+   uint8_t *output, size_t n);
+
+void aesDecryptBlocks(AesContext *context, const uint8_t *input,
+   uint8_t *output, size_t n);
+
 //C++ guard
 #ifdef __cplusplus
    }
@@ -30,8 +30,17 @@
 #define TRACE_LEVEL CRYPTO_TRACE_LEVEL
 
 //Dependencies
+#include <string.h>
 #include "crypto.h"
 #include "chacha.h"
+#include "cpu_features.h"
+
+//SIMD support?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   #include <immintrin.h>
+#elif (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_NEON))
+   #include <arm_neon.h>
+#endif
 
 //Check crypto library configuration
 #if (CHACHA_SUPPORT == ENABLED)
@@ -45,6 +54,575 @@
    c += d; b ^= c; b = ROL32(b, 7); \
 }
 
+//SIMD support?
+#if (SIMD_SUPPORT == ENABLED)
+
+//x86 or x86-64 target?
+#if defined(CPU_FEATURES_X86)
+
+//ChaCha quarter-round function (SSE2)
+#define CHACHA_SSE2_ROL(x, n) _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+
+#define CHACHA_SSE2_QUARTER_ROUND(a, b, c, d) \
+{ \
+   a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = CHACHA_SSE2_ROL(d, 16); \
+   c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = CHACHA_SSE2_ROL(b, 12); \
+   a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = CHACHA_SSE2_ROL(d, 8); \
+   c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = CHACHA_SSE2_ROL(b, 7); \
+}
+
+//ChaCha quarter-round function (AVX2)
+#define CHACHA_AVX2_ROL(x, n) _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - (n)))
+
+#define CHACHA_AVX2_QUARTER_ROUND(a, b, c, d) \
+{ \
+   a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = CHACHA_AVX2_ROL(d, 16); \
+   c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = CHACHA_AVX2_ROL(b, 12); \
+   a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = CHACHA_AVX2_ROL(d, 8); \
+   c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = CHACHA_AVX2_ROL(b, 7); \
+}
+
+//ChaCha quarter-round function (AVX-512)
+#define CHACHA_AVX512_QUARTER_ROUND(a, b, c, d) \
+{ \
+   a = _mm512_add_epi32(a, b); d = _mm512_xor_si512(d, a); d = _mm512_rol_epi32(d, 16); \
+   c = _mm512_add_epi32(c, d); b = _mm512_xor_si512(b, c); b = _mm512_rol_epi32(b, 12); \
+   a = _mm512_add_epi32(a, b); d = _mm512_xor_si512(d, a); d = _mm512_rol_epi32(d, 8); \
+   c = _mm512_add_epi32(c, d); b = _mm512_xor_si512(b, c); b = _mm512_rol_epi32(b, 7); \
+}
+
+
+/**
+ * @brief XOR 16 bytes of keystream with the input data (SSE2)
+ * @param[in] input Pointer to the input data (optional)
+ * @param[out] output Pointer to the resulting data
+ * @param[in] offset Offset of the keystream bytes
+ * @param[in] k Keystream bytes
+ **/
+
+CPU_TARGET("sse2") static void chachaSse2Store(const uint8_t *input,
+   uint8_t *output, size_t offset, __m128i k)
+{
+   //Valid input pointer?
+   if(input != NULL)
+      k = _mm_xor_si128(k, _mm_loadu_si128((const __m128i *) (input + offset)));
+
+   //Save the resulting data
+   _mm_storeu_si128((__m128i *) (output + offset), k);
+}
+
+
+/**
+ * @brief Generate 4 keystream blocks at a time using SSE2 instructions
+ * @param[in] context Pointer to the ChaCha context
+ * @param[in] input Pointer to the data to encrypt/decrypt (optional)
+ * @param[out] output Pointer to the resulting data
+ * @param[in] n Number of 64-byte blocks to process (multiple of 4)
+ **/
+
+CPU_TARGET("sse2") static void chachaSse2ProcessBlocks(ChachaContext *context,
+   const uint8_t *input, uint8_t *output, size_t n)
+{
+   uint_t i;
+   size_t j;
+   __m128i x[16];
+   __m128i s[16];
+   __m128i t[4];
+   __m128i r[4][4];
+
+   //Process 4 blocks at a time
+   for(j = 0; j < n; j += 4)
+   {
+      //Each lane holds the same state, except for the block counter
+      for(i = 0; i < 16; i++)
+         s[i] = _mm_set1_epi32(context->state[i]);
+
+      s[12] = _mm_add_epi32(s[12], _mm_set_epi32(3, 2, 1, 0));
+
+      //Copy the state to the working state
+      for(i = 0; i < 16; i++)
+         x[i] = s[i];
+
+      //ChaCha runs 8, 12 or 20 rounds, alternating between column rounds
+      //and diagonal rounds
+      for(i = 0; i < context->nr; i += 2)
+      {
+         //Column rounds
+         CHACHA_SSE2_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+         CHACHA_SSE2_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+         CHACHA_SSE2_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+         CHACHA_SSE2_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+
+         //Diagonal rounds
+         CHACHA_SSE2_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+         CHACHA_SSE2_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+         CHACHA_SSE2_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+         CHACHA_SSE2_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+      }
+
+      //Add the original input words to the output words
+      for(i = 0; i < 16; i++)
+         x[i] = _mm_add_epi32(x[i], s[i]);
+
+      //Transpose each group of 4 words so that the words of a given block
+      //become contiguous within each 128-bit lane
+      for(i = 0; i < 4; i++)
+      {
+         t[0] = _mm_unpacklo_epi32(x[4 * i], x[4 * i + 1]);
+         t[1] = _mm_unpacklo_epi32(x[4 * i + 2], x[4 * i + 3]);
+         t[2] = _mm_unpackhi_epi32(x[4 * i], x[4 * i + 1]);
+         t[3] = _mm_unpackhi_epi32(x[4 * i + 2], x[4 * i + 3]);
+
+         r[i][0] = _mm_unpacklo_epi64(t[0], t[1]);
+         r[i][1] = _mm_unpackhi_epi64(t[0], t[1]);
+         r[i][2] = _mm_unpacklo_epi64(t[2], t[3]);
+         r[i][3] = _mm_unpackhi_epi64(t[2], t[3]);
+      }
+
+      //Serialize the keystream blocks
+      for(i = 0; i < 4; i++)
+      {
+         chachaSse2Store(input, output, 64 * i + 0, r[0][i]);
+         chachaSse2Store(input, output, 64 * i + 16, r[1][i]);
+         chachaSse2Store(input, output, 64 * i + 32, r[2][i]);
+         chachaSse2Store(input, output, 64 * i + 48, r[3][i]);
+      }
+
+      //Increment block counter
+      context->state[12] += 4;
+
+      //Advance data pointers
+      if(input != NULL)
+         input += 256;
+
+      output += 256;
+   }
+}
+
+
+/**
+ * @brief XOR 32 bytes of keystream with the input data (AVX2)
+ * @param[in] input Pointer to the input data (optional)
+ * @param[out] output Pointer to the resulting data
+ * @param[in] offset Offset of the keystream bytes
+ * @param[in] k Keystream bytes
+ **/
+
+CPU_TARGET("avx2") static void chachaAvx2Store(const uint8_t *input,
+   uint8_t *output, size_t offset, __m256i k)
+{
+   //Valid input pointer?
+   if(input != NULL)
+      k = _mm256_xor_si256(k, _mm256_loadu_si256((const __m256i *) (input + offset)));
+
+   //Save the resulting data
+   _mm256_storeu_si256((__m256i *) (output + offset), k);
+}
+
+
+/**
+ * @brief Generate 8 keystream blocks at a time using AVX2 instructions
+ * @param[in] context Pointer to the ChaCha context
+ * @param[in] input Pointer to the data to encrypt/decrypt (optional)
+ * @param[out] output Pointer to the resulting data
+ * @param[in] n Number of 64-byte blocks to process (multiple of 8)
+ **/
+
+CPU_TARGET("avx2") static void chachaAvx2ProcessBlocks(ChachaContext *context,
+   const uint8_t *input, uint8_t *output, size_t n)
+{
+   uint_t i;
+   size_t j;
+   __m256i x[16];
+   __m256i s[16];
+   __m256i t[4];
+   __m256i r[4][4];
+
+   //Process 8 blocks at a time
+   for(j = 0; j < n; j += 8)
+   {
+      //Each lane holds the same state, except for the block counter
+      for(i = 0; i < 16; i++)
+         s[i] = _mm256_set1_epi32(context->state[i]);
+
+      s[12] = _mm256_add_epi32(s[12], _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+
+      //Copy the state to the working state
+      for(i = 0; i < 16; i++)
+         x[i] = s[i];
+
+      //ChaCha runs 8, 12 or 20 rounds, alternating between column rounds
+      //and diagonal rounds
+      for(i = 0; i < context->nr; i += 2)
+      {
+         //Column rounds
+         CHACHA_AVX2_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+         CHACHA_AVX2_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+         CHACHA_AVX2_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+         CHACHA_AVX2_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+
+         //Diagonal rounds
+         CHACHA_AVX2_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+         CHACHA_AVX2_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+         CHACHA_AVX2_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+         CHACHA_AVX2_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+      }
+
+      //Add the original input words to the output words
+      for(i = 0; i < 16; i++)
+         x[i] = _mm256_add_epi32(x[i], s[i]);
+
+      //Transpose each group of 4 words so that the words of a given block
+      //become contiguous within each 128-bit lane
+      for(i = 0; i < 4; i++)
+      {
+         t[0] = _mm256_unpacklo_epi32(x[4 * i], x[4 * i + 1]);
+         t[1] = _mm256_unpacklo_epi32(x[4 * i + 2], x[4 * i + 3]);
+         t[2] = _mm256_unpackhi_epi32(x[4 * i], x[4 * i + 1]);
+         t[3] = _mm256_unpackhi_epi32(x[4 * i + 2], x[4 * i + 3]);
+
+         r[i][0] = _mm256_unpacklo_epi64(t[0], t[1]);
+         r[i][1] = _mm256_unpackhi_epi64(t[0], t[1]);
+         r[i][2] = _mm256_unpacklo_epi64(t[2], t[3]);
+         r[i][3] = _mm256_unpackhi_epi64(t[2], t[3]);
+      }
+
+      //Gather the 128-bit lanes that belong to the same block
+      for(i = 0; i < 4; i++)
+      {
+         chachaAvx2Store(input, output, 64 * i,
+            _mm256_permute2x128_si256(r[0][i], r[1][i], 0x20));
+         chachaAvx2Store(input, output, 64 * i + 32,
+            _mm256_permute2x128_si256(r[2][i], r[3][i], 0x20));
+         chachaAvx2Store(input, output, 64 * (i + 4),
+            _mm256_permute2x128_si256(r[0][i], r[1][i], 0x31));
+         chachaAvx2Store(input, output, 64 * (i + 4) + 32,
+            _mm256_permute2x128_si256(r[2][i], r[3][i], 0x31));
+      }
+
+      //Increment block counter
+      context->state[12] += 8;
+
+      //Advance data pointers
+      if(input != NULL)
+         input += 512;
+
+      output += 512;
+   }
+}
+
+
+/**
+ * @brief XOR 64 bytes of keystream with the input data (AVX-512)
+ * @param[in] input Pointer to the input data (optional)
+ * @param[out] output Pointer to the resulting data
+ * @param[in] offset Offset of the keystream bytes
+ * @param[in] k Keystream bytes
+ **/
+
+CPU_TARGET("avx512f") static void chachaAvx512Store(const uint8_t *input,
+   uint8_t *output, size_t offset, __m512i k)
+{
+   //Valid input pointer?
+   if(input != NULL)
+      k = _mm512_xor_si512(k, _mm512_loadu_si512((const void *) (input + offset)));
+
+   //Save the resulting data
+   _mm512_storeu_si512((void *) (output + offset), k);
+}
+
+
+/**
+ * @brief Generate 16 keystream blocks at a time using AVX-512 instructions
+ * @param[in] context Pointer to the ChaCha context
+ * @param[in] input Pointer to the data to encrypt/decrypt (optional)
+ * @param[out] output Pointer to the resulting data
+ * @param[in] n Number of 64-byte blocks to process (multiple of 16)
+ **/
+
+CPU_TARGET("avx512f") static void chachaAvx512ProcessBlocks(ChachaContext *context,
+   const uint8_t *input, uint8_t *output, size_t n)
+{
+   uint_t i;
+   size_t j;
+   __m512i x[16];
+   __m512i s[16];
+   __m512i t[4];
+   __m512i r[4][4];
+
+   //Process 16 blocks at a time
+   for(j = 0; j < n; j += 16)
+   {
+      //Each lane holds the same state, except for the block counter
+      for(i = 0; i < 16; i++)
+         s[i] = _mm512_set1_epi32(context->state[i]);
+
+      s[12] = _mm512_add_epi32(s[12], _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+
+      //Copy the state to the working state
+      for(i = 0; i < 16; i++)
+         x[i] = s[i];
+
+      //ChaCha runs 8, 12 or 20 rounds, alternating between column rounds
+      //and diagonal rounds
+      for(i = 0; i < context->nr; i += 2)
+      {
+         //Column rounds
+         CHACHA_AVX512_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+         CHACHA_AVX512_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+         CHACHA_AVX512_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+         CHACHA_AVX512_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+
+         //Diagonal rounds
+         CHACHA_AVX512_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+         CHACHA_AVX512_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+         CHACHA_AVX512_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+         CHACHA_AVX512_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+      }
+
+      //Add the original input words to the output words
+      for(i = 0; i < 16; i++)
+         x[i] = _mm512_add_epi32(x[i], s[i]);
+
+      //Transpose each group of 4 words so that the words of a given block
+      //become contiguous within each 128-bit lane
+      for(i = 0; i < 4; i++)
+      {
+         t[0] = _mm512_unpacklo_epi32(x[4 * i], x[4 * i + 1]);
+         t[1] = _mm512_unpacklo_epi32(x[4 * i + 2], x[4 * i + 3]);
+         t[2] = _mm512_unpackhi_epi32(x[4 * i], x[4 * i + 1]);
+         t[3] = _mm512_unpackhi_epi32(x[4 * i + 2], x[4 * i + 3]);
+
+         r[i][0] = _mm512_unpacklo_epi64(t[0], t[1]);
+         r[i][1] = _mm512_unpackhi_epi64(t[0], t[1]);
+         r[i][2] = _mm512_unpacklo_epi64(t[2], t[3]);
+         r[i][3] = _mm512_unpackhi_epi64(t[2], t[3]);
+      }
+
+      //Gather the 128-bit lanes that belong to the same block
+      for(i = 0; i < 4; i++)
+      {
+         t[0] = _mm512_shuffle_i32x4(r[0][i], r[1][i], 0x88);
+         t[1] = _mm512_shuffle_i32x4(r[0][i], r[1][i], 0xDD);
+         t[2] = _mm512_shuffle_i32x4(r[2][i], r[3][i], 0x88);
+         t[3] = _mm512_shuffle_i32x4(r[2][i], r[3][i], 0xDD);
+
+         chachaAvx512Store(input, output, 64 * i,
+            _mm512_shuffle_i32x4(t[0], t[2], 0x88));
+         chachaAvx512Store(input, output, 64 * (i + 4),
+            _mm512_shuffle_i32x4(t[1], t[3], 0x88));
+         chachaAvx512Store(input, output, 64 * (i + 8),
+            _mm512_shuffle_i32x4(t[0], t[2], 0xDD));
+         chachaAvx512Store(input, output, 64 * (i + 12),
+            _mm512_shuffle_i32x4(t[1], t[3], 0xDD));
+      }
+
+      //Increment block counter
+      context->state[12] += 16;
+
+      //Advance data pointers
+      if(input != NULL)
+         input += 1024;
+
+      output += 1024;
+   }
+}
+
+#else
+
+//ChaCha quarter-round function (NEON)
+#define CHACHA_NEON_ROL(x, n) vsriq_n_u32(vshlq_n_u32(x, n), x, 32 - (n))
+
+#define CHACHA_NEON_QUARTER_ROUND(a, b, c, d) \
+{ \
+   a = vaddq_u32(a, b); d = veorq_u32(d, a); d = CHACHA_NEON_ROL(d, 16); \
+   c = vaddq_u32(c, d); b = veorq_u32(b, c); b = CHACHA_NEON_ROL(b, 12); \
+   a = vaddq_u32(a, b); d = veorq_u32(d, a); d = CHACHA_NEON_ROL(d, 8); \
+   c = vaddq_u32(c, d); b = veorq_u32(b, c); b = CHACHA_NEON_ROL(b, 7); \
+}
+
+
+/**
+ * @brief XOR 16 bytes of keystream with the input data (NEON)
+ * @param[in] input Pointer to the input data (optional)
+ * @param[out] output Pointer to the resulting data
+ * @param[in] offset Offset of the keystream bytes
+ * @param[in] k Keystream bytes
+ **/
+
+static void chachaNeonStore(const uint8_t *input, uint8_t *output,
+   size_t offset, uint32x4_t k)
+{
+   //Valid input pointer?
+   if(input != NULL)
+      k = veorq_u32(k, vreinterpretq_u32_u8(vld1q_u8(input + offset)));
+
+   //Save the resulting data
+   vst1q_u8(output + offset, vreinterpretq_u8_u32(k));
+}
+
+
+/**
+ * @brief Generate 4 keystream blocks at a time using NEON instructions
+ * @param[in] context Pointer to the ChaCha context
+ * @param[in] input Pointer to the data to encrypt/decrypt (optional)
+ * @param[out] output Pointer to the resulting data
+ * @param[in] n Number of 64-byte blocks to process (multiple of 4)
+ **/
+
+static void chachaNeonProcessBlocks(ChachaContext *context,
+   const uint8_t *input, uint8_t *output, size_t n)
+{
+   uint_t i;
+   size_t j;
+   uint32x4_t x[16];
+   uint32x4_t s[16];
+   uint32x4_t r[4][4];
+   uint32x4x2_t t[2];
+   static const uint32_t lanes[4] = {0, 1, 2, 3};
+
+   //Process 4 blocks at a time
+   for(j = 0; j < n; j += 4)
+   {
+      //Each lane holds the same state, except for the block counter
+      for(i = 0; i < 16; i++)
+         s[i] = vdupq_n_u32(context->state[i]);
+
+      s[12] = vaddq_u32(s[12], vld1q_u32(lanes));
+
+      //Copy the state to the working state
+      for(i = 0; i < 16; i++)
+         x[i] = s[i];
+
+      //ChaCha runs 8, 12 or 20 rounds, alternating between column rounds
+      //and diagonal rounds
+      for(i = 0; i < context->nr; i += 2)
+      {
+         //Column rounds
+         CHACHA_NEON_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+         CHACHA_NEON_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+         CHACHA_NEON_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+         CHACHA_NEON_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+
+         //Diagonal rounds
+         CHACHA_NEON_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+         CHACHA_NEON_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+         CHACHA_NEON_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+         CHACHA_NEON_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+      }
+
+      //Add the original input words to the output words
+      for(i = 0; i < 16; i++)
+         x[i] = vaddq_u32(x[i], s[i]);
+
+      //Transpose each group of 4 words so that the words of a given block
+      //become contiguous
+      for(i = 0; i < 4; i++)
+      {
+         t[0] = vtrnq_u32(x[4 * i], x[4 * i + 1]);
+         t[1] = vtrnq_u32(x[4 * i + 2], x[4 * i + 3]);
+
+         r[i][0] = vcombine_u32(vget_low_u32(t[0].val[0]), vget_low_u32(t[1].val[0]));
+         r[i][1] = vcombine_u32(vget_low_u32(t[0].val[1]), vget_low_u32(t[1].val[1]));
+         r[i][2] = vcombine_u32(vget_high_u32(t[0].val[0]), vget_high_u32(t[1].val[0]));
+         r[i][3] = vcombine_u32(vget_high_u32(t[0].val[1]), vget_high_u32(t[1].val[1]));
+      }
+
+      //Serialize the keystream blocks
+      for(i = 0; i < 4; i++)
+      {
+         chachaNeonStore(input, output, 64 * i, r[0][i]);
+         chachaNeonStore(input, output, 64 * i + 16, r[1][i]);
+         chachaNeonStore(input, output, 64 * i + 32, r[2][i]);
+         chachaNeonStore(input, output, 64 * i + 48, r[3][i]);
+      }
+
+      //Increment block counter
+      context->state[12] += 4;
+
+      //Advance data pointers
+      if(input != NULL)
+         input += 256;
+
+      output += 256;
+   }
+}
+
+#endif
+
+
+/**
+ * @brief Process complete keystream blocks using SIMD instructions
+ * @param[in] context Pointer to the ChaCha context
+ * @param[in] input Pointer to the data to encrypt/decrypt (optional)
+ * @param[out] output Pointer to the resulting data
+ * @param[in] length Number of bytes available
+ * @return Number of bytes actually processed
+ **/
+
+static size_t chachaSimdCipher(ChachaContext *context, const uint8_t *input,
+   uint8_t *output, size_t length)
+{
+   size_t k;
+   size_t n;
+   size_t m;
+#if defined(CPU_FEATURES_X86)
+   uint32_t features;
+#endif
+
+   //Number of complete blocks
+   n = length / 64;
+   //The SIMD code does not propagate the carry of the block counter
+   n = MIN(n, (size_t) (0xFFFFFFFF - context->state[12]));
+
+   //Number of blocks processed so far
+   m = 0;
+
+#if defined(CPU_FEATURES_X86)
+   //Retrieve the instruction set extensions supported by the CPU
+   features = cpuGetFeatures();
+
+   //16-way implementation
+   if((features & CPU_FEATURE_AVX512F) != 0 && (n - m) >= 16)
+   {
+      k = (n - m) - ((n - m) % 16);
+      chachaAvx512ProcessBlocks(context, input, output, k);
+      m += k;
+   }
+
+   //8-way implementation
+   if((features & CPU_FEATURE_AVX2) != 0 && (n - m) >= 8)
+   {
+      k = (n - m) - ((n - m) % 8);
+      chachaAvx2ProcessBlocks(context, (input != NULL) ? input + m * 64 : NULL,
+         output + m * 64, k);
+      m += k;
+   }
+
+   //4-way implementation
+   if((features & CPU_FEATURE_SSE2) != 0 && (n - m) >= 4)
+   {
+      k = (n - m) - ((n - m) % 4);
+      chachaSse2ProcessBlocks(context, (input != NULL) ? input + m * 64 : NULL,
+         output + m * 64, k);
+      m += k;
+   }
+#else
+   //4-way implementation
+   if(n >= 4)
+   {
+      k = n - (n % 4);
+      chachaNeonProcessBlocks(context, input, output, k);
+      m += k;
+   }
+#endif
+
+   //Return the number of bytes processed
+   return m * 64;
+}
+
+#endif
+
 
 /**
  * @brief Initialize ChaCha context using the supplied key and nonce
@@ -172,10 +750,38 @@ void chachaCipher(ChachaContext *context, const uint8_t *input,
    uint_t i;
    uint_t n;
    uint8_t *k;
+#if (SIMD_SUPPORT == ENABLED)
+   size_t m;
+#endif
 
    //Encryption loop
    while(length > 0)
    {
+#if (SIMD_SUPPORT == ENABLED)
+      //At a keystream block boundary, complete blocks are processed
+      //several at a time using SIMD instructions
+      if((context->pos == 0 || context->pos >= 64) && output != NULL)
+      {
+         //Process as many blocks as possible
+         m = chachaSimdCipher(context, input, output, length);
+
+         //Any blocks processed?
+         if(m > 0)
+         {
+            //Advance data pointers
+            if(input != NULL)
+               input += m;
+
+            output += m;
+            length -= m;
+
+            //A new keystream block must be generated for the remaining data
+            context->pos = 0;
+            continue;
+         }
+      }
+#endif
+
       //Check whether a new keystream block must be generated
       if(context->pos == 0 || context->pos >= 64)
       {
@@ -279,4 +885,60 @@ void chachaProcessBlock(ChachaContext *context)
       w[i] = htole32(w[i]);
 }
 
+
+/**
+ * @brief HChaCha function (subkey derivation)
+ *
+ * HChaCha is initialized like ChaCha, except that the block counter and
+ * the nonce are replaced by a 128-bit nonce. The feed-forward addition is
+ * omitted and the first and last rows of the state form the 256-bit subkey
+ *
+ * @param[in] nr Number of rounds to be applied (8, 12 or 20)
+ * @param[in] key Pointer to the key
+ * @param[in] keyLength Length of the key, in bytes (16 or 32)
+ * @param[in] nonce Pointer to the 128-bit nonce
+ * @param[out] output 256-bit subkey
+ * @return Error code
+ **/
+
+error_t hchachaDeriveKey(uint_t nr, const uint8_t *key, size_t keyLength,
+   const uint8_t *nonce, uint8_t *output)
+{
+   error_t error;
+   uint_t i;
+   uint32_t w;
+   ChachaContext context;
+
+   //Initialize the state with the key (input words 0 to 11)
+   error = chachaInit(&context, nr, key, keyLength, nonce, 12);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Input words 12 through 15 are taken from the 128-bit nonce
+   for(i = 0; i < 4; i++)
+      context.state[12 + i] = LOAD32LE(nonce + 4 * i);
+
+   //Apply the ChaCha rounds
+   chachaProcessBlock(&context);
+
+   //Undo the final addition of the input words and serialize the first
+   //and last rows of the state
+   for(i = 0; i < 4; i++)
+   {
+      w = LOAD32LE((uint8_t *) context.block + 4 * i) - context.state[i];
+      STORE32LE(w, output + 4 * i);
+
+      w = LOAD32LE((uint8_t *) context.block + 48 + 4 * i) -
+         context.state[12 + i];
+      STORE32LE(w, output + 16 + 4 * i);
+   }
+
+   //Clear the ChaCha context
+   memset(&context, 0, sizeof(ChachaContext));
+
+   //Successful processing
+   return NO_ERROR;
+}
+
 #endif
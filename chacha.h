@@ -60,6 +60,9 @@ void chachaCipher(ChachaContext *context, const uint8_t *input,
 
 void chachaProcessBlock(ChachaContext *context);
 
+error_t hchachaDeriveKey(uint_t nr, const uint8_t *key, size_t keyLength,
+   const uint8_t *nonce, uint8_t *output);
+
 //C++ guard
 #ifdef __cplusplus
    }
@@ -62,91 +62,148 @@ error_t chacha20Poly1305Encrypt(const uint8_t *k, size_t kLen,
    const uint8_t *p, uint8_t *c, size_t length, uint8_t *t, size_t tLen)
 {
    error_t error;
-   size_t paddingLen;
-   ChachaContext chachaContext;
-   Poly1305Context poly1305Context;
-   uint8_t temp[32];
+   Chacha20Poly1305Context context;
 
    //Check the length of the message-authentication code
    if(tLen != 16)
       return ERROR_INVALID_LENGTH;
 
-   //Initialize ChaCha20 context
-   error = chachaInit(&chachaContext, 20, k, kLen, n, nLen);
-   //Any error to report?
-   if(error)
-      return error;
+   //Initialize ChaCha20Poly1305 context
+   error = chacha20Poly1305Init(&context, k, kLen);
 
-   //First, a Poly1305 one-time key is generated from the 256-bit key
-   //and nonce
-   chachaCipher(&chachaContext, NULL, temp, 32);
+   //Check status code
+   if(!error)
+   {
+      //Start the encryption process
+      error = chacha20Poly1305Start(&context, TRUE, n, nLen);
+   }
 
-   //The other 256 bits of the Chacha20 block are discarded
-   chachaCipher(&chachaContext, NULL, NULL, 32);
+   //Check status code
+   if(!error)
+   {
+      //Compute MAC over the AAD
+      chacha20Poly1305UpdateAad(&context, a, aLen);
+      //Encrypt the plaintext and compute MAC over the ciphertext
+      chacha20Poly1305Update(&context, p, c, length);
+      //Compute message-authentication code
+      error = chacha20Poly1305Finish(&context, t, tLen);
+   }
 
-   //Next, the ChaCha20 encryption function is called to encrypt the
-   //plaintext, using the same key and nonce
-   chachaCipher(&chachaContext, p, c, length);
+   //Clear the ChaCha20Poly1305 context
+   memset(&context, 0, sizeof(Chacha20Poly1305Context));
 
-   //Initialize the Poly1305 function with the key calculated above
-   poly1305Init(&poly1305Context, temp);
+   //Return status code
+   return error;
+}
 
-   //Compute MAC over the AAD
-   poly1305Update(&poly1305Context, a, aLen);
 
-   //If the length of the AAD is not an integral multiple of 16 bytes,
-   //then padding is required
-   if((aLen % 16) != 0)
-   {
-      //Compute the number of padding bytes
-      paddingLen = 16 - (aLen % 16);
+/**
+ * @brief Authenticated decryption using ChaCha20Poly1305
+ * @param[in] k key
+ * @param[in] kLen Length of the key
+ * @param[in] n Nonce
+ * @param[in] nLen Length of the nonce
+ * @param[in] a Additional authenticated data
+ * @param[in] aLen Length of the additional data
+ * @param[in] c Ciphertext to be decrypted
+ * @param[out] p Plaintext resulting from the decryption
+ * @param[in] length Total number of data bytes to be decrypted
+ * @param[in] t MAC to be verified
+ * @param[in] tLen Length of the MAC
+ * @return Error code
+ **/
 
-      //The padding is up to 15 zero bytes, and it brings the total
-      //length so far to an integral multiple of 16
-      memset(temp, 0, paddingLen);
+error_t chacha20Poly1305Decrypt(const uint8_t *k, size_t kLen,
+   const uint8_t *n, size_t nLen, const uint8_t *a, size_t aLen,
+   const uint8_t *c, uint8_t *p, size_t length, const uint8_t *t, size_t tLen)
+{
+   error_t error;
+   Chacha20Poly1305Context context;
 
-      //Compute MAC over the padding
-      poly1305Update(&poly1305Context, temp, paddingLen);
-   }
+   //Check the length of the message-authentication code
+   if(tLen != 16)
+      return ERROR_INVALID_LENGTH;
 
-   //Compute MAC over the ciphertext
-   poly1305Update(&poly1305Context, c, length);
+   //Initialize ChaCha20Poly1305 context
+   error = chacha20Poly1305Init(&context, k, kLen);
 
-   //If the length of the ciphertext is not an integral multiple of 16 bytes,
-   //then padding is required
-   if((length % 16) != 0)
+   //Check status code
+   if(!error)
    {
-      //Compute the number of padding bytes
-      paddingLen = 16 - (length % 16);
-
-      //The padding is up to 15 zero bytes, and it brings the total
-      //length so far to an integral multiple of 16
-      memset(temp, 0, paddingLen);
+      //Start the decryption process
+      error = chacha20Poly1305Start(&context, FALSE, n, nLen);
+   }
 
-      //Compute MAC over the padding
-      poly1305Update(&poly1305Context, temp, paddingLen);
+   //Check status code
+   if(!error)
+   {
+      //Compute MAC over the AAD
+      chacha20Poly1305UpdateAad(&context, a, aLen);
+      //Compute MAC over the ciphertext and decrypt it
+      chacha20Poly1305Update(&context, c, p, length);
+      //Verify message-authentication code
+      error = chacha20Poly1305Finish(&context, (uint8_t *) t, tLen);
    }
 
-   //Encode the length of the AAD as a 64-bit little-endian integer
-   STORE64LE(aLen, temp);
-   //Compute MAC over the length field
-   poly1305Update(&poly1305Context, temp, sizeof(uint64_t));
+   //Clear the ChaCha20Poly1305 context
+   memset(&context, 0, sizeof(Chacha20Poly1305Context));
 
-   //Encode the length of the ciphertext as a 64-bit little-endian integer
-   STORE64LE(length, temp);
-   //Compute MAC over the length field
-   poly1305Update(&poly1305Context, temp, sizeof(uint64_t));
+   //Return status code
+   return error;
+}
 
-   //Compute message-authentication code
-   poly1305Final(&poly1305Context, t);
 
-   //Successful encryption
-   return NO_ERROR;
+/**
+ * @brief Authenticated encryption using XChaCha20Poly1305
+ * @param[in] k key
+ * @param[in] kLen Length of the key
+ * @param[in] n Nonce
+ * @param[in] nLen Length of the nonce
+ * @param[in] a Additional authenticated data
+ * @param[in] aLen Length of the additional data
+ * @param[in] p Plaintext to be encrypted
+ * @param[out] c Ciphertext resulting from the encryption
+ * @param[in] length Total number of data bytes to be encrypted
+ * @param[out] t MAC resulting from the encryption process
+ * @param[in] tLen Length of the MAC
+ * @return Error code
+ **/
+
+error_t xchacha20Poly1305Encrypt(const uint8_t *k, size_t kLen,
+   const uint8_t *n, size_t nLen, const uint8_t *a, size_t aLen,
+   const uint8_t *p, uint8_t *c, size_t length, uint8_t *t, size_t tLen)
+{
+   error_t error;
+   Chacha20Poly1305Context context;
+
+   //Check the length of the message-authentication code
+   if(tLen != 16)
+      return ERROR_INVALID_LENGTH;
+
+   //Derive the subkey and start the encryption process
+   error = xchacha20Poly1305Start(&context, TRUE, k, kLen, n, nLen);
+
+   //Check status code
+   if(!error)
+   {
+      //Compute MAC over the AAD
+      chacha20Poly1305UpdateAad(&context, a, aLen);
+      //Encrypt the plaintext and compute MAC over the ciphertext
+      chacha20Poly1305Update(&context, p, c, length);
+      //Compute message-authentication code
+      error = chacha20Poly1305Finish(&context, t, tLen);
+   }
+
+   //Clear the subkey
+   memset(&context, 0, sizeof(Chacha20Poly1305Context));
+
+   //Return status code
+   return error;
 }
 
 
 /**
- * @brief Authenticated decryption using ChaCha20Poly1305
+ * @brief Authenticated decryption using XChaCha20Poly1305
  * @param[in] k key
  * @param[in] kLen Length of the key
  * @param[in] n Nonce
@@ -161,94 +218,388 @@ error_t chacha20Poly1305Encrypt(const uint8_t *k, size_t kLen,
  * @return Error code
  **/
 
-error_t chacha20Poly1305Decrypt(const uint8_t *k, size_t kLen,
+error_t xchacha20Poly1305Decrypt(const uint8_t *k, size_t kLen,
    const uint8_t *n, size_t nLen, const uint8_t *a, size_t aLen,
    const uint8_t *c, uint8_t *p, size_t length, const uint8_t *t, size_t tLen)
 {
    error_t error;
-   size_t paddingLen;
-   ChachaContext chachaContext;
-   Poly1305Context poly1305Context;
-   uint8_t temp[32];
+   Chacha20Poly1305Context context;
 
    //Check the length of the message-authentication code
    if(tLen != 16)
       return ERROR_INVALID_LENGTH;
 
+   //Derive the subkey and start the decryption process
+   error = xchacha20Poly1305Start(&context, FALSE, k, kLen, n, nLen);
+
+   //Check status code
+   if(!error)
+   {
+      //Compute MAC over the AAD
+      chacha20Poly1305UpdateAad(&context, a, aLen);
+      //Compute MAC over the ciphertext and decrypt it
+      chacha20Poly1305Update(&context, c, p, length);
+      //Verify message-authentication code
+      error = chacha20Poly1305Finish(&context, (uint8_t *) t, tLen);
+   }
+
+   //Clear the subkey
+   memset(&context, 0, sizeof(Chacha20Poly1305Context));
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Initialize a ChaCha20Poly1305 context
+ *
+ * The key schedule is performed once. The context can then be used to
+ * process any number of messages, each with its own nonce
+ *
+ * @param[in] context Pointer to the ChaCha20Poly1305 context
+ * @param[in] k key
+ * @param[in] kLen Length of the key
+ * @return Error code
+ **/
+
+error_t chacha20Poly1305Init(Chacha20Poly1305Context *context,
+   const uint8_t *k, size_t kLen)
+{
+   error_t error;
+   uint8_t n[12];
+
+   //Make sure the ChaCha20Poly1305 context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //The nonce is supplied later, for each message
+   memset(n, 0, sizeof(n));
+
    //Initialize ChaCha20 context
-   error = chachaInit(&chachaContext, 20, k, kLen, n, nLen);
-   //Any error to report?
-   if(error)
-      return error;
+   error = chachaInit(&context->chachaContext, 20, k, kLen, n, sizeof(n));
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Start encrypting or decrypting a message
+ * @param[in] context Pointer to the ChaCha20Poly1305 context
+ * @param[in] encrypt TRUE for encryption, FALSE for decryption
+ * @param[in] n Nonce
+ * @param[in] nLen Length of the nonce
+ * @return Error code
+ **/
+
+error_t chacha20Poly1305Start(Chacha20Poly1305Context *context,
+   bool_t encrypt, const uint8_t *n, size_t nLen)
+{
+   uint32_t *w;
+   uint8_t temp[32];
+
+   //Make sure the ChaCha20Poly1305 context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Point to the ChaCha20 state (input words 0 to 11 hold the key)
+   w = context->chachaContext.state;
+
+   //Check the length of the nonce
+   if(nLen == 8)
+   {
+      //Input words 12 and 13 are a block counter
+      w[12] = 0;
+      w[13] = 0;
+
+      //Input words 14 and 15 are taken from the 64-bit nonce
+      w[14] = LOAD32LE(n);
+      w[15] = LOAD32LE(n + 4);
+   }
+   else if(nLen == 12)
+   {
+      //Input word 12 is a block counter
+      w[12] = 0;
+
+      //Input words 13 to 15 are taken from the 96-bit nonce
+      w[13] = LOAD32LE(n);
+      w[14] = LOAD32LE(n + 4);
+      w[15] = LOAD32LE(n + 8);
+   }
+   else
+   {
+      //Invalid nonce length
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //The keystream block is empty
+   context->chachaContext.pos = 0;
 
    //First, a Poly1305 one-time key is generated from the 256-bit key
    //and nonce
-   chachaCipher(&chachaContext, NULL, temp, 32);
+   chachaCipher(&context->chachaContext, NULL, temp, 32);
 
    //The other 256 bits of the Chacha20 block are discarded
-   chachaCipher(&chachaContext, NULL, NULL, 32);
+   chachaCipher(&context->chachaContext, NULL, NULL, 32);
 
    //Initialize the Poly1305 function with the key calculated above
-   poly1305Init(&poly1305Context, temp);
+   poly1305Init(&context->poly1305Context, temp);
+
+   //Clear the one-time key
+   memset(temp, 0, sizeof(temp));
+
+   //Save the direction of the operation
+   context->encrypt = encrypt;
+
+   //No AAD and no data have been processed yet
+   context->aLen = 0;
+   context->length = 0;
+
+   //Successful processing
+   return NO_ERROR;
+}
 
-   //Compute MAC over the AAD
-   poly1305Update(&poly1305Context, a, aLen);
 
-   //If the length of the AAD is not an integral multiple of 16 bytes,
-   //then padding is required
-   if((aLen % 16) != 0)
+/**
+ * @brief Start encrypting or decrypting a message using XChaCha20Poly1305
+ *
+ * The first 128 bits of the 192-bit nonce are used by HChaCha20 to derive
+ * a subkey from the key. The message is then processed by ChaCha20Poly1305
+ * under the subkey, with the remaining 64 bits of the nonce prefixed by
+ * four zero bytes. The message is processed with chacha20Poly1305UpdateAad,
+ * chacha20Poly1305Update and chacha20Poly1305Finish
+ *
+ * @param[in] context Pointer to the ChaCha20Poly1305 context
+ * @param[in] encrypt TRUE for encryption, FALSE for decryption
+ * @param[in] k key
+ * @param[in] kLen Length of the key
+ * @param[in] n Nonce
+ * @param[in] nLen Length of the nonce
+ * @return Error code
+ **/
+
+error_t xchacha20Poly1305Start(Chacha20Poly1305Context *context,
+   bool_t encrypt, const uint8_t *k, size_t kLen, const uint8_t *n, size_t nLen)
+{
+   error_t error;
+   uint8_t temp[32];
+
+   //Make sure the ChaCha20Poly1305 context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //XChaCha20Poly1305 requires a 256-bit key and a 192-bit nonce
+   if(kLen != 32 || nLen != 24)
+      return ERROR_INVALID_PARAMETER;
+
+   //Derive the subkey from the key and the first 128 bits of the nonce
+   error = hchachaDeriveKey(20, k, kLen, n, temp);
+
+   //Check status code
+   if(!error)
    {
-      //Compute the number of padding bytes
-      paddingLen = 16 - (aLen % 16);
+      //Initialize ChaCha20Poly1305 context with the subkey
+      error = chacha20Poly1305Init(context, temp, 32);
+   }
 
-      //The padding is up to 15 zero bytes, and it brings the total
-      //length so far to an integral multiple of 16
-      memset(temp, 0, paddingLen);
+   //Check status code
+   if(!error)
+   {
+      //The 96-bit nonce consists of four zero bytes followed by the last
+      //64 bits of the extended nonce
+      memset(temp, 0, 4);
+      memcpy(temp + 4, n + 16, 8);
 
-      //Compute MAC over the padding
-      poly1305Update(&poly1305Context, temp, paddingLen);
+      //Start the encryption or decryption process
+      error = chacha20Poly1305Start(context, encrypt, temp, 12);
    }
 
-   //Compute MAC over the ciphertext
-   poly1305Update(&poly1305Context, c, length);
+   //Clear the subkey
+   memset(temp, 0, sizeof(temp));
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Process additional authenticated data
+ *
+ * This function can be called several times. All the AAD must be supplied
+ * before the first call to chacha20Poly1305Update
+ *
+ * @param[in] context Pointer to the ChaCha20Poly1305 context
+ * @param[in] a Additional authenticated data
+ * @param[in] aLen Length of the additional data
+ * @return Error code
+ **/
+
+error_t chacha20Poly1305UpdateAad(Chacha20Poly1305Context *context,
+   const uint8_t *a, size_t aLen)
+{
+   //Make sure the ChaCha20Poly1305 context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //The AAD must precede the data
+   if(context->length != 0)
+      return ERROR_WRONG_STATE;
+
+   //Compute MAC over the AAD
+   poly1305Update(&context->poly1305Context, a, aLen);
+   context->aLen += aLen;
+
+   //Successful processing
+   return NO_ERROR;
+}
 
-   //If the length of the ciphertext is not an integral multiple of 16 bytes,
-   //then padding is required
-   if((length % 16) != 0)
-   {
-      //Compute the number of padding bytes
-      paddingLen = 16 - (length % 16);
 
+/**
+ * @brief Encrypt or decrypt data
+ *
+ * This function can be called several times, with fragments of any length.
+ * Encryption and authentication are interleaved on small chunks, so that
+ * the data is only fetched once from memory. On decryption, the plaintext
+ * is released before the tag is checked, so it must not be used until
+ * chacha20Poly1305Finish has succeeded
+ *
+ * @param[in] context Pointer to the ChaCha20Poly1305 context
+ * @param[in] input Plaintext (encryption) or ciphertext (decryption)
+ * @param[out] output Ciphertext (encryption) or plaintext (decryption)
+ * @param[in] length Number of bytes to process
+ * @return Error code
+ **/
+
+error_t chacha20Poly1305Update(Chacha20Poly1305Context *context,
+   const uint8_t *input, uint8_t *output, size_t length)
+{
+   size_t n;
+   size_t paddingLen;
+   uint8_t padding[16];
+
+   //Make sure the ChaCha20Poly1305 context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Nothing to do?
+   if(length == 0)
+      return NO_ERROR;
+
+   //First data bytes?
+   if(context->length == 0 && (context->aLen % 16) != 0)
+   {
       //The padding is up to 15 zero bytes, and it brings the total
-      //length so far to an integral multiple of 16
-      memset(temp, 0, paddingLen);
+      //length of the AAD to an integral multiple of 16
+      paddingLen = 16 - (context->aLen % 16);
+      memset(padding, 0, paddingLen);
 
       //Compute MAC over the padding
-      poly1305Update(&poly1305Context, temp, paddingLen);
+      poly1305Update(&context->poly1305Context, padding, paddingLen);
    }
 
-   //Encode the length of the AAD as a 64-bit little-endian integer
-   STORE64LE(aLen, temp);
-   //Compute MAC over the length field
-   poly1305Update(&poly1305Context, temp, sizeof(uint64_t));
+   //Process the data chunk by chunk, so that the ciphertext is still
+   //cache-resident when Poly1305 reads it back
+   while(length > 0)
+   {
+      //Align the chunks on keystream block boundaries
+      n = CHACHA20_POLY1305_CHUNK_SIZE - (context->length % 64);
+      n = MIN(n, length);
+
+      //Encryption or decryption?
+      if(context->encrypt)
+      {
+         //Encrypt the plaintext, then compute MAC over the ciphertext
+         chachaCipher(&context->chachaContext, input, output, n);
+         poly1305Update(&context->poly1305Context, output, n);
+      }
+      else
+      {
+         //Compute MAC over the ciphertext, then decrypt it
+         poly1305Update(&context->poly1305Context, input, n);
+         chachaCipher(&context->chachaContext, input, output, n);
+      }
+
+      //Update the number of data bytes processed so far
+      context->length += n;
+
+      //Next chunk
+      input += n;
+      output += n;
+      length -= n;
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Finish encrypting or decrypting a message
+ * @param[in] context Pointer to the ChaCha20Poly1305 context
+ * @param[in,out] t MAC resulting from the encryption process, or MAC to be
+ *   verified
+ * @param[in] tLen Length of the MAC
+ * @return Error code
+ **/
+
+error_t chacha20Poly1305Finish(Chacha20Poly1305Context *context,
+   uint8_t *t, size_t tLen)
+{
+   size_t i;
+   size_t paddingLen;
+   uint8_t mask;
+   uint8_t temp[16];
 
+   //Make sure the ChaCha20Poly1305 context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Check the length of the message-authentication code
+   if(tLen != 16)
+      return ERROR_INVALID_LENGTH;
+
+   //If the length of the last field (AAD or ciphertext) is not an integral
+   //multiple of 16 bytes, then padding is required
+   if(context->length == 0)
+      paddingLen = (16 - (context->aLen % 16)) % 16;
+   else
+      paddingLen = (16 - (context->length % 16)) % 16;
+
+   //The padding is up to 15 zero bytes
+   memset(temp, 0, sizeof(temp));
+   //Compute MAC over the padding
+   poly1305Update(&context->poly1305Context, temp, paddingLen);
+
+   //Encode the length of the AAD as a 64-bit little-endian integer
+   STORE64LE(context->aLen, temp);
    //Encode the length of the ciphertext as a 64-bit little-endian integer
-   STORE64LE(length, temp);
-   //Compute MAC over the length field
-   poly1305Update(&poly1305Context, temp, sizeof(uint64_t));
+   STORE64LE(context->length, temp + 8);
+
+   //Compute MAC over the length fields
+   poly1305Update(&context->poly1305Context, temp, 16);
 
    //Compute message-authentication code
-   poly1305Final(&poly1305Context, temp);
+   poly1305Final(&context->poly1305Context, temp);
 
-   //Finally, we decrypt the ciphertext
-   chachaCipher(&chachaContext, c, p, length);
+   //Encryption or decryption?
+   if(context->encrypt)
+   {
+      //Return the MAC
+      memcpy(t, temp, tLen);
+   }
+   else
+   {
+      //The calculated tag is bitwise compared to the received tag
+      for(mask = 0, i = 0; i < tLen; i++)
+         mask |= temp[i] ^ t[i];
 
-   //The calculated tag is bitwise compared to the received tag. The
-   //message is authenticated if and only if the tags match
-   if(memcmp(temp, t, tLen))
-      return ERROR_FAILURE;
+      //The message is authenticated if and only if the tags match
+      if(mask != 0)
+         return ERROR_FAILURE;
+   }
 
-   //Successful encryption
+   //Successful processing
    return NO_ERROR;
 }
 
@@ -31,12 +31,35 @@
 
 //Dependencies
 #include "crypto.h"
+#include "chacha.h"
+#include "poly1305.h"
+
+//Size of the chunks that are encrypted and authenticated in a single pass
+#ifndef CHACHA20_POLY1305_CHUNK_SIZE
+   #define CHACHA20_POLY1305_CHUNK_SIZE 4096
+#elif (CHACHA20_POLY1305_CHUNK_SIZE < 64 || (CHACHA20_POLY1305_CHUNK_SIZE % 64) != 0)
+   #error CHACHA20_POLY1305_CHUNK_SIZE parameter is not valid
+#endif
 
 //C++ guard
 #ifdef __cplusplus
    extern "C" {
 #endif
 
+
+/**
+ * @brief ChaCha20Poly1305 context
+ **/
+
+typedef struct
+{
+   ChachaContext chachaContext;     ///<ChaCha20 context (keyed once)
+   Poly1305Context poly1305Context; ///<Poly1305 context
+   bool_t encrypt;                  ///<Encryption or decryption
+   size_t aLen;                     ///<Number of AAD bytes processed so far
+   size_t length;                   ///<Number of data bytes processed so far
+} Chacha20Poly1305Context;
+
 //ChaCha20Poly1305 related functions
 error_t chacha20Poly1305Encrypt(const uint8_t *k, size_t kLen,
    const uint8_t *n, size_t nLen, const uint8_t *a, size_t aLen,
@@ -46,6 +69,32 @@ error_t chacha20Poly1305Decrypt(const uint8_t *k, size_t kLen,
    const uint8_t *n, size_t nLen, const uint8_t *a, size_t aLen,
    const uint8_t *c, uint8_t *p, size_t length, const uint8_t *t, size_t tLen);
 
+error_t xchacha20Poly1305Encrypt(const uint8_t *k, size_t kLen,
+   const uint8_t *n, size_t nLen, const uint8_t *a, size_t aLen,
+   const uint8_t *p, uint8_t *c, size_t length, uint8_t *t, size_t tLen);
+
+error_t xchacha20Poly1305Decrypt(const uint8_t *k, size_t kLen,
+   const uint8_t *n, size_t nLen, const uint8_t *a, size_t aLen,
+   const uint8_t *c, uint8_t *p, size_t length, const uint8_t *t, size_t tLen);
+
+error_t xchacha20Poly1305Start(Chacha20Poly1305Context *context,
+   bool_t encrypt, const uint8_t *k, size_t kLen, const uint8_t *n, size_t nLen);
+
+error_t chacha20Poly1305Init(Chacha20Poly1305Context *context,
+   const uint8_t *k, size_t kLen);
+
+error_t chacha20Poly1305Start(Chacha20Poly1305Context *context,
+   bool_t encrypt, const uint8_t *n, size_t nLen);
+
+error_t chacha20Poly1305UpdateAad(Chacha20Poly1305Context *context,
+   const uint8_t *a, size_t aLen);
+
+error_t chacha20Poly1305Update(Chacha20Poly1305Context *context,
+   const uint8_t *input, uint8_t *output, size_t length);
+
+error_t chacha20Poly1305Finish(Chacha20Poly1305Context *context,
+   uint8_t *t, size_t tLen);
+
 //C++ guard
 #ifdef __cplusplus
    }
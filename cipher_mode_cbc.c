@@ -106,7 +106,51 @@ error_t cbcDecrypt(const CipherAlgo *cipher, void *context,
    uint8_t *iv, const uint8_t *c, uint8_t *p, size_t length)
 {
    size_t i;
+   size_t j;
+   size_t n;
    uint8_t t[16];
+   uint8_t b[CIPHER_PARALLEL_BLOCKS * 16];
+
+   //Multi-block decryption routine available?
+   if(cipher->decryptBlocks != NULL)
+   {
+      //Unlike encryption, CBC decryption can be parallelized since each
+      //plaintext block only depends on two consecutive ciphertext blocks
+      while(length >= cipher->blockSize)
+      {
+         //Limit the number of blocks to process at a time
+         n = MIN(length / cipher->blockSize, CIPHER_PARALLEL_BLOCKS);
+
+         //Decrypt the current blocks
+         cipher->decryptBlocks(context, c, b, n);
+
+         //Save the last input block
+         memcpy(t, c + (n - 1) * cipher->blockSize, cipher->blockSize);
+
+         //XOR each output block with the previous input block. The blocks
+         //are processed in reverse order so that in-place decryption works
+         for(j = n - 1; j > 0; j--)
+         {
+            for(i = 0; i < cipher->blockSize; i++)
+            {
+               p[j * cipher->blockSize + i] = b[j * cipher->blockSize + i] ^
+                  c[(j - 1) * cipher->blockSize + i];
+            }
+         }
+
+         //XOR the first output block with IV contents
+         for(i = 0; i < cipher->blockSize; i++)
+            p[i] = b[i] ^ iv[i];
+
+         //Update IV with the last input block
+         memcpy(iv, t, cipher->blockSize);
+
+         //Next blocks
+         c += n * cipher->blockSize;
+         p += n * cipher->blockSize;
+         length -= n * cipher->blockSize;
+      }
+   }
 
    //CBC mode operates in a block-by-block fashion
    while(length >= cipher->blockSize)
@@ -138,4 +182,154 @@ error_t cbcDecrypt(const CipherAlgo *cipher, void *context,
    return NO_ERROR;
 }
 
+
+/**
+ * @brief Multi-stream CBC encryption
+ *
+ * CBC encryption is inherently serial, but independent messages can be
+ * interleaved so that the multi-block cipher routine processes one block
+ * of each message at a time. A lane is refilled with the next message as
+ * soon as the current one is complete. When the ciphertext pointer of a
+ * stream is NULL, only the IV is updated, which yields the CBC-MAC of the
+ * message
+ *
+ * @param[in] cipher Cipher algorithm
+ * @param[in] context Cipher algorithm context
+ * @param[in,out] streams Array of independent streams
+ * @param[in] count Number of streams
+ * @return Error code
+ **/
+
+error_t cbcEncryptMulti(const CipherAlgo *cipher, void *context,
+   CbcStream *streams, uint_t count)
+{
+   error_t error;
+   uint_t i;
+   uint_t n;
+   uint_t next;
+   size_t j;
+   size_t offset[CIPHER_PARALLEL_BLOCKS];
+   CbcStream *lane[CIPHER_PARALLEL_BLOCKS];
+   uint8_t b[CIPHER_PARALLEL_BLOCKS * 16];
+   uint8_t t[16];
+
+   //Check parameters
+   if(streams == NULL && count != 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //The plaintext of each stream must be a multiple of the block size
+   for(i = 0; i < count; i++)
+   {
+      if((streams[i].length % cipher->blockSize) != 0)
+         return ERROR_INVALID_LENGTH;
+   }
+
+   //Multi-block encryption routine not available?
+   if(cipher->encryptBlocks == NULL)
+   {
+      //Process the streams one after the other
+      for(i = 0; i < count; i++)
+      {
+         //Encryption or CBC-MAC computation?
+         if(streams[i].c != NULL)
+         {
+            //Encrypt the current stream
+            error = cbcEncrypt(cipher, context, streams[i].iv, streams[i].p,
+               streams[i].c, streams[i].length);
+            //Any error to report?
+            if(error)
+               return error;
+         }
+         else
+         {
+            //Process the current stream block by block
+            for(j = 0; j < streams[i].length; j += cipher->blockSize)
+            {
+               cbcEncrypt(cipher, context, streams[i].iv, streams[i].p + j,
+                  t, cipher->blockSize);
+            }
+         }
+      }
+
+      //Successful encryption
+      return NO_ERROR;
+   }
+
+   //No active lane yet
+   n = 0;
+   next = 0;
+
+   //Process the streams
+   while(1)
+   {
+      //Assign pending streams to the free lanes
+      while(n < CIPHER_PARALLEL_BLOCKS && next < count)
+      {
+         //Empty streams are skipped
+         if(streams[next].length > 0)
+         {
+            lane[n] = &streams[next];
+            offset[n] = 0;
+            n++;
+         }
+
+         //Next stream
+         next++;
+      }
+
+      //All the streams have been processed?
+      if(n == 0)
+         break;
+
+      //XOR the current block of each lane with its IV
+      for(i = 0; i < n; i++)
+      {
+         for(j = 0; j < cipher->blockSize; j++)
+         {
+            b[i * cipher->blockSize + j] = lane[i]->p[offset[i] + j] ^
+               lane[i]->iv[j];
+         }
+      }
+
+      //Encrypt one block of each lane at once
+      cipher->encryptBlocks(context, b, b, n);
+
+      //Save the output blocks
+      for(i = 0; i < n; i++)
+      {
+         //Update IV with output block contents
+         memcpy(lane[i]->iv, b + i * cipher->blockSize, cipher->blockSize);
+
+         //Copy the resulting ciphertext block, if needed
+         if(lane[i]->c != NULL)
+         {
+            memcpy(lane[i]->c + offset[i], b + i * cipher->blockSize,
+               cipher->blockSize);
+         }
+
+         //Next block
+         offset[i] += cipher->blockSize;
+      }
+
+      //Release the lanes whose stream is complete
+      for(i = 0; i < n; )
+      {
+         if(offset[i] >= lane[i]->length)
+         {
+            //Move the last active lane to the free slot
+            n--;
+            lane[i] = lane[n];
+            offset[i] = offset[n];
+         }
+         else
+         {
+            i++;
+         }
+      }
+   }
+
+   //Successful encryption
+   return NO_ERROR;
+}
+
 #endif
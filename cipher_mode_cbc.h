@@ -37,6 +37,19 @@
    extern "C" {
 #endif
 
+/**
+ * @brief Independent CBC stream (multi-stream encryption)
+ **/
+
+typedef struct
+{
+   uint8_t *iv;      ///<Initialization vector (updated with the last ciphertext block)
+   const uint8_t *p; ///<Plaintext
+   uint8_t *c;       ///<Ciphertext (NULL to compute a CBC-MAC only)
+   size_t length;    ///<Length of the plaintext
+} CbcStream;
+
+
 //CBC encryption and decryption routines
 error_t cbcEncrypt(const CipherAlgo *cipher, void *context,
    uint8_t *iv, const uint8_t *p, uint8_t *c, size_t length);
@@ -44,6 +57,9 @@ error_t cbcEncrypt(const CipherAlgo *cipher, void *context,
 error_t cbcDecrypt(const CipherAlgo *cipher, void *context,
    uint8_t *iv, const uint8_t *c, uint8_t *p, size_t length);
 
+error_t cbcEncryptMulti(const CipherAlgo *cipher, void *context,
+   CbcStream *streams, uint_t count);
+
 //C++ guard
 #ifdef __cplusplus
    }
@@ -47,6 +47,188 @@
 #if (CCM_SUPPORT == ENABLED)
 
 
+/**
+ * @brief Format the first block B(0)
+ * @param[in] n Nonce
+ * @param[in] nLen Length of the nonce
+ * @param[in] aLen Length of the additional data
+ * @param[in] length Length of the payload
+ * @param[in] tLen Length of the MAC
+ * @param[out] b First block B(0)
+ * @return Error code
+ **/
+
+static error_t ccmFormatFirstBlock(const uint8_t *n, size_t nLen, size_t aLen,
+   size_t length, size_t tLen, uint8_t *b)
+{
+   size_t i;
+   size_t q;
+   size_t qLen;
+
+   //Q is the bit string representation of the octet length of P
+   q = length;
+   //Compute the octet length of Q
+   qLen = 15 - nLen;
+
+   //Format the leading octet of the first block
+   b[0] = (aLen > 0) ? 0x40 : 0x00;
+   //Encode the octet length of T
+   b[0] |= ((tLen - 2) / 2) << 3;
+   //Encode the octet length of Q
+   b[0] |= qLen - 1;
+
+   //Copy the nonce
+   memcpy(b + 1, n, nLen);
+
+   //Encode the length field Q
+   for(i = 0; i < qLen; i++, q >>= 8)
+      b[15 - i] = q & 0xFF;
+
+   //Invalid length?
+   if(q != 0)
+      return ERROR_INVALID_LENGTH;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Encrypt or decrypt the payload and update the CBC-MAC
+ *
+ * The CBC-MAC is inherently serial, so each call to the multi-block cipher
+ * routine carries one CBC-MAC block, together with up to CCM_CTR_BLOCKS
+ * counter blocks whenever the keystream needs to be refilled. The CBC-MAC
+ * lags one block behind the keystream, since decryption must recover the
+ * plaintext before it can be authenticated
+ *
+ * @param[in] cipher Cipher algorithm
+ * @param[in] context Cipher algorithm context
+ * @param[in] encrypt TRUE for encryption, FALSE for decryption
+ * @param[in,out] b Counter block
+ * @param[in] qLen Size in bytes of the counter
+ * @param[in,out] y CBC-MAC value
+ * @param[in] input Data to be encrypted or decrypted
+ * @param[out] output Resulting data
+ * @param[in] length Total number of data bytes to process
+ **/
+
+static void ccmProcessData(const CipherAlgo *cipher, void *context,
+   bool_t encrypt, uint8_t *b, size_t qLen, uint8_t *y, const uint8_t *input,
+   uint8_t *output, size_t length)
+{
+   size_t i;
+   size_t k;
+   size_t m;
+   size_t n;
+   size_t pos;
+   size_t avail;
+   size_t pending;
+   uint8_t x[(CCM_CTR_BLOCKS + 1) * 16];
+   uint8_t s[CCM_CTR_BLOCKS * 16];
+   uint8_t q[16];
+
+   //The keystream buffer is initially empty
+   pos = 0;
+   avail = 0;
+   //Number of plaintext bytes waiting to be authenticated
+   pending = 0;
+
+   //Process the payload
+   while(length > 0 || pending > 0)
+   {
+      //Number of blocks to encrypt
+      n = 0;
+      k = 0;
+
+      //Any plaintext block waiting to be authenticated?
+      if(pending > 0)
+      {
+         //XOR B(i) with Y(i-1)
+         ccmXorBlock(x, q, y, pending);
+         memcpy(x + pending, y + pending, 16 - pending);
+         n++;
+      }
+
+      //The keystream needs to be refilled?
+      if(length > 0 && pos == avail)
+      {
+         //Number of counter blocks to generate
+         k = MIN((length + 15) / 16, CCM_CTR_BLOCKS);
+
+         //Generate the counter blocks
+         for(i = 0; i < k; i++)
+         {
+            //Increment counter
+            ccmIncCounter(b, qLen);
+            //Save current counter block
+            memcpy(x + (n + i) * 16, b, 16);
+         }
+      }
+
+      //Multi-block encryption routine available?
+      if(cipher->encryptBlocks != NULL)
+      {
+         //Compute Y(i) = CIPH(B(i) ^ Y(i-1)) and S(j) = CIPH(CTR(j)) at once
+         cipher->encryptBlocks(context, x, x, n + k);
+      }
+      else
+      {
+         //Encrypt the blocks one at a time
+         for(i = 0; i < (n + k); i++)
+            cipher->encryptBlock(context, x + i * 16, x + i * 16);
+      }
+
+      //Save Y(i)
+      if(n > 0)
+      {
+         memcpy(y, x, 16);
+         pending = 0;
+      }
+
+      //Save S(j)
+      if(k > 0)
+      {
+         memcpy(s, x + n * 16, k * 16);
+         pos = 0;
+         avail = k;
+      }
+
+      //Any data to process?
+      if(length > 0)
+      {
+         //The payload is processed in a block-by-block fashion
+         m = MIN(length, 16);
+
+         //Encryption or decryption?
+         if(encrypt)
+         {
+            //Save the plaintext block before it may be overwritten
+            memcpy(q, input, m);
+            //Compute C(i) = B(i) XOR S(i)
+            ccmXorBlock(output, input, s + pos * 16, m);
+         }
+         else
+         {
+            //Compute B(i) = C(i) XOR S(i)
+            ccmXorBlock(output, input, s + pos * 16, m);
+            //Save the plaintext block
+            memcpy(q, output, m);
+         }
+
+         //The plaintext block will be authenticated at the next iteration
+         pending = m;
+         pos++;
+
+         //Next block
+         length -= m;
+         input += m;
+         output += m;
+      }
+   }
+}
+
+
 /**
  * @brief Authenticated encryption using CCM
  * @param[in] cipher Cipher algorithm
@@ -66,8 +248,8 @@
 error_t ccmEncrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, size_t nLen,
    const uint8_t *a, size_t aLen, const uint8_t *p, uint8_t *c, size_t length, uint8_t *t, size_t tLen)
 {
+   error_t error;
    size_t m;
-   size_t q;
    size_t qLen;
    uint8_t b[16];
    uint8_t y[16];
@@ -88,28 +270,14 @@ error_t ccmEncrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, si
    if(tLen < 4 || tLen > 16 || (tLen % 2) != 0)
       return ERROR_INVALID_LENGTH;
 
-   //Q is the bit string representation of the octet length of P
-   q = length;
    //Compute the octet length of Q
    qLen = 15 - nLen;
 
-   //Format the leading octet of the first block
-   b[0] = (aLen > 0) ? 0x40 : 0x00;
-   //Encode the octet length of T
-   b[0] |= ((tLen - 2) / 2) << 3;
-   //Encode the octet length of Q
-   b[0] |= qLen - 1;
-
-   //Copy the nonce
-   memcpy(b + 1, n, nLen);
-
-   //Encode the length field Q
-   for(m = 0; m < qLen; m++, q >>= 8)
-      b[15 - m] = q & 0xFF;
-
+   //Format the first block B(0)
+   error = ccmFormatFirstBlock(n, nLen, aLen, length, tLen, b);
    //Invalid length?
-   if(q != 0)
-      return ERROR_INVALID_LENGTH;
+   if(error)
+      return error;
 
    //Set Y(0) = CIPH(B(0))
    cipher->encryptBlock(context, b, y);
@@ -181,29 +349,8 @@ error_t ccmEncrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, si
    //Save MSB(S(0))
    memcpy(t, s, tLen);
 
-   //Encrypt plaintext
-   while(length > 0)
-   {
-      //The encryption operates in a block-by-block fashion
-      m = MIN(length, 16);
-
-      //XOR B(i) with Y(i-1)
-      ccmXorBlock(y, p, y, m);
-      //Compute Y(i) = CIPH(B(i) ^ Y(i-1))
-      cipher->encryptBlock(context, y, y);
-
-      //Increment counter
-      ccmIncCounter(b, qLen);
-      //Compute S(i) = CIPH(CTR(i))
-      cipher->encryptBlock(context, b, s);
-      //Compute C(i) = B(i) XOR S(i)
-      ccmXorBlock(c, p, s, m);
-
-      //Next block
-      length -= m;
-      p += m;
-      c += m;
-   }
+   //Encrypt plaintext and compute the CBC-MAC
+   ccmProcessData(cipher, context, TRUE, b, qLen, y, p, c, length);
 
    //Compute MAC
    ccmXorBlock(t, t, y, tLen);
@@ -232,8 +379,8 @@ error_t ccmEncrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, si
 error_t ccmDecrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, size_t nLen,
    const uint8_t *a, size_t aLen, const uint8_t *c, uint8_t *p, size_t length, const uint8_t *t, size_t tLen)
 {
+   error_t error;
    size_t m;
-   size_t q;
    size_t qLen;
    uint8_t b[16];
    uint8_t y[16];
@@ -255,28 +402,14 @@ error_t ccmDecrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, si
    if(tLen < 4 || tLen > 16 || (tLen % 2) != 0)
       return ERROR_INVALID_LENGTH;
 
-   //Q is the bit string representation of the octet length of C
-   q = length;
    //Compute the octet length of Q
    qLen = 15 - nLen;
 
-   //Format the leading octet of the first block
-   b[0] = (aLen > 0) ? 0x40 : 0x00;
-   //Encode the octet length of T
-   b[0] |= ((tLen - 2) / 2) << 3;
-   //Encode the octet length of Q
-   b[0] |= qLen - 1;
-
-   //Copy the nonce
-   memcpy(b + 1, n, nLen);
-
-   //Encode the length field Q
-   for(m = 0; m < qLen; m++, q >>= 8)
-      b[15 - m] = q & 0xFF;
-
+   //Format the first block B(0)
+   error = ccmFormatFirstBlock(n, nLen, aLen, length, tLen, b);
    //Invalid length?
-   if(q != 0)
-      return ERROR_INVALID_LENGTH;
+   if(error)
+      return error;
 
    //Set Y(0) = CIPH(B(0))
    cipher->encryptBlock(context, b, y);
@@ -348,39 +481,341 @@ error_t ccmDecrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, si
    //Save MSB(S(0))
    memcpy(r, s, tLen);
 
-   //Decrypt ciphertext
-   while(length > 0)
+   //Decrypt ciphertext and compute the CBC-MAC
+   ccmProcessData(cipher, context, FALSE, b, qLen, y, c, p, length);
+
+   //Compute MAC
+   ccmXorBlock(r, r, y, tLen);
+
+   //The calculated tag is bitwise compared to the received tag. The
+   //message is authenticated if and only if the tags match
+   if(memcmp(r, t, tLen))
+      return ERROR_FAILURE;
+
+   //Successful decryption
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Start an incremental CCM operation
+ *
+ * CCM encodes the lengths of the additional data and of the payload in
+ * the first block, so they must be known in advance. The data themselves
+ * can then be supplied in chunks of any size
+ *
+ * @param[in] context Pointer to the CCM context
+ * @param[in] cipher Cipher algorithm
+ * @param[in] cipherContext Cipher algorithm context
+ * @param[in] encrypt TRUE for encryption, FALSE for decryption
+ * @param[in] n Nonce
+ * @param[in] nLen Length of the nonce
+ * @param[in] aLen Total length of the additional data
+ * @param[in] length Total length of the payload
+ * @param[in] tLen Length of the MAC
+ * @return Error code
+ **/
+
+error_t ccmStart(CcmContext *context, const CipherAlgo *cipher, void *cipherContext,
+   bool_t encrypt, const uint8_t *n, size_t nLen, size_t aLen, size_t length, size_t tLen)
+{
+   error_t error;
+
+   //Check parameters
+   if(context == NULL || cipher == NULL || cipherContext == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //CCM supports only symmetric block ciphers whose block size is 128 bits
+   if(cipher->type != CIPHER_ALGO_TYPE_BLOCK || cipher->blockSize != 16)
+      return ERROR_INVALID_PARAMETER;
+
+   //Check the length of the nonce
+   if(nLen < 7 || nLen > 13)
+      return ERROR_INVALID_LENGTH;
+   //Check the length of the MAC
+   if(tLen < 4 || tLen > 16 || (tLen % 2) != 0)
+      return ERROR_INVALID_LENGTH;
+
+   //Format the first block B(0)
+   error = ccmFormatFirstBlock(n, nLen, aLen, length, tLen, context->b);
+   //Invalid length?
+   if(error)
+      return error;
+
+   //Save parameters
+   context->cipher = cipher;
+   context->cipherContext = cipherContext;
+   context->encrypt = encrypt;
+   context->qLen = 15 - nLen;
+   context->tLen = tLen;
+   context->aLen = aLen;
+   context->length = length;
+   context->bufferLen = 0;
+
+   //Set Y(0) = CIPH(B(0))
+   cipher->encryptBlock(cipherContext, context->b, context->y);
+
+   //Any additional data?
+   if(aLen > 0)
    {
-      //The decryption operates in a block-by-block fashion
-      m = MIN(length, 16);
+      //Check the length of the associated data string
+      if(aLen < 0xFF00)
+      {
+         //The length is encoded as 2 octets
+         STORE16BE(aLen, context->buffer);
+         context->bufferLen = 2;
+      }
+      else
+      {
+         //The length is encoded as 6 octets
+         context->buffer[0] = 0xFF;
+         context->buffer[1] = 0xFE;
+         //MSB is stored first
+         STORE32BE(aLen, context->buffer + 2);
+         context->bufferLen = 6;
+      }
+   }
+
+   //Format CTR(0)
+   context->b[0] = (uint8_t) (context->qLen - 1);
+   //Copy the nonce
+   memcpy(context->b + 1, n, nLen);
+   //Initialize counter value
+   memset(context->b + 1 + nLen, 0, context->qLen);
+
+   //Compute S(0) = CIPH(CTR(0))
+   cipher->encryptBlock(cipherContext, context->b, context->s0);
+
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Feed additional authenticated data to an incremental CCM operation
+ * @param[in] context Pointer to the CCM context
+ * @param[in] a Additional authenticated data
+ * @param[in] aLen Length of the additional data
+ * @return Error code
+ **/
+
+error_t ccmUpdateAad(CcmContext *context, const uint8_t *a, size_t aLen)
+{
+   size_t m;
+
+   //Make sure the CCM context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //The total length of the additional data must not be exceeded
+   if(aLen > context->aLen)
+      return ERROR_INVALID_LENGTH;
+
+   //Process the additional data
+   while(aLen > 0)
+   {
+      //Associated data are processed in a block-by-block fashion
+      m = MIN(aLen, 16 - context->bufferLen);
+      memcpy(context->buffer + context->bufferLen, a, m);
+      context->bufferLen += m;
+
+      //Complete block?
+      if(context->bufferLen == 16)
+      {
+         //XOR B(i) with Y(i-1)
+         ccmXorBlock(context->y, context->buffer, context->y, 16);
+         //Compute Y(i) = CIPH(B(i) ^ Y(i-1))
+         context->cipher->encryptBlock(context->cipherContext,
+            context->y, context->y);
 
-      //Increment counter
-      ccmIncCounter(b, qLen);
-      //Compute S(i) = CIPH(CTR(i))
-      cipher->encryptBlock(context, b, s);
-      //Compute B(i) = C(i) XOR S(i)
-      ccmXorBlock(p, c, s, m);
+         //The buffer is now empty
+         context->bufferLen = 0;
+      }
+
+      //Next bytes
+      context->aLen -= m;
+      aLen -= m;
+      a += m;
+   }
 
+   //The last block of associated data is padded with zeros
+   if(context->aLen == 0 && context->bufferLen > 0)
+   {
       //XOR B(i) with Y(i-1)
-      ccmXorBlock(y, p, y, m);
+      ccmXorBlock(context->y, context->buffer, context->y,
+         context->bufferLen);
       //Compute Y(i) = CIPH(B(i) ^ Y(i-1))
-      cipher->encryptBlock(context, y, y);
+      context->cipher->encryptBlock(context->cipherContext,
+         context->y, context->y);
+
+      //The buffer is now empty
+      context->bufferLen = 0;
+   }
 
-      //Next block
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Encrypt or decrypt data as part of an incremental CCM operation
+ * @param[in] context Pointer to the CCM context
+ * @param[in] input Data to be encrypted or decrypted
+ * @param[out] output Resulting data
+ * @param[in] length Number of data bytes to process
+ * @return Error code
+ **/
+
+error_t ccmUpdate(CcmContext *context, const uint8_t *input, uint8_t *output, size_t length)
+{
+   size_t m;
+
+   //Make sure the CCM context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //All the additional data must be supplied before the payload
+   if(context->aLen != 0)
+      return ERROR_WRONG_STATE;
+
+   //The total length of the payload must not be exceeded
+   if(length > context->length)
+      return ERROR_INVALID_LENGTH;
+
+   //Process the payload
+   while(length > 0)
+   {
+      //Complete blocks can be processed directly from the input
+      if(context->bufferLen == 0 && length >= 16)
+      {
+         //Number of bytes to process
+         m = length - (length % 16);
+
+         //Interleave the CBC-MAC computation with the keystream generation
+         ccmProcessData(context->cipher, context->cipherContext,
+            context->encrypt, context->b, context->qLen, context->y,
+            input, output, m);
+      }
+      else
+      {
+         //Start of a new block?
+         if(context->bufferLen == 0)
+         {
+            //Increment counter
+            ccmIncCounter(context->b, context->qLen);
+            //Compute S(i) = CIPH(CTR(i))
+            context->cipher->encryptBlock(context->cipherContext,
+               context->b, context->s);
+         }
+
+         //Number of bytes to process
+         m = MIN(length, 16 - context->bufferLen);
+
+         //Encryption or decryption?
+         if(context->encrypt)
+         {
+            //Save the plaintext before it may be overwritten
+            memcpy(context->buffer + context->bufferLen, input, m);
+            //Compute C(i) = B(i) XOR S(i)
+            ccmXorBlock(output, input, context->s + context->bufferLen, m);
+         }
+         else
+         {
+            //Compute B(i) = C(i) XOR S(i)
+            ccmXorBlock(output, input, context->s + context->bufferLen, m);
+            //Save the plaintext
+            memcpy(context->buffer + context->bufferLen, output, m);
+         }
+
+         //Update the number of bytes in the partial block
+         context->bufferLen += m;
+
+         //Complete block?
+         if(context->bufferLen == 16)
+         {
+            //XOR B(i) with Y(i-1)
+            ccmXorBlock(context->y, context->buffer, context->y, 16);
+            //Compute Y(i) = CIPH(B(i) ^ Y(i-1))
+            context->cipher->encryptBlock(context->cipherContext,
+               context->y, context->y);
+
+            //The buffer is now empty
+            context->bufferLen = 0;
+         }
+      }
+
+      //Next bytes
+      context->length -= m;
       length -= m;
-      c += m;
-      p += m;
+      input += m;
+      output += m;
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Finish an incremental CCM operation
+ *
+ * For encryption, the MAC is computed and copied to the output buffer.
+ * For decryption, the calculated MAC is compared with the received one
+ *
+ * @param[in] context Pointer to the CCM context
+ * @param[in,out] t MAC
+ * @return Error code
+ **/
+
+error_t ccmFinish(CcmContext *context, uint8_t *t)
+{
+   size_t i;
+   uint8_t mask;
+   uint8_t r[16];
+
+   //Make sure the CCM context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //All the announced data must have been processed
+   if(context->aLen != 0 || context->length != 0)
+      return ERROR_INVALID_LENGTH;
+
+   //The last block of payload is padded with zeros
+   if(context->bufferLen > 0)
+   {
+      //XOR B(i) with Y(i-1)
+      ccmXorBlock(context->y, context->buffer, context->y,
+         context->bufferLen);
+      //Compute Y(i) = CIPH(B(i) ^ Y(i-1))
+      context->cipher->encryptBlock(context->cipherContext,
+         context->y, context->y);
+
+      //The buffer is now empty
+      context->bufferLen = 0;
    }
 
    //Compute MAC
-   ccmXorBlock(r, r, y, tLen);
+   ccmXorBlock(r, context->s0, context->y, context->tLen);
 
-   //The calculated tag is bitwise compared to the received tag. The
-   //message is authenticated if and only if the tags match
-   if(memcmp(r, t, tLen))
-      return ERROR_FAILURE;
+   //Encryption or decryption?
+   if(context->encrypt)
+   {
+      //Return the MAC
+      memcpy(t, r, context->tLen);
+   }
+   else
+   {
+      //The calculated tag is bitwise compared to the received tag
+      for(mask = 0, i = 0; i < context->tLen; i++)
+         mask |= r[i] ^ t[i];
 
-   //Successful decryption
+      //The message is authenticated if and only if the tags match
+      if(mask != 0)
+         return ERROR_FAILURE;
+   }
+
+   //Successful processing
    return NO_ERROR;
 }
 
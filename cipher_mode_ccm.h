@@ -32,11 +32,37 @@
 //Dependencies
 #include "crypto.h"
 
+//Number of counter blocks generated alongside each CBC-MAC block
+#define CCM_CTR_BLOCKS 4
+
 //C++ guard
 #ifdef __cplusplus
    extern "C" {
 #endif
 
+
+/**
+ * @brief CCM context (incremental API)
+ **/
+
+typedef struct
+{
+   const CipherAlgo *cipher; ///<Cipher algorithm
+   void *cipherContext;      ///<Cipher algorithm context
+   bool_t encrypt;           ///<Encryption or decryption
+   size_t qLen;              ///<Octet length of Q
+   size_t tLen;              ///<Length of the MAC
+   size_t aLen;              ///<Number of AAD bytes still expected
+   size_t length;            ///<Number of payload bytes still expected
+   uint8_t b[16];            ///<Counter block
+   uint8_t y[16];            ///<CBC-MAC value
+   uint8_t s0[16];           ///<First keystream block S(0)
+   uint8_t s[16];            ///<Keystream of the current partial block
+   uint8_t buffer[16];       ///<Partial block
+   size_t bufferLen;         ///<Number of bytes in the partial block
+} CcmContext;
+
+
 //CCM related functions
 error_t ccmEncrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, size_t nLen,
    const uint8_t *a, size_t aLen, const uint8_t *p, uint8_t *c, size_t length, uint8_t *t, size_t tLen);
@@ -44,6 +70,13 @@ error_t ccmEncrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, si
 error_t ccmDecrypt(const CipherAlgo *cipher, void *context, const uint8_t *n, size_t nLen,
    const uint8_t *a, size_t aLen, const uint8_t *c, uint8_t *p, size_t length, const uint8_t *t, size_t tLen);
 
+error_t ccmStart(CcmContext *context, const CipherAlgo *cipher, void *cipherContext,
+   bool_t encrypt, const uint8_t *n, size_t nLen, size_t aLen, size_t length, size_t tLen);
+
+error_t ccmUpdateAad(CcmContext *context, const uint8_t *a, size_t aLen);
+error_t ccmUpdate(CcmContext *context, const uint8_t *input, uint8_t *output, size_t length);
+error_t ccmFinish(CcmContext *context, uint8_t *t);
+
 void ccmXorBlock(uint8_t *x, const uint8_t *a, const uint8_t *b, size_t n);
 void ccmIncCounter(uint8_t *x, size_t n);
 
@@ -46,6 +46,93 @@
 #if (CTR_SUPPORT == ENABLED)
 
 
+/**
+ * @brief Generate a sequence of counter blocks
+ * @param[in] cipher Cipher algorithm
+ * @param[in] m Size in bytes of the specific part of the block to be incremented
+ * @param[in,out] t Counter block (updated with the next counter value)
+ * @param[out] o Counter blocks T(j) to T(j + k - 1)
+ * @param[in] k Number of counter blocks to generate
+ **/
+
+static void ctrGenerateCounterBlocks(const CipherAlgo *cipher, uint_t m,
+   uint8_t *t, uint8_t *o, size_t k)
+{
+   size_t i;
+   size_t j;
+   uint32_t x;
+   uint8_t *q;
+
+   //Point to the last 32 bits of the counter block
+   q = t + cipher->blockSize - 4;
+
+   //The counter can be handled as a 32-bit word as long as no carry
+   //propagates beyond the lowest word
+   if(m >= 4 && cipher->blockSize >= 4 && LOAD32BE(q) <= (0xFFFFFFFF - k))
+   {
+      //Retrieve the current value of the counter
+      x = LOAD32BE(q);
+
+      //Generate the counter blocks
+      for(j = 0; j < k; j++)
+      {
+         //Save current counter block
+         STORE32BE(x + j, q);
+         memcpy(o + j * cipher->blockSize, t, cipher->blockSize);
+      }
+
+      //Update the counter block
+      STORE32BE(x + k, q);
+   }
+   else
+   {
+      //Generate the counter blocks
+      for(j = 0; j < k; j++)
+      {
+         //Save current counter block
+         memcpy(o + j * cipher->blockSize, t, cipher->blockSize);
+
+         //Standard incrementing function
+         for(i = 0; i < m; i++)
+         {
+            //Increment the current byte and propagate the carry if necessary
+            if(++(t[cipher->blockSize - 1 - i]) != 0)
+               break;
+         }
+      }
+   }
+}
+
+
+/**
+ * @brief XOR operation
+ * @param[out] x Output data
+ * @param[in] a First input data
+ * @param[in] b Second input data
+ * @param[in] n Number of bytes to process
+ **/
+
+static void ctrXorBlock(uint8_t *x, const uint8_t *a, const uint8_t *b, size_t n)
+{
+   size_t i;
+   uint32_t u;
+   uint32_t v;
+
+   //Process 32-bit words (memcpy is used to avoid alignment issues)
+   for(i = 0; (i + 4) <= n; i += 4)
+   {
+      memcpy(&u, a + i, 4);
+      memcpy(&v, b + i, 4);
+      u ^= v;
+      memcpy(x + i, &u, 4);
+   }
+
+   //Process the remaining bytes
+   for(; i < n; i++)
+      x[i] = a[i] ^ b[i];
+}
+
+
 /**
  * @brief CTR encryption
  * @param[in] cipher Cipher algorithm
@@ -62,8 +149,9 @@ error_t ctrEncrypt(const CipherAlgo *cipher, void *context, uint_t m,
    uint8_t *t, const uint8_t *p, uint8_t *c, size_t length)
 {
    size_t i;
+   size_t k;
    size_t n;
-   uint8_t o[16];
+   uint8_t o[CIPHER_PARALLEL_BLOCKS * 16];
 
    //The parameter must be a multiple of 8
    if((m % 8) != 0)
@@ -77,6 +165,35 @@ error_t ctrEncrypt(const CipherAlgo *cipher, void *context, uint_t m,
    if(m > cipher->blockSize)
       return ERROR_INVALID_PARAMETER;
 
+   //Multi-block encryption routine available?
+   if(cipher->encryptBlocks != NULL)
+   {
+      //Process several blocks at a time
+      while(length > 0)
+      {
+         //Limit the number of blocks to process at a time
+         k = MIN((length + cipher->blockSize - 1) / cipher->blockSize,
+            CIPHER_PARALLEL_BLOCKS);
+
+         //Generate the counter blocks T(j) to T(j + k - 1)
+         ctrGenerateCounterBlocks(cipher, m, t, o, k);
+
+         //Compute O(j) = CIPH(T(j)) for all the counter blocks at once
+         cipher->encryptBlocks(context, o, o, k);
+
+         //Number of bytes to process
+         n = MIN(length, k * cipher->blockSize);
+
+         //Compute C(j) = P(j) XOR T(j)
+         ctrXorBlock(c, p, o, n);
+
+         //Next blocks
+         p += n;
+         c += n;
+         length -= n;
+      }
+   }
+
    //Process plaintext
    while(length > 0)
    {
@@ -125,8 +242,9 @@ error_t ctrDecrypt(const CipherAlgo *cipher, void *context, uint_t m,
    uint8_t *t, const uint8_t *c, uint8_t *p, size_t length)
 {
    size_t i;
+   size_t k;
    size_t n;
-   uint8_t o[16];
+   uint8_t o[CIPHER_PARALLEL_BLOCKS * 16];
 
    //The parameter must be a multiple of 8
    if((m % 8) != 0)
@@ -140,6 +258,35 @@ error_t ctrDecrypt(const CipherAlgo *cipher, void *context, uint_t m,
    if(m > cipher->blockSize)
       return ERROR_INVALID_PARAMETER;
 
+   //Multi-block encryption routine available?
+   if(cipher->encryptBlocks != NULL)
+   {
+      //Process several blocks at a time
+      while(length > 0)
+      {
+         //Limit the number of blocks to process at a time
+         k = MIN((length + cipher->blockSize - 1) / cipher->blockSize,
+            CIPHER_PARALLEL_BLOCKS);
+
+         //Generate the counter blocks T(j) to T(j + k - 1)
+         ctrGenerateCounterBlocks(cipher, m, t, o, k);
+
+         //Compute O(j) = CIPH(T(j)) for all the counter blocks at once
+         cipher->encryptBlocks(context, o, o, k);
+
+         //Number of bytes to process
+         n = MIN(length, k * cipher->blockSize);
+
+         //Compute P(j) = C(j) XOR T(j)
+         ctrXorBlock(p, c, o, n);
+
+         //Next blocks
+         c += n;
+         p += n;
+         length -= n;
+      }
+   }
+
    //Process ciphertext
    while(length > 0)
    {
@@ -171,4 +318,52 @@ error_t ctrDecrypt(const CipherAlgo *cipher, void *context, uint_t m,
    return NO_ERROR;
 }
 
+
+/**
+ * @brief Advance a counter block
+ *
+ * Since each keystream block only depends on its counter block, a large
+ * buffer can be split into several parts that are processed independently
+ * (by different threads, for instance). The counter block of a part that
+ * starts at byte offset k * blockSize is obtained by advancing the initial
+ * counter block by k, and the concatenated result is identical to the
+ * output of a single ctrEncrypt call
+ *
+ * @param[in] cipher Cipher algorithm
+ * @param[in] m Size in bits of the specific part of the block to be incremented
+ * @param[in,out] t Counter block
+ * @param[in] n Number of blocks to skip
+ * @return Error code
+ **/
+
+error_t ctrSeek(const CipherAlgo *cipher, uint_t m, uint8_t *t, uint64_t n)
+{
+   uint_t i;
+   uint_t x;
+
+   //The parameter must be a multiple of 8
+   if((m % 8) != 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //Determine the size, in bytes, of the specific part of
+   //the block to be incremented
+   m = m / 8;
+
+   //Check the resulting value
+   if(m > cipher->blockSize)
+      return ERROR_INVALID_PARAMETER;
+
+   //Add the value to the specific part of the counter block
+   for(i = 0; i < m && n != 0; i++)
+   {
+      //Add the current byte and propagate the carry
+      x = t[cipher->blockSize - 1 - i] + (uint_t) (n & 0xFF);
+      t[cipher->blockSize - 1 - i] = x & 0xFF;
+      n = (n >> 8) + (x >> 8);
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
 #endif
@@ -44,6 +44,8 @@ error_t ctrEncrypt(const CipherAlgo *cipher, void *context, uint_t m,
 error_t ctrDecrypt(const CipherAlgo *cipher, void *context, uint_t m,
    uint8_t *t, const uint8_t *c, uint8_t *p, size_t length);
 
+error_t ctrSeek(const CipherAlgo *cipher, uint_t m, uint8_t *t, uint64_t n);
+
 //C++ guard
 #ifdef __cplusplus
    }
@@ -39,12 +39,61 @@
 #include <string.h>
 #include "crypto.h"
 #include "cipher_mode_gcm.h"
+#include "aes.h"
+#include "cpu_features.h"
 #include "debug.h"
 
+//PCLMULQDQ instruction set support?
+#if (PCLMUL_SUPPORT == ENABLED)
+   #include <emmintrin.h>
+   #include <tmmintrin.h>
+   #include <wmmintrin.h>
+#endif
+
 //Check crypto library configuration
 #if (GCM_SUPPORT == ENABLED)
 
 //Reduction table
+#if (GCM_TABLE_W == 8)
+
+static const uint32_t r[256] =
+{
+   0x00000000, 0x01C20000, 0x03840000, 0x02460000, 0x07080000, 0x06CA0000, 0x048C0000, 0x054E0000,
+   0x0E100000, 0x0FD20000, 0x0D940000, 0x0C560000, 0x09180000, 0x08DA0000, 0x0A9C0000, 0x0B5E0000,
+   0x1C200000, 0x1DE20000, 0x1FA40000, 0x1E660000, 0x1B280000, 0x1AEA0000, 0x18AC0000, 0x196E0000,
+   0x12300000, 0x13F20000, 0x11B40000, 0x10760000, 0x15380000, 0x14FA0000, 0x16BC0000, 0x177E0000,
+   0x38400000, 0x39820000, 0x3BC40000, 0x3A060000, 0x3F480000, 0x3E8A0000, 0x3CCC0000, 0x3D0E0000,
+   0x36500000, 0x37920000, 0x35D40000, 0x34160000, 0x31580000, 0x309A0000, 0x32DC0000, 0x331E0000,
+   0x24600000, 0x25A20000, 0x27E40000, 0x26260000, 0x23680000, 0x22AA0000, 0x20EC0000, 0x212E0000,
+   0x2A700000, 0x2BB20000, 0x29F40000, 0x28360000, 0x2D780000, 0x2CBA0000, 0x2EFC0000, 0x2F3E0000,
+   0x70800000, 0x71420000, 0x73040000, 0x72C60000, 0x77880000, 0x764A0000, 0x740C0000, 0x75CE0000,
+   0x7E900000, 0x7F520000, 0x7D140000, 0x7CD60000, 0x79980000, 0x785A0000, 0x7A1C0000, 0x7BDE0000,
+   0x6CA00000, 0x6D620000, 0x6F240000, 0x6EE60000, 0x6BA80000, 0x6A6A0000, 0x682C0000, 0x69EE0000,
+   0x62B00000, 0x63720000, 0x61340000, 0x60F60000, 0x65B80000, 0x647A0000, 0x663C0000, 0x67FE0000,
+   0x48C00000, 0x49020000, 0x4B440000, 0x4A860000, 0x4FC80000, 0x4E0A0000, 0x4C4C0000, 0x4D8E0000,
+   0x46D00000, 0x47120000, 0x45540000, 0x44960000, 0x41D80000, 0x401A0000, 0x425C0000, 0x439E0000,
+   0x54E00000, 0x55220000, 0x57640000, 0x56A60000, 0x53E80000, 0x522A0000, 0x506C0000, 0x51AE0000,
+   0x5AF00000, 0x5B320000, 0x59740000, 0x58B60000, 0x5DF80000, 0x5C3A0000, 0x5E7C0000, 0x5FBE0000,
+   0xE1000000, 0xE0C20000, 0xE2840000, 0xE3460000, 0xE6080000, 0xE7CA0000, 0xE58C0000, 0xE44E0000,
+   0xEF100000, 0xEED20000, 0xEC940000, 0xED560000, 0xE8180000, 0xE9DA0000, 0xEB9C0000, 0xEA5E0000,
+   0xFD200000, 0xFCE20000, 0xFEA40000, 0xFF660000, 0xFA280000, 0xFBEA0000, 0xF9AC0000, 0xF86E0000,
+   0xF3300000, 0xF2F20000, 0xF0B40000, 0xF1760000, 0xF4380000, 0xF5FA0000, 0xF7BC0000, 0xF67E0000,
+   0xD9400000, 0xD8820000, 0xDAC40000, 0xDB060000, 0xDE480000, 0xDF8A0000, 0xDDCC0000, 0xDC0E0000,
+   0xD7500000, 0xD6920000, 0xD4D40000, 0xD5160000, 0xD0580000, 0xD19A0000, 0xD3DC0000, 0xD21E0000,
+   0xC5600000, 0xC4A20000, 0xC6E40000, 0xC7260000, 0xC2680000, 0xC3AA0000, 0xC1EC0000, 0xC02E0000,
+   0xCB700000, 0xCAB20000, 0xC8F40000, 0xC9360000, 0xCC780000, 0xCDBA0000, 0xCFFC0000, 0xCE3E0000,
+   0x91800000, 0x90420000, 0x92040000, 0x93C60000, 0x96880000, 0x974A0000, 0x950C0000, 0x94CE0000,
+   0x9F900000, 0x9E520000, 0x9C140000, 0x9DD60000, 0x98980000, 0x995A0000, 0x9B1C0000, 0x9ADE0000,
+   0x8DA00000, 0x8C620000, 0x8E240000, 0x8FE60000, 0x8AA80000, 0x8B6A0000, 0x892C0000, 0x88EE0000,
+   0x83B00000, 0x82720000, 0x80340000, 0x81F60000, 0x84B80000, 0x857A0000, 0x873C0000, 0x86FE0000,
+   0xA9C00000, 0xA8020000, 0xAA440000, 0xAB860000, 0xAEC80000, 0xAF0A0000, 0xAD4C0000, 0xAC8E0000,
+   0xA7D00000, 0xA6120000, 0xA4540000, 0xA5960000, 0xA0D80000, 0xA11A0000, 0xA35C0000, 0xA29E0000,
+   0xB5E00000, 0xB4220000, 0xB6640000, 0xB7A60000, 0xB2E80000, 0xB32A0000, 0xB16C0000, 0xB0AE0000,
+   0xBBF00000, 0xBA320000, 0xB8740000, 0xB9B60000, 0xBCF80000, 0xBD3A0000, 0xBF7C0000, 0xBEBE0000
+};
+
+#else
+
 static const uint32_t r[16] =
 {
    0x00000000,
@@ -65,6 +114,525 @@ static const uint32_t r[16] =
    0xB5E00000
 };
 
+#endif
+
+//Bit reversal of a table index
+#if (GCM_TABLE_W == 8)
+   #define GCM_REVERSE_INDEX(i) reverseInt8(i)
+#else
+   #define GCM_REVERSE_INDEX(i) reverseInt4(i)
+#endif
+
+
+//PCLMULQDQ instruction set support?
+#if (PCLMUL_SUPPORT == ENABLED)
+
+//The carry-less multiplication path requires PCLMULQDQ and SSSE3 instructions
+#define GCM_CLMUL_FEATURES (CPU_FEATURE_PCLMULQDQ | CPU_FEATURE_SSSE3)
+
+
+/**
+ * @brief Reverse the byte order of a 128-bit value
+ * @param[in] a 128-bit value
+ * @return Byte-reversed value
+ **/
+
+CPU_TARGET("pclmul,ssse3") static __m128i gcmClmulSwap(__m128i a)
+{
+   return _mm_shuffle_epi8(a, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+      8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+
+/**
+ * @brief Carry-less multiplication of two 128-bit values
+ * @param[in] a First operand
+ * @param[in] b Second operand
+ * @param[in,out] lo Accumulator (lower 128 bits of the product)
+ * @param[in,out] hi Accumulator (upper 128 bits of the product)
+ **/
+
+CPU_TARGET("pclmul,ssse3") static void gcmClmulMulAcc(__m128i a, __m128i b,
+   __m128i *lo, __m128i *hi)
+{
+   __m128i t0;
+   __m128i t1;
+   __m128i t2;
+   __m128i t3;
+
+   //Schoolbook multiplication using four 64x64-bit carry-less products
+   t0 = _mm_clmulepi64_si128(a, b, 0x00);
+   t1 = _mm_clmulepi64_si128(a, b, 0x10);
+   t2 = _mm_clmulepi64_si128(a, b, 0x01);
+   t3 = _mm_clmulepi64_si128(a, b, 0x11);
+
+   //Combine the middle terms
+   t1 = _mm_xor_si128(t1, t2);
+   t0 = _mm_xor_si128(t0, _mm_slli_si128(t1, 8));
+   t3 = _mm_xor_si128(t3, _mm_srli_si128(t1, 8));
+
+   //An addition in GF(2^128) is identical to a bitwise exclusive-OR
+   //operation, so the reduction can be deferred
+   *lo = _mm_xor_si128(*lo, t0);
+   *hi = _mm_xor_si128(*hi, t3);
+}
+
+
+/**
+ * @brief Reduction modulo the GCM polynomial
+ * @param[in] lo Lower 128 bits of the 256-bit product
+ * @param[in] hi Upper 128 bits of the 256-bit product
+ * @return Reduced 128-bit value
+ **/
+
+CPU_TARGET("pclmul,ssse3") static __m128i gcmClmulReduce(__m128i lo, __m128i hi)
+{
+   __m128i t0;
+   __m128i t1;
+   __m128i t2;
+
+   //The operands are bit-reflected, hence the 256-bit product must be
+   //shifted left by one bit
+   t0 = _mm_srli_epi32(lo, 31);
+   t1 = _mm_srli_epi32(hi, 31);
+   lo = _mm_slli_epi32(lo, 1);
+   hi = _mm_slli_epi32(hi, 1);
+   t2 = _mm_srli_si128(t0, 12);
+   t1 = _mm_slli_si128(t1, 4);
+   t0 = _mm_slli_si128(t0, 4);
+   lo = _mm_or_si128(lo, t0);
+   hi = _mm_or_si128(hi, t1);
+   hi = _mm_or_si128(hi, t2);
+
+   //First phase of the reduction (x^128 = x^7 + x^2 + x + 1)
+   t0 = _mm_slli_epi32(lo, 31);
+   t1 = _mm_slli_epi32(lo, 30);
+   t2 = _mm_slli_epi32(lo, 25);
+   t0 = _mm_xor_si128(t0, t1);
+   t0 = _mm_xor_si128(t0, t2);
+   t1 = _mm_srli_si128(t0, 4);
+   t0 = _mm_slli_si128(t0, 12);
+   lo = _mm_xor_si128(lo, t0);
+
+   //Second phase of the reduction
+   t2 = _mm_srli_epi32(lo, 1);
+   t0 = _mm_srli_epi32(lo, 2);
+   t2 = _mm_xor_si128(t2, t0);
+   t0 = _mm_srli_epi32(lo, 7);
+   t2 = _mm_xor_si128(t2, t0);
+   t2 = _mm_xor_si128(t2, t1);
+   lo = _mm_xor_si128(lo, t2);
+
+   //Return the result
+   return _mm_xor_si128(hi, lo);
+}
+
+
+/**
+ * @brief Multiplication in GF(2^128) using PCLMULQDQ instruction
+ * @param[in] a First operand (byte-reversed)
+ * @param[in] b Second operand (byte-reversed)
+ * @return Result of the multiplication (byte-reversed)
+ **/
+
+CPU_TARGET("pclmul,ssse3") static __m128i gcmClmulMul(__m128i a, __m128i b)
+{
+   __m128i lo;
+   __m128i hi;
+
+   //Compute the 256-bit product
+   lo = _mm_setzero_si128();
+   hi = _mm_setzero_si128();
+   gcmClmulMulAcc(a, b, &lo, &hi);
+
+   //Perform reduction
+   return gcmClmulReduce(lo, hi);
+}
+
+
+/**
+ * @brief Precompute the powers of the hash subkey
+ * @param[in] context Pointer to the GCM context
+ * @param[in] h Hash subkey H
+ **/
+
+CPU_TARGET("pclmul,ssse3") static void gcmClmulInit(GcmContext *context,
+   const uint8_t *h)
+{
+   uint_t i;
+   __m128i x;
+   __m128i y;
+
+   //The powers are stored in byte-reversed order
+   x = gcmClmulSwap(_mm_loadu_si128((const __m128i *) h));
+   y = x;
+
+   //Compute H, H^2, ..., H^8
+   for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+   {
+      _mm_storeu_si128((__m128i *) context->hp[i], y);
+      y = gcmClmulMul(y, x);
+   }
+}
+
+
+/**
+ * @brief GHASH function using PCLMULQDQ instruction
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] s GHASH accumulator
+ * @param[in] data Pointer to the data
+ * @param[in] length Length of the data
+ **/
+
+CPU_TARGET("pclmul,ssse3") static void gcmClmulGhash(GcmContext *context,
+   uint8_t *s, const uint8_t *data, size_t length)
+{
+   uint_t i;
+   size_t k;
+   __m128i x;
+   __m128i y;
+   __m128i lo;
+   __m128i hi;
+   uint8_t b[16];
+
+   //Load the accumulator
+   y = gcmClmulSwap(_mm_loadu_si128((const __m128i *) s));
+
+   //Aggregated reduction: Y' = (Y + X1) * H^8 + X2 * H^7 + ... + X8 * H,
+   //so that only one reduction is needed per group of 8 blocks
+   while(length >= (GCM_CLMUL_BLOCKS * 16))
+   {
+      lo = _mm_setzero_si128();
+      hi = _mm_setzero_si128();
+
+      //The first block is combined with the accumulator
+      x = gcmClmulSwap(_mm_loadu_si128((const __m128i *) data));
+      x = _mm_xor_si128(x, y);
+      gcmClmulMulAcc(x, _mm_loadu_si128((const __m128i *)
+         context->hp[GCM_CLMUL_BLOCKS - 1]), &lo, &hi);
+
+      //Multiply each subsequent block by the relevant power of H
+      for(i = 1; i < GCM_CLMUL_BLOCKS; i++)
+      {
+         x = gcmClmulSwap(_mm_loadu_si128((const __m128i *) data + i));
+         gcmClmulMulAcc(x, _mm_loadu_si128((const __m128i *)
+            context->hp[GCM_CLMUL_BLOCKS - 1 - i]), &lo, &hi);
+      }
+
+      //Perform reduction
+      y = gcmClmulReduce(lo, hi);
+
+      //Next blocks
+      data += GCM_CLMUL_BLOCKS * 16;
+      length -= GCM_CLMUL_BLOCKS * 16;
+   }
+
+   //Process the remaining blocks one at a time
+   while(length > 0)
+   {
+      //The last block is padded with zeros
+      k = MIN(length, 16);
+      memset(b, 0, 16);
+      memcpy(b, data, k);
+
+      //Compute Y = (Y + X) * H
+      x = gcmClmulSwap(_mm_loadu_si128((const __m128i *) b));
+      x = _mm_xor_si128(x, y);
+      y = gcmClmulMul(x, _mm_loadu_si128((const __m128i *) context->hp[0]));
+
+      //Next block
+      data += k;
+      length -= k;
+   }
+
+   //Save the accumulator
+   _mm_storeu_si128((__m128i *) s, gcmClmulSwap(y));
+}
+
+#endif
+
+//Stitched AES-GCM implementation?
+#if (AESNI_SUPPORT == ENABLED && PCLMUL_SUPPORT == ENABLED && AES_SUPPORT == ENABLED)
+
+//The stitched implementation requires AES-NI, PCLMULQDQ and SSSE3 instructions
+#define GCM_AESNI_FEATURES (CPU_FEATURE_AESNI | GCM_CLMUL_FEATURES)
+
+
+/**
+ * @brief Check whether the stitched AES-GCM implementation can be used
+ * @param[in] context Pointer to the GCM context
+ * @return TRUE if the stitched implementation is available, else FALSE
+ **/
+
+static bool_t gcmAesniAvailable(GcmContext *context)
+{
+   //The underlying cipher must be AES
+   if(context->cipherAlgo != AES_CIPHER_ALGO)
+      return FALSE;
+
+   //Check whether the CPU supports the relevant instructions
+   if((cpuGetFeatures() & GCM_AESNI_FEATURES) != GCM_AESNI_FEATURES)
+      return FALSE;
+
+   //The stitched implementation is available
+   return TRUE;
+}
+
+
+/**
+ * @brief Stitched AES-GCM encryption
+ *
+ * Each iteration generates 8 keystream blocks while the GHASH of the 8
+ * ciphertext blocks produced by the previous iteration is computed, so
+ * that the AES and carry-less multiplication units operate in parallel
+ *
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] j Counter block
+ * @param[in,out] s GHASH accumulator
+ * @param[in] p Plaintext to be encrypted
+ * @param[out] c Resulting ciphertext
+ * @param[in] length Total number of data bytes available
+ * @return Number of bytes actually processed (multiple of 128)
+ **/
+
+CPU_TARGET("aes,pclmul,ssse3") static size_t gcmAesniEncrypt(GcmContext *context,
+   uint8_t *j, uint8_t *s, const uint8_t *p, uint8_t *c, size_t length)
+{
+   uint_t i;
+   uint_t r;
+   size_t n;
+   size_t offset;
+   AesContext *aesContext;
+   const __m128i *rk;
+   __m128i k;
+   __m128i y;
+   __m128i lo;
+   __m128i hi;
+   __m128i ctr;
+   __m128i one;
+   __m128i t[GCM_CLMUL_BLOCKS];
+   __m128i x[GCM_CLMUL_BLOCKS];
+
+   //Process as many groups of 8 blocks as possible
+   n = length - (length % (GCM_CLMUL_BLOCKS * 16));
+
+   //Any data to process?
+   if(n == 0)
+      return 0;
+
+   //Point to the AES round keys
+   aesContext = (AesContext *) context->cipherContext;
+   rk = (const __m128i *) aesContext->ek;
+
+   //The 32-bit counter lies in the lowest word of the byte-reversed block
+   ctr = gcmClmulSwap(_mm_loadu_si128((const __m128i *) j));
+   one = _mm_set_epi32(0, 0, 0, 1);
+
+   //Load the GHASH accumulator
+   y = gcmClmulSwap(_mm_loadu_si128((const __m128i *) s));
+   lo = _mm_setzero_si128();
+   hi = _mm_setzero_si128();
+
+   //Process the data
+   for(offset = 0; offset < n; offset += GCM_CLMUL_BLOCKS * 16)
+   {
+      //Generate the counter blocks (initial round)
+      for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+      {
+         ctr = _mm_add_epi32(ctr, one);
+         t[i] = _mm_xor_si128(gcmClmulSwap(ctr), _mm_loadu_si128(rk));
+      }
+
+      //Load the ciphertext blocks produced by the previous iteration
+      if(offset > 0)
+      {
+         for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+         {
+            x[i] = gcmClmulSwap(_mm_loadu_si128((const __m128i *)
+               (c + offset - GCM_CLMUL_BLOCKS * 16) + i));
+         }
+
+         //The first block is combined with the accumulator
+         x[0] = _mm_xor_si128(x[0], y);
+         lo = _mm_setzero_si128();
+         hi = _mm_setzero_si128();
+      }
+
+      //Apply the AES rounds, interleaved with the GHASH multiplications
+      for(r = 1; r < aesContext->nr; r++)
+      {
+         k = _mm_loadu_si128(rk + r);
+
+         for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+         {
+            t[i] = _mm_aesenc_si128(t[i], k);
+         }
+
+         //AES performs at least 9 full rounds, so there is room for one
+         //multiplication per round
+         if(offset > 0 && r <= GCM_CLMUL_BLOCKS)
+         {
+            gcmClmulMulAcc(x[r - 1], _mm_loadu_si128((const __m128i *)
+               context->hp[GCM_CLMUL_BLOCKS - r]), &lo, &hi);
+         }
+      }
+
+      //Final round
+      k = _mm_loadu_si128(rk + aesContext->nr);
+
+      for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+      {
+         t[i] = _mm_aesenclast_si128(t[i], k);
+      }
+
+      //Perform reduction
+      if(offset > 0)
+         y = gcmClmulReduce(lo, hi);
+
+      //Encrypt plaintext
+      for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+      {
+         t[i] = _mm_xor_si128(t[i], _mm_loadu_si128((const __m128i *)
+            (p + offset) + i));
+         _mm_storeu_si128((__m128i *) (c + offset) + i, t[i]);
+      }
+   }
+
+   //Save the counter block and the GHASH accumulator
+   _mm_storeu_si128((__m128i *) j, gcmClmulSwap(ctr));
+   _mm_storeu_si128((__m128i *) s, gcmClmulSwap(y));
+
+   //Apply GHASH function to the last ciphertext blocks
+   gcmClmulGhash(context, s, c + n - GCM_CLMUL_BLOCKS * 16,
+      GCM_CLMUL_BLOCKS * 16);
+
+   //Return the number of bytes processed
+   return n;
+}
+
+
+/**
+ * @brief Stitched AES-GCM decryption
+ *
+ * Each iteration generates 8 keystream blocks while the GHASH of the
+ * corresponding 8 ciphertext blocks is computed
+ *
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] j Counter block
+ * @param[in,out] s GHASH accumulator
+ * @param[in] c Ciphertext to be decrypted
+ * @param[out] p Resulting plaintext
+ * @param[in] length Total number of data bytes available
+ * @return Number of bytes actually processed (multiple of 128)
+ **/
+
+CPU_TARGET("aes,pclmul,ssse3") static size_t gcmAesniDecrypt(GcmContext *context,
+   uint8_t *j, uint8_t *s, const uint8_t *c, uint8_t *p, size_t length)
+{
+   uint_t i;
+   uint_t r;
+   size_t n;
+   size_t offset;
+   AesContext *aesContext;
+   const __m128i *rk;
+   __m128i k;
+   __m128i y;
+   __m128i lo;
+   __m128i hi;
+   __m128i ctr;
+   __m128i one;
+   __m128i t[GCM_CLMUL_BLOCKS];
+   __m128i x[GCM_CLMUL_BLOCKS];
+   __m128i d[GCM_CLMUL_BLOCKS];
+
+   //Process as many groups of 8 blocks as possible
+   n = length - (length % (GCM_CLMUL_BLOCKS * 16));
+
+   //Any data to process?
+   if(n == 0)
+      return 0;
+
+   //Point to the AES round keys
+   aesContext = (AesContext *) context->cipherContext;
+   rk = (const __m128i *) aesContext->ek;
+
+   //The 32-bit counter lies in the lowest word of the byte-reversed block
+   ctr = gcmClmulSwap(_mm_loadu_si128((const __m128i *) j));
+   one = _mm_set_epi32(0, 0, 0, 1);
+
+   //Load the GHASH accumulator
+   y = gcmClmulSwap(_mm_loadu_si128((const __m128i *) s));
+
+   //Process the data
+   for(offset = 0; offset < n; offset += GCM_CLMUL_BLOCKS * 16)
+   {
+      //Load the ciphertext blocks before the output may overwrite them
+      for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+      {
+         d[i] = _mm_loadu_si128((const __m128i *) (c + offset) + i);
+         x[i] = gcmClmulSwap(d[i]);
+      }
+
+      //The first block is combined with the accumulator
+      x[0] = _mm_xor_si128(x[0], y);
+      lo = _mm_setzero_si128();
+      hi = _mm_setzero_si128();
+
+      //Generate the counter blocks (initial round)
+      for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+      {
+         ctr = _mm_add_epi32(ctr, one);
+         t[i] = _mm_xor_si128(gcmClmulSwap(ctr), _mm_loadu_si128(rk));
+      }
+
+      //Apply the AES rounds, interleaved with the GHASH multiplications
+      for(r = 1; r < aesContext->nr; r++)
+      {
+         k = _mm_loadu_si128(rk + r);
+
+         for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+         {
+            t[i] = _mm_aesenc_si128(t[i], k);
+         }
+
+         //AES performs at least 9 full rounds, so there is room for one
+         //multiplication per round
+         if(r <= GCM_CLMUL_BLOCKS)
+         {
+            gcmClmulMulAcc(x[r - 1], _mm_loadu_si128((const __m128i *)
+               context->hp[GCM_CLMUL_BLOCKS - r]), &lo, &hi);
+         }
+      }
+
+      //Final round
+      k = _mm_loadu_si128(rk + aesContext->nr);
+
+      for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+      {
+         t[i] = _mm_aesenclast_si128(t[i], k);
+      }
+
+      //Perform reduction
+      y = gcmClmulReduce(lo, hi);
+
+      //Decrypt ciphertext
+      for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+      {
+         _mm_storeu_si128((__m128i *) (p + offset) + i,
+            _mm_xor_si128(t[i], d[i]));
+      }
+   }
+
+   //Save the counter block and the GHASH accumulator
+   _mm_storeu_si128((__m128i *) j, gcmClmulSwap(ctr));
+   _mm_storeu_si128((__m128i *) s, gcmClmulSwap(y));
+
+   //Return the number of bytes processed
+   return n;
+}
+
+#endif
+
 
 /**
  * @brief Initialize GCM context
@@ -99,28 +667,37 @@ error_t gcmInit(GcmContext *context, const CipherAlgo *cipherAlgo, void *cipherC
    context->cipherAlgo->encryptBlock(context->cipherContext,
       (uint8_t *) h, (uint8_t *) h);
 
+#if (PCLMUL_SUPPORT == ENABLED)
+   //Check whether the CPU supports carry-less multiplication
+   if((cpuGetFeatures() & GCM_CLMUL_FEATURES) == GCM_CLMUL_FEATURES)
+   {
+      //Precompute H, H^2, ..., H^8
+      gcmClmulInit(context, (uint8_t *) h);
+   }
+#endif
+
    //Pre-compute M(0) = H * 0
-   j = reverseInt4(0);
+   j = GCM_REVERSE_INDEX(0);
    context->m[j][0] = 0;
    context->m[j][1] = 0;
    context->m[j][2] = 0;
    context->m[j][3] = 0;
 
    //Pre-compute M(1) = H * 1
-   j = reverseInt4(1);
+   j = GCM_REVERSE_INDEX(1);
    context->m[j][0] = betoh32(h[3]);
    context->m[j][1] = betoh32(h[2]);
    context->m[j][2] = betoh32(h[1]);
    context->m[j][3] = betoh32(h[0]);
 
-   //Pre-compute all 4-bit multiples of H
-   for(i = 2; i < 16; i++)
+   //Pre-compute all 4-bit (or 8-bit) multiples of H
+   for(i = 2; i < (1 << GCM_TABLE_W); i++)
    {
       //Odd value?
       if(i & 1)
       {
          //Compute M(i) = M(i - 1) + H
-         j = reverseInt4(i - 1);
+         j = GCM_REVERSE_INDEX(i - 1);
          h[0] = context->m[j][0];
          h[1] = context->m[j][1];
          h[2] = context->m[j][2];
@@ -128,7 +705,7 @@ error_t gcmInit(GcmContext *context, const CipherAlgo *cipherAlgo, void *cipherC
 
          //An addition in GF(2^128) is identical to a bitwise
          //exclusive-OR operation
-         j = reverseInt4(1);
+         j = GCM_REVERSE_INDEX(1);
          h[0] ^= context->m[j][0];
          h[1] ^= context->m[j][1];
          h[2] ^= context->m[j][2];
@@ -138,7 +715,7 @@ error_t gcmInit(GcmContext *context, const CipherAlgo *cipherAlgo, void *cipherC
       else
       {
          //Compute M(i) = M(i / 2) * x
-         j = reverseInt4(i / 2);
+         j = GCM_REVERSE_INDEX(i / 2);
          h[0] = context->m[j][0];
          h[1] = context->m[j][1];
          h[2] = context->m[j][2];
@@ -156,12 +733,12 @@ error_t gcmInit(GcmContext *context, const CipherAlgo *cipherAlgo, void *cipherC
          //then perform reduction
          if(c != 0)
          {
-            h[3] ^= r[reverseInt4(1)];
+            h[3] ^= r[GCM_REVERSE_INDEX(1)];
          }
       }
 
       //Save M(i)
-      j = reverseInt4(i);
+      j = GCM_REVERSE_INDEX(i);
       context->m[j][0] = h[0];
       context->m[j][1] = h[1];
       context->m[j][2] = h[2];
@@ -174,40 +751,57 @@ error_t gcmInit(GcmContext *context, const CipherAlgo *cipherAlgo, void *cipherC
 
 
 /**
- * @brief Authenticated encryption using GCM
+ * @brief Generate keystream blocks
  * @param[in] context Pointer to the GCM context
- * @param[in] iv Initialization vector
- * @param[in] ivLen Length of the initialization vector
- * @param[in] a Additional authenticated data
- * @param[in] aLen Length of the additional data
- * @param[in] p Plaintext to be encrypted
- * @param[out] c Ciphertext resulting from the encryption
- * @param[in] length Total number of data bytes to be encrypted
- * @param[out] t Authentication tag
- * @param[in] tLen Length of the authentication tag
- * @return Error code
+ * @param[in,out] j Counter block
+ * @param[out] o Keystream blocks
+ * @param[in] n Number of keystream blocks to generate
  **/
 
-error_t gcmEncrypt(GcmContext *context, const uint8_t *iv, size_t ivLen, const uint8_t *a,
-   size_t aLen, const uint8_t *p, uint8_t *c, size_t length, uint8_t *t, size_t tLen)
+static void gcmGenerateKeystream(GcmContext *context, uint8_t *j, uint8_t *o,
+   size_t n)
 {
-   size_t k;
-   size_t n;
-   uint8_t b[16];
-   uint8_t j[16];
-   uint8_t s[16];
+   size_t i;
 
-   //Make sure the GCM context is valid
-   if(context == NULL)
-      return ERROR_INVALID_PARAMETER;
+   //Generate the counter blocks
+   for(i = 0; i < n; i++)
+   {
+      //Increment counter
+      gcmIncCounter(j);
+      //Save current counter block
+      memcpy(o + i * 16, j, 16);
+   }
 
-   //The length of the IV shall meet SP 800-38D requirements
-   if(ivLen < 1)
-      return ERROR_INVALID_PARAMETER;
+   //Multi-block encryption routine available?
+   if(context->cipherAlgo->encryptBlocks != NULL)
+   {
+      //Encrypt all the counter blocks at once
+      context->cipherAlgo->encryptBlocks(context->cipherContext, o, o, n);
+   }
+   else
+   {
+      //Encrypt the counter blocks one at a time
+      for(i = 0; i < n; i++)
+      {
+         context->cipherAlgo->encryptBlock(context->cipherContext,
+            o + i * 16, o + i * 16);
+      }
+   }
+}
 
-   //Check the length of the authentication tag
-   if(tLen < 4 || tLen > 16)
-      return ERROR_INVALID_PARAMETER;
+
+/**
+ * @brief Compute the pre-counter block
+ * @param[in] context Pointer to the GCM context
+ * @param[in] iv Initialization vector
+ * @param[in] ivLen Length of the initialization vector
+ * @param[out] j Pre-counter block J(0)
+ **/
+
+static void gcmComputePreCounterBlock(GcmContext *context, const uint8_t *iv,
+   size_t ivLen, uint8_t *j)
+{
+   uint8_t b[16];
 
    //Check whether the length of the IV is 96 bits
    if(ivLen == 12)
@@ -222,23 +816,8 @@ error_t gcmEncrypt(GcmContext *context, const uint8_t *iv, size_t ivLen, const u
       //Initialize GHASH calculation
       memset(j, 0, 16);
 
-      //Length of the IV
-      n = ivLen;
-
       //Process the initialization vector
-      while(n > 0)
-      {
-         //The IV processed in a block-by-block fashion
-         k = MIN(n, 16);
-
-         //Apply GHASH function
-         gcmXorBlock(j, j, iv, k);
-         gcmMul(context, j);
-
-         //Next block
-         iv += k;
-         n -= k;
-      }
+      gcmGhash(context, j, iv, ivLen);
 
       //The string is appended with 64 additional 0 bits, followed by the
       //64-bit representation of the length of the IV
@@ -250,225 +829,1216 @@ error_t gcmEncrypt(GcmContext *context, const uint8_t *iv, size_t ivLen, const u
       gcmXorBlock(j, j, b, 16);
       gcmMul(context, j);
    }
+}
 
-   //Compute MSB(CIPH(J(0)))
-   context->cipherAlgo->encryptBlock(context->cipherContext, j, b);
-   memcpy(t, b, tLen);
-
-   //Initialize GHASH calculation
-   memset(s, 0, 16);
-   //Length of the AAD
-   n = aLen;
 
-   //Process AAD
+/**
+ * @brief Encrypt data and apply GHASH function to the resulting ciphertext
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] j Counter block
+ * @param[in,out] s GHASH accumulator
+ * @param[in] p Plaintext to be encrypted
+ * @param[out] c Ciphertext resulting from the encryption
+ * @param[in] length Total number of data bytes to be encrypted
+ **/
+
+static void gcmEncryptData(GcmContext *context, uint8_t *j, uint8_t *s,
+   const uint8_t *p, uint8_t *c, size_t length)
+{
+   size_t m;
+   size_t n;
+   uint8_t o[CIPHER_PARALLEL_BLOCKS * 16];
+
+   //Length of the plaintext
+   n = length;
+
+#if (AESNI_SUPPORT == ENABLED && PCLMUL_SUPPORT == ENABLED && AES_SUPPORT == ENABLED)
+   //Stitched AES-GCM implementation available?
+   if(gcmAesniAvailable(context))
+   {
+      //Process as many groups of 8 blocks as possible in a single pass
+      m = gcmAesniEncrypt(context, j, s, p, c, n);
+
+      //Advance data pointers
+      p += m;
+      c += m;
+      n -= m;
+   }
+#endif
+
+   //Process plaintext
+   while(n > 0)
+   {
+      //Limit the number of bytes to process at a time
+      m = MIN(n, CIPHER_PARALLEL_BLOCKS * 16);
+
+      //Generate the keystream for the current blocks
+      gcmGenerateKeystream(context, j, o, (m + 15) / 16);
+
+      //Encrypt plaintext
+      gcmXorBlock(c, p, o, m);
+
+      //Apply GHASH function
+      gcmGhash(context, s, c, m);
+
+      //Next blocks
+      p += m;
+      c += m;
+      n -= m;
+   }
+}
+
+
+/**
+ * @brief Apply GHASH function to the ciphertext and decrypt it
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] j Counter block
+ * @param[in,out] s GHASH accumulator
+ * @param[in] c Ciphertext to be decrypted
+ * @param[out] p Plaintext resulting from the decryption
+ * @param[in] length Total number of data bytes to be decrypted
+ **/
+
+static void gcmDecryptData(GcmContext *context, uint8_t *j, uint8_t *s,
+   const uint8_t *c, uint8_t *p, size_t length)
+{
+   size_t m;
+   size_t n;
+   uint8_t o[CIPHER_PARALLEL_BLOCKS * 16];
+
+   //Length of the ciphertext
+   n = length;
+
+#if (AESNI_SUPPORT == ENABLED && PCLMUL_SUPPORT == ENABLED && AES_SUPPORT == ENABLED)
+   //Stitched AES-GCM implementation available?
+   if(gcmAesniAvailable(context))
+   {
+      //Process as many groups of 8 blocks as possible in a single pass
+      m = gcmAesniDecrypt(context, j, s, c, p, n);
+
+      //Advance data pointers
+      c += m;
+      p += m;
+      n -= m;
+   }
+#endif
+
+   //Process ciphertext
    while(n > 0)
    {
-      //Additional data are processed in a block-by-block fashion
-      k = MIN(n, 16);
+      //Limit the number of bytes to process at a time
+      m = MIN(n, CIPHER_PARALLEL_BLOCKS * 16);
+
+      //Apply GHASH function
+      gcmGhash(context, s, c, m);
+
+      //Generate the keystream for the current blocks
+      gcmGenerateKeystream(context, j, o, (m + 15) / 16);
+
+      //Decrypt ciphertext
+      gcmXorBlock(p, c, o, m);
+
+      //Next blocks
+      c += m;
+      p += m;
+      n -= m;
+   }
+}
+
+
+/**
+ * @brief Authenticated encryption using GCM
+ * @param[in] context Pointer to the GCM context
+ * @param[in] iv Initialization vector
+ * @param[in] ivLen Length of the initialization vector
+ * @param[in] a Additional authenticated data
+ * @param[in] aLen Length of the additional data
+ * @param[in] p Plaintext to be encrypted
+ * @param[out] c Ciphertext resulting from the encryption
+ * @param[in] length Total number of data bytes to be encrypted
+ * @param[out] t Authentication tag
+ * @param[in] tLen Length of the authentication tag
+ * @return Error code
+ **/
+
+error_t gcmEncrypt(GcmContext *context, const uint8_t *iv, size_t ivLen, const uint8_t *a,
+   size_t aLen, const uint8_t *p, uint8_t *c, size_t length, uint8_t *t, size_t tLen)
+{
+   uint8_t b[16];
+   uint8_t j[16];
+   uint8_t s[16];
+
+   //Make sure the GCM context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //The length of the IV shall meet SP 800-38D requirements
+   if(ivLen < 1)
+      return ERROR_INVALID_PARAMETER;
+
+   //Check the length of the authentication tag
+   if(tLen < 4 || tLen > 16)
+      return ERROR_INVALID_PARAMETER;
+
+   //Compute the pre-counter block J(0)
+   gcmComputePreCounterBlock(context, iv, ivLen, j);
+
+   //Compute MSB(CIPH(J(0)))
+   context->cipherAlgo->encryptBlock(context->cipherContext, j, b);
+   memcpy(t, b, tLen);
+
+   //Initialize GHASH calculation
+   memset(s, 0, 16);
+
+   //Process AAD
+   gcmGhash(context, s, a, aLen);
+
+   //Encrypt plaintext and apply GHASH function to the ciphertext
+   gcmEncryptData(context, j, s, p, c, length);
+
+   //Append the 64-bit representation of the length of the AAD and the ciphertext
+   memset(b, 0, 16);
+   STORE32BE(aLen * 8, b + 4);
+   STORE32BE(length * 8, b + 12);
+
+   //The GHASH function is applied to the result to produce a single output block S
+   gcmXorBlock(s, s, b, 16);
+   gcmMul(context, s);
+
+   //Let T = MSB(GCTR(J(0), S)
+   gcmXorBlock(t, t, s, tLen);
+
+   //Successful encryption
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Authenticated decryption using GCM
+ * @param[in] context Pointer to the GCM context
+ * @param[in] iv Initialization vector
+ * @param[in] ivLen Length of the initialization vector
+ * @param[in] a Additional authenticated data
+ * @param[in] aLen Length of the additional data
+ * @param[in] c Ciphertext to be decrypted
+ * @param[out] p Plaintext resulting from the decryption
+ * @param[in] length Total number of data bytes to be decrypted
+ * @param[in] t Authentication tag
+ * @param[in] tLen Length of the authentication tag
+ * @return Error code
+ **/
+
+error_t gcmDecrypt(GcmContext *context, const uint8_t *iv, size_t ivLen, const uint8_t *a,
+   size_t aLen, const uint8_t *c, uint8_t *p, size_t length, const uint8_t *t, size_t tLen)
+{
+   uint8_t b[16];
+   uint8_t j[16];
+   uint8_t r[16];
+   uint8_t s[16];
+
+   ///Make sure the GCM context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //The length of the IV shall meet SP 800-38D requirements
+   if(ivLen < 1)
+      return ERROR_INVALID_PARAMETER;
+
+   //Check the length of the authentication tag
+   if(tLen < 4 || tLen > 16)
+      return ERROR_INVALID_PARAMETER;
+
+   //Compute the pre-counter block J(0)
+   gcmComputePreCounterBlock(context, iv, ivLen, j);
+
+   //Compute MSB(CIPH(J(0)))
+   context->cipherAlgo->encryptBlock(context->cipherContext, j, b);
+   memcpy(r, b, tLen);
+
+   //Initialize GHASH calculation
+   memset(s, 0, 16);
+
+   //Process AAD
+   gcmGhash(context, s, a, aLen);
+
+   //Apply GHASH function to the ciphertext and decrypt it
+   gcmDecryptData(context, j, s, c, p, length);
+
+   //Append the 64-bit representation of the length of the AAD and the ciphertext
+   memset(b, 0, 16);
+   STORE32BE(aLen * 8, b + 4);
+   STORE32BE(length * 8, b + 12);
+
+   //The GHASH function is applied to the result to produce a single output block S
+   gcmXorBlock(s, s, b, 16);
+   gcmMul(context, s);
+
+   //Let R = MSB(GCTR(J(0), S)
+   gcmXorBlock(r, r, s, tLen);
+
+   //The calculated tag is bitwise compared to the received tag. The
+   //message is authenticated if and only if the tags match
+   if(memcmp(r, t, tLen))
+      return ERROR_FAILURE;
+
+   //Successful decryption
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Encrypt a set of counter blocks and apply the keystream (batch processing)
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] o Counter blocks
+ * @param[in] slotMessage Message to which each counter block belongs
+ * @param[in] slotOffset Offset of each counter block within its message
+ * @param[in] n Number of counter blocks
+ **/
+
+static void gcmBatchApplyKeystream(GcmContext *context, uint8_t *o,
+   GcmMessage **slotMessage, const size_t *slotOffset, uint_t n)
+{
+   uint_t i;
+   GcmMessage *message;
+
+   //Multi-block encryption routine available?
+   if(context->cipherAlgo->encryptBlocks != NULL)
+   {
+      //Encrypt all the counter blocks at once
+      context->cipherAlgo->encryptBlocks(context->cipherContext, o, o, n);
+   }
+   else
+   {
+      //Encrypt the counter blocks one at a time
+      for(i = 0; i < n; i++)
+      {
+         context->cipherAlgo->encryptBlock(context->cipherContext,
+            o + i * 16, o + i * 16);
+      }
+   }
+
+   //Encrypt or decrypt the corresponding data
+   for(i = 0; i < n; i++)
+   {
+      message = slotMessage[i];
+
+      gcmXorBlock(message->output + slotOffset[i], message->input +
+         slotOffset[i], o + i * 16, MIN(message->length - slotOffset[i], 16));
+   }
+}
+
+
+//Stitched AES-GCM implementation?
+#if (AESNI_SUPPORT == ENABLED && PCLMUL_SUPPORT == ENABLED && AES_SUPPORT == ENABLED)
+
+/**
+ * @brief Compute the authentication tag of a message (batch processing)
+ * @param[in] context Pointer to the GCM context
+ * @param[in] encrypt TRUE for encryption, FALSE for decryption
+ * @param[in,out] message Message descriptor
+ * @param[in] y GHASH accumulator (byte-reversed)
+ * @param[in] e Block CIPH(J(0))
+ **/
+
+CPU_TARGET("aes,pclmul,ssse3") static void gcmAesniFinishMessage(GcmContext *context,
+   bool_t encrypt, GcmMessage *message, __m128i y, const uint8_t *e)
+{
+   uint_t i;
+   uint8_t mask;
+   uint8_t b[16];
+
+   //Append the 64-bit representation of the length of the AAD and the
+   //ciphertext (the accumulator is byte-reversed)
+   y = _mm_xor_si128(y, _mm_set_epi64x((uint64_t) message->aLen * 8,
+      (uint64_t) message->length * 8));
+
+   //The GHASH function is applied to the result to produce a single output
+   //block S
+   y = gcmClmulMul(y, _mm_loadu_si128((const __m128i *) context->hp[0]));
+
+   //Let T = MSB(GCTR(J(0), S)
+   y = _mm_xor_si128(gcmClmulSwap(y), _mm_loadu_si128((const __m128i *) e));
+   _mm_storeu_si128((__m128i *) b, y);
+
+   //Encryption or decryption?
+   if(encrypt)
+   {
+      //Return the authentication tag
+      memcpy(message->t, b, message->tLen);
+      message->error = NO_ERROR;
+   }
+   else
+   {
+      //The calculated tag is bitwise compared to the received tag
+      for(mask = 0, i = 0; i < message->tLen; i++)
+         mask |= b[i] ^ message->t[i];
+
+      //The message is authenticated if and only if the tags match
+      message->error = (mask != 0) ? ERROR_FAILURE : NO_ERROR;
+   }
+}
+
+
+/**
+ * @brief Stitched AES-GCM batch processing
+ *
+ * The messages are handled in groups of up to 8, one message per lane. The
+ * groups of 8 blocks of each message are first processed by the stitched
+ * single-message implementation. The remaining blocks of all the lanes are
+ * then processed side by side: every step encrypts one counter block per
+ * lane, while the GHASH blocks of the lanes are multiplied by the relevant
+ * powers of H during the AES rounds, so that a single reduction per lane is
+ * needed
+ *
+ * @param[in] context Pointer to the GCM context
+ * @param[in] encrypt TRUE for encryption, FALSE for decryption
+ * @param[in,out] messages Array of message descriptors
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
+
+CPU_TARGET("aes,pclmul,ssse3") static error_t gcmAesniProcessBatch(GcmContext *context,
+   bool_t encrypt, GcmMessage *messages, uint_t count)
+{
+   error_t error;
+   uint_t i;
+   uint_t n;
+   uint_t r;
+   uint_t s;
+   uint_t steps;
+   size_t m;
+   GcmMessage *message;
+   AesContext *aesContext;
+   const __m128i *rk;
+   __m128i k;
+   __m128i c;
+   __m128i one;
+   __m128i t[GCM_CLMUL_BLOCKS];
+   __m128i x[GCM_CLMUL_BLOCKS];
+   __m128i ctr[GCM_CLMUL_BLOCKS];
+   __m128i y[GCM_CLMUL_BLOCKS];
+   __m128i lo[GCM_CLMUL_BLOCKS];
+   __m128i hi[GCM_CLMUL_BLOCKS];
+   size_t offset[GCM_CLMUL_BLOCKS];
+   size_t length[GCM_CLMUL_BLOCKS];
+   uint_t laneBlocks[GCM_CLMUL_BLOCKS];
+   uint8_t e[GCM_CLMUL_BLOCKS][16];
+   uint8_t buffer[GCM_CLMUL_BLOCKS][GCM_CLMUL_BLOCKS * 16];
+   uint8_t j[16];
+   uint8_t b[16];
+
+   //Masks used to pad the last block of each lane with zeros
+   static const uint8_t mask[32] =
+   {
+      0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+      0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+   };
+
+   //Point to the AES round keys
+   aesContext = (AesContext *) context->cipherContext;
+   rk = (const __m128i *) aesContext->ek;
+   one = _mm_set_epi32(0, 0, 0, 1);
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Process the messages in groups
+   while(count > 0)
+   {
+      //Number of messages in the current group
+      n = MIN(count, GCM_CLMUL_BLOCKS);
+      //Number of steps needed to process the remaining blocks
+      steps = 0;
+
+      for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+      {
+         //Idle lanes run on dummy data
+         t[i] = _mm_setzero_si128();
+         lo[i] = _mm_setzero_si128();
+         hi[i] = _mm_setzero_si128();
+         laneBlocks[i] = 0;
+
+         //Skip idle lanes
+         if(i >= n)
+            continue;
+
+         //Point to the current message
+         message = &messages[i];
+
+         //Compute the pre-counter block J(0)
+         gcmComputePreCounterBlock(context, message->iv, message->ivLen, e[i]);
+         memcpy(j, e[i], 16);
+
+         //CIPH(J(0)) is computed below, together with the other lanes
+         t[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i *) e[i]),
+            _mm_loadu_si128(rk));
+
+         //Process AAD
+         memset(b, 0, 16);
+         gcmClmulGhash(context, b, message->a, message->aLen);
+
+         //Groups of 8 blocks are handled by the stitched single-message
+         //implementation, which has the lowest cost per block
+         if(encrypt)
+         {
+            m = gcmAesniEncrypt(context, j, b, message->input,
+               message->output, message->length);
+         }
+         else
+         {
+            m = gcmAesniDecrypt(context, j, b, message->input,
+               message->output, message->length);
+         }
+
+         //The 32-bit counter lies in the lowest word of the byte-reversed
+         //block
+         ctr[i] = gcmClmulSwap(_mm_loadu_si128((const __m128i *) j));
+         y[i] = gcmClmulSwap(_mm_loadu_si128((const __m128i *) b));
+
+         //Copy the remaining data (less than 8 blocks), padded with zeros
+         offset[i] = m;
+         length[i] = message->length - m;
+         laneBlocks[i] = (uint_t) ((length[i] + 15) / 16);
+
+         memcpy(buffer[i], message->input + m, length[i]);
+         memset(buffer[i] + length[i], 0, laneBlocks[i] * 16 - length[i]);
+
+         steps = MAX(steps, laneBlocks[i]);
+      }
+
+      //Compute CIPH(J(0)) for all the messages at once
+      for(r = 1; r < aesContext->nr; r++)
+      {
+         k = _mm_loadu_si128(rk + r);
+
+         for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+         {
+            t[i] = _mm_aesenc_si128(t[i], k);
+         }
+      }
+
+      k = _mm_loadu_si128(rk + aesContext->nr);
+
+      for(i = 0; i < n; i++)
+      {
+         _mm_storeu_si128((__m128i *) e[i], _mm_aesenclast_si128(t[i], k));
+      }
+
+      //Each step processes one block per lane
+      for(s = 0; s < steps; s++)
+      {
+         for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+         {
+            //Generate the counter block (initial round)
+            ctr[i] = _mm_add_epi32(ctr[i], one);
+            t[i] = _mm_xor_si128(gcmClmulSwap(ctr[i]), _mm_loadu_si128(rk));
+
+            //When decrypting, the ciphertext block is authenticated during
+            //the current step
+            if(!encrypt && s < laneBlocks[i])
+            {
+               x[i] = gcmClmulSwap(_mm_loadu_si128((const __m128i *)
+                  buffer[i] + s));
+
+               //The first block is combined with the accumulator
+               if(s == 0)
+                  x[i] = _mm_xor_si128(x[i], y[i]);
+            }
+         }
+
+         //Apply the AES rounds, interleaved with the GHASH multiplications
+         for(r = 1; r < aesContext->nr; r++)
+         {
+            k = _mm_loadu_si128(rk + r);
+
+            for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+            {
+               t[i] = _mm_aesenc_si128(t[i], k);
+            }
+
+            //AES performs at least 9 full rounds, so there is room for one
+            //multiplication per lane. When encrypting, the ciphertext block
+            //produced by the previous step is authenticated
+            if(r <= GCM_CLMUL_BLOCKS)
+            {
+               i = r - 1;
+
+               if(encrypt && s > 0 && s <= laneBlocks[i])
+               {
+                  gcmClmulMulAcc(x[i], _mm_loadu_si128((const __m128i *)
+                     context->hp[laneBlocks[i] - s]), &lo[i], &hi[i]);
+               }
+               else if(!encrypt && s < laneBlocks[i])
+               {
+                  gcmClmulMulAcc(x[i], _mm_loadu_si128((const __m128i *)
+                     context->hp[laneBlocks[i] - s - 1]), &lo[i], &hi[i]);
+               }
+            }
+         }
+
+         //Final round
+         k = _mm_loadu_si128(rk + aesContext->nr);
+
+         for(i = 0; i < GCM_CLMUL_BLOCKS; i++)
+         {
+            //Skip idle lanes
+            if(s >= laneBlocks[i])
+               continue;
+
+            //Encrypt or decrypt the current block
+            c = _mm_xor_si128(_mm_aesenclast_si128(t[i], k),
+               _mm_loadu_si128((const __m128i *) buffer[i] + s));
+
+            //The last block is padded with zeros
+            m = MIN(length[i] - s * 16, 16);
+            c = _mm_and_si128(c, _mm_loadu_si128((const __m128i *)
+               (mask + 16 - m)));
+
+            //Save the resulting block
+            _mm_storeu_si128((__m128i *) buffer[i] + s, c);
+
+            //When encrypting, the ciphertext block is authenticated during
+            //the next step
+            if(encrypt)
+            {
+               x[i] = gcmClmulSwap(c);
+
+               //The first block is combined with the accumulator
+               if(s == 0)
+                  x[i] = _mm_xor_si128(x[i], y[i]);
+            }
+         }
+      }
+
+      //Authenticate the ciphertext blocks produced by the last step
+      for(i = 0; i < n; i++)
+      {
+         if(encrypt && steps > 0 && steps == laneBlocks[i])
+         {
+            gcmClmulMulAcc(x[i], _mm_loadu_si128((const __m128i *)
+               context->hp[0]), &lo[i], &hi[i]);
+         }
+      }
+
+      //Complete the processing of each message
+      for(i = 0; i < n; i++)
+      {
+         message = &messages[i];
+
+         //Perform reduction
+         if(laneBlocks[i] > 0)
+         {
+            y[i] = gcmClmulReduce(lo[i], hi[i]);
+            memcpy(message->output + offset[i], buffer[i], length[i]);
+         }
+
+         //Compute the authentication tag
+         gcmAesniFinishMessage(context, encrypt, message, y[i], e[i]);
+
+         //Save the status of the message
+         if(message->error)
+            error = ERROR_FAILURE;
+      }
+
+      //Next group
+      messages += n;
+      count -= n;
+   }
+
+   //Clear the keystream and the data of the lanes
+   memset(e, 0, sizeof(e));
+   memset(buffer, 0, sizeof(buffer));
+
+   //Return status code
+   return error;
+}
+
+#endif
+
+
+/**
+ * @brief Batch processing of GCM messages sharing the same key
+ *
+ * The messages are handled in groups. The pre-counter blocks of a group are
+ * encrypted together, and the counter blocks of consecutive messages are
+ * packed into the same multi-block cipher calls, so that small messages
+ * still keep the cipher pipeline busy. AES messages are handed to the
+ * stitched implementation when the CPU supports AES-NI and PCLMULQDQ
+ *
+ * @param[in] context Pointer to the GCM context
+ * @param[in] encrypt TRUE for encryption, FALSE for decryption
+ * @param[in,out] messages Array of message descriptors
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
+
+static error_t gcmProcessBatch(GcmContext *context, bool_t encrypt,
+   GcmMessage *messages, uint_t count)
+{
+   error_t error;
+   uint_t i;
+   uint_t k;
+   uint_t n;
+   size_t offset;
+   uint8_t mask;
+   GcmMessage *message;
+   uint8_t b[16];
+   uint8_t j[CIPHER_PARALLEL_BLOCKS][16];
+   uint8_t s[CIPHER_PARALLEL_BLOCKS][16];
+   uint8_t e[CIPHER_PARALLEL_BLOCKS][16];
+   uint8_t o[CIPHER_PARALLEL_BLOCKS * 16];
+   GcmMessage *slotMessage[CIPHER_PARALLEL_BLOCKS];
+   size_t slotOffset[CIPHER_PARALLEL_BLOCKS];
+
+   //Make sure the GCM context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Check parameters
+   if(messages == NULL && count != 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //Check the message descriptors
+   for(i = 0; i < count; i++)
+   {
+      //The length of the IV shall meet SP 800-38D requirements
+      if(messages[i].ivLen < 1)
+         return ERROR_INVALID_PARAMETER;
+
+      //Check the length of the authentication tag
+      if(messages[i].tLen < 4 || messages[i].tLen > 16)
+         return ERROR_INVALID_PARAMETER;
+   }
+
+#if (AESNI_SUPPORT == ENABLED && PCLMUL_SUPPORT == ENABLED && AES_SUPPORT == ENABLED)
+   //Stitched AES-GCM implementation available?
+   if(gcmAesniAvailable(context))
+   {
+      //Process up to 8 messages side by side
+      return gcmAesniProcessBatch(context, encrypt, messages, count);
+   }
+#endif
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Process the messages in groups
+   while(count > 0)
+   {
+      //Number of messages in the current group
+      n = MIN(count, CIPHER_PARALLEL_BLOCKS);
+
+      //Compute the pre-counter blocks and process AAD
+      for(i = 0; i < n; i++)
+      {
+         message = &messages[i];
+
+         //Compute the pre-counter block J(0)
+         gcmComputePreCounterBlock(context, message->iv, message->ivLen, j[i]);
+         memcpy(e[i], j[i], 16);
+
+         //Initialize GHASH calculation
+         memset(s[i], 0, 16);
+
+         //Process AAD
+         gcmGhash(context, s[i], message->a, message->aLen);
+
+         //When decrypting, the ciphertext is authenticated before it may be
+         //overwritten by the plaintext
+         if(!encrypt)
+            gcmGhash(context, s[i], message->input, message->length);
+      }
+
+      //Compute CIPH(J(0)) for all the messages at once
+      if(context->cipherAlgo->encryptBlocks != NULL)
+      {
+         context->cipherAlgo->encryptBlocks(context->cipherContext,
+            (uint8_t *) e, (uint8_t *) e, n);
+      }
+      else
+      {
+         for(i = 0; i < n; i++)
+         {
+            context->cipherAlgo->encryptBlock(context->cipherContext,
+               e[i], e[i]);
+         }
+      }
+
+      //Counter blocks of consecutive messages are packed together
+      k = 0;
+
+      //Generate the keystream for the whole group
+      for(i = 0; i < n; i++)
+      {
+         message = &messages[i];
+
+         for(offset = 0; offset < message->length; offset += 16)
+         {
+            //Increment counter
+            gcmIncCounter(j[i]);
+
+            //Save current counter block
+            memcpy(o + k * 16, j[i], 16);
+            slotMessage[k] = message;
+            slotOffset[k] = offset;
+            k++;
+
+            //Flush the buffer when it is full
+            if(k == CIPHER_PARALLEL_BLOCKS)
+            {
+               gcmBatchApplyKeystream(context, o, slotMessage, slotOffset, k);
+               k = 0;
+            }
+         }
+      }
+
+      //Flush the remaining counter blocks, if any
+      if(k > 0)
+      {
+         gcmBatchApplyKeystream(context, o, slotMessage, slotOffset, k);
+      }
+
+      //Compute the authentication tags
+      for(i = 0; i < n; i++)
+      {
+         message = &messages[i];
+
+         //When encrypting, the GHASH function is applied to the ciphertext
+         if(encrypt)
+            gcmGhash(context, s[i], message->output, message->length);
+
+         //Append the 64-bit representation of the length of the AAD and
+         //the ciphertext
+         STORE64BE((uint64_t) message->aLen * 8, b);
+         STORE64BE((uint64_t) message->length * 8, b + 8);
+
+         //The GHASH function is applied to the result to produce a single
+         //output block S
+         gcmXorBlock(s[i], s[i], b, 16);
+         gcmMul(context, s[i]);
+
+         //Let T = MSB(GCTR(J(0), S)
+         gcmXorBlock(b, e[i], s[i], message->tLen);
+
+         //Encryption or decryption?
+         if(encrypt)
+         {
+            //Return the authentication tag
+            memcpy(message->t, b, message->tLen);
+            message->error = NO_ERROR;
+         }
+         else
+         {
+            //The calculated tag is bitwise compared to the received tag
+            for(mask = 0, k = 0; k < message->tLen; k++)
+               mask |= b[k] ^ message->t[k];
+
+            //The message is authenticated if and only if the tags match
+            if(mask != 0)
+            {
+               message->error = ERROR_FAILURE;
+               error = ERROR_FAILURE;
+            }
+            else
+            {
+               message->error = NO_ERROR;
+            }
+         }
+      }
+
+      //Next group
+      messages += n;
+      count -= n;
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Authenticated encryption of a batch of messages using GCM
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] messages Array of message descriptors
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
 
-      //Apply GHASH function
-      gcmXorBlock(s, s, a, k);
-      gcmMul(context, s);
+error_t gcmEncryptBatch(GcmContext *context, GcmMessage *messages, uint_t count)
+{
+   //Encrypt the messages
+   return gcmProcessBatch(context, TRUE, messages, count);
+}
 
-      //Next block
-      a += k;
-      n -= k;
-   }
 
-   //Length of the plaintext
-   n = length;
+/**
+ * @brief Authenticated decryption of a batch of messages using GCM
+ *
+ * The status of each message is reported in its descriptor. The function
+ * returns ERROR_FAILURE if at least one message fails authentication
+ *
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] messages Array of message descriptors
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
 
-   //Process plaintext
-   while(n > 0)
-   {
-      //The encryption operates in a block-by-block fashion
-      k = MIN(n, 16);
+error_t gcmDecryptBatch(GcmContext *context, GcmMessage *messages, uint_t count)
+{
+   //Decrypt the messages
+   return gcmProcessBatch(context, FALSE, messages, count);
+}
 
-      //Increment counter
-      gcmIncCounter(j);
 
-      //Encrypt plaintext
-      context->cipherAlgo->encryptBlock(context->cipherContext, j, b);
-      gcmXorBlock(c, p, b, k);
+/**
+ * @brief Start an incremental GCM operation
+ * @param[in] context Pointer to the GCM context
+ * @param[in] encrypt TRUE for encryption, FALSE for decryption
+ * @param[in] iv Initialization vector
+ * @param[in] ivLen Length of the initialization vector
+ * @return Error code
+ **/
 
-      //Apply GHASH function
-      gcmXorBlock(s, s, c, k);
-      gcmMul(context, s);
+error_t gcmStart(GcmContext *context, bool_t encrypt, const uint8_t *iv, size_t ivLen)
+{
+   //Make sure the GCM context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
 
-      //Next block
-      p += k;
-      c += k;
-      n -= k;
-   }
+   //The length of the IV shall meet SP 800-38D requirements
+   if(ivLen < 1)
+      return ERROR_INVALID_PARAMETER;
 
-   //Append the 64-bit representation of the length of the AAD and the ciphertext
-   memset(b, 0, 16);
-   STORE32BE(aLen * 8, b + 4);
-   STORE32BE(length * 8, b + 12);
+   //Save the direction of the operation
+   context->encrypt = encrypt;
 
-   //The GHASH function is applied to the result to produce a single output block S
-   gcmXorBlock(s, s, b, 16);
-   gcmMul(context, s);
+   //Compute the pre-counter block J(0)
+   gcmComputePreCounterBlock(context, iv, ivLen, context->j);
 
-   //Let T = MSB(GCTR(J(0), S)
-   gcmXorBlock(t, t, s, tLen);
+   //Compute CIPH(J(0))
+   context->cipherAlgo->encryptBlock(context->cipherContext,
+      context->j, context->t);
 
-   //Successful encryption
+   //Initialize GHASH calculation
+   memset(context->s, 0, 16);
+
+   //No data has been processed yet
+   context->aLen = 0;
+   context->length = 0;
+
+   //Successful initialization
    return NO_ERROR;
 }
 
 
 /**
- * @brief Authenticated decryption using GCM
+ * @brief Feed additional authenticated data to an incremental GCM operation
+ *
+ * This function can be called several times, but all the AAD must be
+ * supplied before any plaintext or ciphertext
+ *
  * @param[in] context Pointer to the GCM context
- * @param[in] iv Initialization vector
- * @param[in] ivLen Length of the initialization vector
  * @param[in] a Additional authenticated data
  * @param[in] aLen Length of the additional data
- * @param[in] c Ciphertext to be decrypted
- * @param[out] p Plaintext resulting from the decryption
- * @param[in] length Total number of data bytes to be decrypted
- * @param[in] t Authentication tag
- * @param[in] tLen Length of the authentication tag
  * @return Error code
  **/
 
-error_t gcmDecrypt(GcmContext *context, const uint8_t *iv, size_t ivLen, const uint8_t *a,
-   size_t aLen, const uint8_t *c, uint8_t *p, size_t length, const uint8_t *t, size_t tLen)
+error_t gcmUpdateAad(GcmContext *context, const uint8_t *a, size_t aLen)
 {
    size_t k;
    size_t n;
-   uint8_t b[16];
-   uint8_t j[16];
-   uint8_t r[16];
-   uint8_t s[16];
 
-   ///Make sure the GCM context is valid
+   //Make sure the GCM context is valid
    if(context == NULL)
       return ERROR_INVALID_PARAMETER;
 
-   //The length of the IV shall meet SP 800-38D requirements
-   if(ivLen < 1)
-      return ERROR_INVALID_PARAMETER;
+   //The AAD must precede the data
+   if(context->length != 0)
+      return ERROR_WRONG_STATE;
 
-   //Check the length of the authentication tag
-   if(tLen < 4 || tLen > 16)
+   //Process AAD
+   while(aLen > 0)
+   {
+      //Number of bytes already in the partial block
+      n = context->aLen % 16;
+
+      //Complete blocks can be processed directly from the input
+      if(n == 0 && aLen >= 16)
+      {
+         k = aLen - (aLen % 16);
+         gcmGhash(context, context->s, a, k);
+      }
+      else
+      {
+         //Buffer the partial block
+         k = MIN(aLen, 16 - n);
+         memcpy(context->buffer + n, a, k);
+
+         //Once the block is complete, apply GHASH function
+         if((n + k) == 16)
+            gcmGhash(context, context->s, context->buffer, 16);
+      }
+
+      //Next bytes
+      context->aLen += k;
+      a += k;
+      aLen -= k;
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Encrypt or decrypt data as part of an incremental GCM operation
+ *
+ * The data can be supplied in chunks of any size. No buffering is
+ * required since the output is produced as soon as the input is available
+ *
+ * @param[in] context Pointer to the GCM context
+ * @param[in] input Data to be encrypted or decrypted
+ * @param[out] output Resulting data
+ * @param[in] length Number of data bytes to process
+ * @return Error code
+ **/
+
+error_t gcmUpdate(GcmContext *context, const uint8_t *input, uint8_t *output, size_t length)
+{
+   size_t i;
+   size_t k;
+   size_t n;
+
+   //Make sure the GCM context is valid
+   if(context == NULL)
       return ERROR_INVALID_PARAMETER;
 
-   //Check whether the length of the IV is 96 bits
-   if(ivLen == 12)
+   //Nothing to do?
+   if(length == 0)
+      return NO_ERROR;
+
+   //The last partial block of AAD is padded with zeros
+   if(context->length == 0 && (context->aLen % 16) != 0)
    {
-      //When the length of the IV is 96 bits, the padding string is
-      //appended to the IV to form the pre-counter block
-      memcpy(j, iv, 12);
-      STORE32BE(1, j + 12);
+      gcmGhash(context, context->s, context->buffer, context->aLen % 16);
    }
-   else
+
+   //Process data
+   while(length > 0)
    {
-      //Initialize GHASH calculation
-      memset(j, 0, 16);
+      //Number of bytes already in the partial block
+      n = context->length % 16;
 
-      //Length of the IV
-      n = ivLen;
+      //Complete blocks can be processed directly from the input
+      if(n == 0 && length >= 16)
+      {
+         k = length - (length % 16);
 
-      //Process the initialization vector
-      while(n > 0)
+         //Encryption or decryption?
+         if(context->encrypt)
+            gcmEncryptData(context, context->j, context->s, input, output, k);
+         else
+            gcmDecryptData(context, context->j, context->s, input, output, k);
+      }
+      else
       {
-         //The IV processed in a block-by-block fashion
-         k = MIN(n, 16);
+         //Start of a new block?
+         if(n == 0)
+         {
+            //Generate the keystream for the current block
+            gcmIncCounter(context->j);
+            context->cipherAlgo->encryptBlock(context->cipherContext,
+               context->j, context->k);
+         }
 
-         //Apply GHASH function
-         gcmXorBlock(j, j, iv, k);
-         gcmMul(context, j);
+         //Number of bytes to process
+         k = MIN(length, 16 - n);
 
-         //Next block
-         iv += k;
-         n -= k;
-      }
+         //The ciphertext is saved for the GHASH computation. The input
+         //is read before the output is written, so the operation can be
+         //done in place
+         for(i = 0; i < k; i++)
+         {
+            if(context->encrypt)
+            {
+               output[i] = input[i] ^ context->k[n + i];
+               context->buffer[n + i] = output[i];
+            }
+            else
+            {
+               context->buffer[n + i] = input[i];
+               output[i] = input[i] ^ context->k[n + i];
+            }
+         }
 
-      //The string is appended with 64 additional 0 bits, followed by the
-      //64-bit representation of the length of the IV
-      memset(b, 0, 16);
-      STORE32BE(ivLen * 8, b + 12);
+         //Once the block is complete, apply GHASH function
+         if((n + k) == 16)
+            gcmGhash(context, context->s, context->buffer, 16);
+      }
 
-      //The GHASH function is applied to the resulting string to form the
-      //pre-counter block
-      gcmXorBlock(j, j, b, 16);
-      gcmMul(context, j);
+      //Next bytes
+      context->length += k;
+      input += k;
+      output += k;
+      length -= k;
    }
 
-   //Compute MSB(CIPH(J(0)))
-   context->cipherAlgo->encryptBlock(context->cipherContext, j, b);
-   memcpy(r, b, tLen);
-
-   //Initialize GHASH calculation
-   memset(s, 0, 16);
-   //Length of the AAD
-   n = aLen;
+   //Successful processing
+   return NO_ERROR;
+}
 
-   //Process AAD
-   while(n > 0)
-   {
-      //Additional data are processed in a block-by-block fashion
-      k = MIN(n, 16);
 
-      //Apply GHASH function
-      gcmXorBlock(s, s, a, k);
-      gcmMul(context, s);
+/**
+ * @brief Clear the per-message state of a GCM context
+ * @param[in] context Pointer to the GCM context
+ **/
 
-      //Next block
-      a += k;
-      n -= k;
-   }
+static void gcmClearState(GcmContext *context)
+{
+   //Clear the encrypted pre-counter block, the counter block, the GHASH
+   //accumulator and the pending partial block
+   memset(context->t, 0, sizeof(context->t));
+   memset(context->j, 0, sizeof(context->j));
+   memset(context->s, 0, sizeof(context->s));
+   memset(context->buffer, 0, sizeof(context->buffer));
+   memset(context->k, 0, sizeof(context->k));
+
+   //Reset the byte counters
+   context->aLen = 0;
+   context->length = 0;
+}
 
-   //Length of the ciphertext
-   n = length;
 
-   //Process ciphertext
-   while(n > 0)
-   {
-      //The decryption operates in a block-by-block fashion
-      k = MIN(n, 16);
+/**
+ * @brief Finish an incremental GCM operation
+ *
+ * For encryption, the authentication tag is computed and copied to the
+ * output buffer. For decryption, the calculated tag is compared with the
+ * received one
+ *
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] t Authentication tag
+ * @param[in] tLen Length of the authentication tag
+ * @return Error code
+ **/
 
-      //Apply GHASH function
-      gcmXorBlock(s, s, c, k);
-      gcmMul(context, s);
+error_t gcmFinish(GcmContext *context, uint8_t *t, size_t tLen)
+{
+   size_t i;
+   uint8_t mask;
+   uint8_t b[16];
 
-      //Increment counter
-      gcmIncCounter(j);
+   //Make sure the GCM context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
 
-      //Decrypt ciphertext
-      context->cipherAlgo->encryptBlock(context->cipherContext, j, b);
-      gcmXorBlock(p, c, b, k);
+   //Check the length of the authentication tag
+   if(tLen < 4 || tLen > 16)
+   {
+      //Clear the state of the message
+      gcmClearState(context);
+      //Report an error
+      return ERROR_INVALID_PARAMETER;
+   }
 
-      //Next block
-      c += k;
-      p += k;
-      n -= k;
+   //Process the last partial block, if any
+   if(context->length == 0 && (context->aLen % 16) != 0)
+   {
+      //The last partial block of AAD is padded with zeros
+      gcmGhash(context, context->s, context->buffer, context->aLen % 16);
+   }
+   else if((context->length % 16) != 0)
+   {
+      //The last partial block of ciphertext is padded with zeros
+      gcmGhash(context, context->s, context->buffer, context->length % 16);
    }
 
    //Append the 64-bit representation of the length of the AAD and the ciphertext
-   memset(b, 0, 16);
-   STORE32BE(aLen * 8, b + 4);
-   STORE32BE(length * 8, b + 12);
+   STORE64BE((uint64_t) context->aLen * 8, b);
+   STORE64BE((uint64_t) context->length * 8, b + 8);
 
    //The GHASH function is applied to the result to produce a single output block S
-   gcmXorBlock(s, s, b, 16);
-   gcmMul(context, s);
+   gcmXorBlock(context->s, context->s, b, 16);
+   gcmMul(context, context->s);
 
-   //Let R = MSB(GCTR(J(0), S)
-   gcmXorBlock(r, r, s, tLen);
+   //Let T = MSB(GCTR(J(0), S)
+   gcmXorBlock(b, context->t, context->s, tLen);
 
-   //The calculated tag is bitwise compared to the received tag. The
-   //message is authenticated if and only if the tags match
-   if(memcmp(r, t, tLen))
-      return ERROR_FAILURE;
+   //The encrypted pre-counter block and the GHASH output must not outlive
+   //the message, since they would reveal the hash subkey along with the tag
+   gcmClearState(context);
 
-   //Successful decryption
+   //Encryption or decryption?
+   if(context->encrypt)
+   {
+      //Return the authentication tag
+      memcpy(t, b, tLen);
+   }
+   else
+   {
+      //The calculated tag is bitwise compared to the received tag
+      for(mask = 0, i = 0; i < tLen; i++)
+         mask |= b[i] ^ t[i];
+
+      //The message is authenticated if and only if the tags match
+      if(mask != 0)
+      {
+         //Clear the calculated tag
+         memset(b, 0, sizeof(b));
+         //Report an error
+         return ERROR_FAILURE;
+      }
+   }
+
+   //Clear the calculated tag
+   memset(b, 0, sizeof(b));
+
+   //Successful processing
    return NO_ERROR;
 }
 
 
+/**
+ * @brief GHASH function
+ * @param[in] context Pointer to the GCM context
+ * @param[in,out] s GHASH accumulator
+ * @param[in] data Pointer to the data to be processed
+ * @param[in] length Length of the data (the last block is padded with zeros)
+ **/
+
+void gcmGhash(GcmContext *context, uint8_t *s, const uint8_t *data, size_t length)
+{
+   size_t k;
+
+#if (PCLMUL_SUPPORT == ENABLED)
+   //Check whether the CPU supports carry-less multiplication
+   if((cpuGetFeatures() & GCM_CLMUL_FEATURES) == GCM_CLMUL_FEATURES)
+   {
+      //Process 8 blocks per reduction
+      gcmClmulGhash(context, s, data, length);
+      return;
+   }
+#endif
+
+   //Process the data
+   while(length > 0)
+   {
+      //The data are processed in a block-by-block fashion
+      k = MIN(length, 16);
+
+      //Apply GHASH function
+      gcmXorBlock(s, s, data, k);
+      gcmMul(context, s);
+
+      //Next block
+      data += k;
+      length -= k;
+   }
+}
+
+
 /**
  * @brief Multiplication operation
  * @param[in] context Pointer to the GCM context
@@ -482,12 +2052,49 @@ void gcmMul(GcmContext *context, uint8_t *x)
    uint8_t c;
    uint32_t z[4];
 
+#if (PCLMUL_SUPPORT == ENABLED)
+   __m128i y;
+
+   //Check whether the CPU supports carry-less multiplication
+   if((cpuGetFeatures() & GCM_CLMUL_FEATURES) == GCM_CLMUL_FEATURES)
+   {
+      //Compute X * H
+      y = gcmClmulSwap(_mm_loadu_si128((const __m128i *) x));
+      y = gcmClmulMul(y, _mm_loadu_si128((const __m128i *) context->hp[0]));
+      _mm_storeu_si128((__m128i *) x, gcmClmulSwap(y));
+      return;
+   }
+#endif
+
    //Let Z = 0
    z[0] = 0;
    z[1] = 0;
    z[2] = 0;
    z[3] = 0;
 
+#if (GCM_TABLE_W == 8)
+   //Fast table-driven implementation (Shoup's method with 8-bit tables)
+   for(i = 15; i >= 0; i--)
+   {
+      //Get the current byte
+      b = x[i];
+
+      //Multiply 8 bits at a time
+      c = z[0] & 0xFF;
+      z[0] = (z[0] >> 8) | (z[1] << 24);
+      z[1] = (z[1] >> 8) | (z[2] << 24);
+      z[2] = (z[2] >> 8) | (z[3] << 24);
+      z[3] >>= 8;
+
+      z[0] ^= context->m[b][0];
+      z[1] ^= context->m[b][1];
+      z[2] ^= context->m[b][2];
+      z[3] ^= context->m[b][3];
+
+      //Perform reduction
+      z[3] ^= r[c];
+   }
+#else
    //Fast table-driven implementation
    for(i = 15; i >= 0; i--)
    {
@@ -527,6 +2134,7 @@ void gcmMul(GcmContext *context, uint8_t *x)
       //Perform reduction
       z[3] ^= r[c];
    }
+#endif
 
    //Save the result
    STORE32BE(z[3], x);
@@ -32,6 +32,16 @@
 //Dependencies
 #include "crypto.h"
 
+//Width of the precalculated table, in bits (4 or 8)
+#ifndef GCM_TABLE_W
+   #define GCM_TABLE_W 4
+#elif (GCM_TABLE_W != 4 && GCM_TABLE_W != 8)
+   #error GCM_TABLE_W parameter is not valid
+#endif
+
+//Number of blocks processed per reduction by the carry-less multiplication path
+#define GCM_CLMUL_BLOCKS 8
+
 //C++ guard
 #ifdef __cplusplus
    extern "C" {
@@ -46,10 +56,40 @@ typedef struct
 {
    const CipherAlgo *cipherAlgo; ///<Cipher algorithm
    void *cipherContext;          ///<Cipher algorithm context
-   uint32_t m[16][4];            ///<Precalculated table
+   uint32_t m[1 << GCM_TABLE_W][4]; ///<Precalculated table
+#if (PCLMUL_SUPPORT == ENABLED)
+   uint8_t hp[GCM_CLMUL_BLOCKS][16]; ///<Powers of the hash subkey (H, H^2, ..., H^8)
+#endif
+   bool_t encrypt;               ///<Encryption or decryption (incremental API)
+   uint8_t t[16];                ///<Encrypted pre-counter block
+   uint8_t j[16];                ///<Counter block
+   uint8_t s[16];                ///<GHASH accumulator
+   uint8_t buffer[16];           ///<Partial block (AAD or ciphertext)
+   uint8_t k[16];                ///<Keystream of the current partial block
+   size_t aLen;                  ///<Number of AAD bytes processed so far
+   size_t length;                ///<Number of data bytes processed so far
 } GcmContext;
 
 
+/**
+ * @brief Message descriptor (batch processing)
+ **/
+
+typedef struct
+{
+   const uint8_t *iv;    ///<Initialization vector
+   size_t ivLen;         ///<Length of the initialization vector
+   const uint8_t *a;     ///<Additional authenticated data
+   size_t aLen;          ///<Length of the additional data
+   const uint8_t *input; ///<Plaintext (encryption) or ciphertext (decryption)
+   uint8_t *output;      ///<Ciphertext (encryption) or plaintext (decryption)
+   size_t length;        ///<Length of the data
+   uint8_t *t;           ///<Authentication tag
+   size_t tLen;          ///<Length of the authentication tag
+   error_t error;        ///<Status of the operation
+} GcmMessage;
+
+
 //GCM related functions
 error_t gcmInit(GcmContext *context, const CipherAlgo *cipherAlgo, void *cipherContext);
 
@@ -59,6 +99,15 @@ error_t gcmEncrypt(GcmContext *context, const uint8_t *iv, size_t ivLen, const u
 error_t gcmDecrypt(GcmContext *context, const uint8_t *iv, size_t ivLen, const uint8_t *a,
    size_t aLen, const uint8_t *c, uint8_t *p, size_t length, const uint8_t *t, size_t tLen);
 
+error_t gcmEncryptBatch(GcmContext *context, GcmMessage *messages, uint_t count);
+error_t gcmDecryptBatch(GcmContext *context, GcmMessage *messages, uint_t count);
+
+error_t gcmStart(GcmContext *context, bool_t encrypt, const uint8_t *iv, size_t ivLen);
+error_t gcmUpdateAad(GcmContext *context, const uint8_t *a, size_t aLen);
+error_t gcmUpdate(GcmContext *context, const uint8_t *input, uint8_t *output, size_t length);
+error_t gcmFinish(GcmContext *context, uint8_t *t, size_t tLen);
+
+void gcmGhash(GcmContext *context, uint8_t *s, const uint8_t *data, size_t length);
 void gcmMul(GcmContext *context, uint8_t *x);
 void gcmXorBlock(uint8_t *x, const uint8_t *a, const uint8_t *b, size_t n);
 void gcmIncCounter(uint8_t *x);
@@ -0,0 +1,195 @@
+/**
+ * @file cpu_features.c
+ * @brief Run-time detection of CPU instruction set extensions
+ *
+ * @section License
+ *
+ * Copyright (C) 2010-2017 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneCrypto Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * Hardware-accelerated code paths (AES-NI and the like) are compiled in
+ * when the corresponding option is enabled, but are only executed when the
+ * processor reports the required instruction set extensions. The detection
+ * is performed once, the first time the features are queried
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 1.7.8
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL CRYPTO_TRACE_LEVEL
+
+//Dependencies
+#include "crypto.h"
+#include "cpu_features.h"
+#include "debug.h"
+
+//x86 or x86-64 target?
+#if defined(CPU_FEATURES_X86)
+   #if defined(_MSC_VER)
+      #include <intrin.h>
+   #else
+      #include <cpuid.h>
+   #endif
+#endif
+
+//Set of features supported by the CPU
+static uint32_t cpuFeatures = 0;
+//The detection has already been performed?
+static bool_t cpuFeaturesReady = FALSE;
+
+//x86 or x86-64 target?
+#if defined(CPU_FEATURES_X86)
+
+/**
+ * @brief Execute CPUID instruction
+ * @param[in] leaf Value of the EAX register
+ * @param[in] subleaf Value of the ECX register
+ * @param[out] regs Contents of the EAX, EBX, ECX and EDX registers
+ **/
+
+static void cpuId(uint32_t leaf, uint32_t subleaf, uint32_t *regs)
+{
+#if defined(_MSC_VER)
+   int info[4];
+
+   //Query processor information
+   __cpuidex(info, leaf, subleaf);
+
+   //Return the contents of the registers
+   regs[0] = info[0];
+   regs[1] = info[1];
+   regs[2] = info[2];
+   regs[3] = info[3];
+#else
+   //Query processor information
+   __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+
+/**
+ * @brief Read the XCR0 register (XGETBV instruction)
+ * @return Set of processor states enabled by the operating system
+ **/
+
+static uint32_t cpuXgetbv(void)
+{
+#if defined(_MSC_VER)
+   //Read the lower half of XCR0
+   return (uint32_t) _xgetbv(0);
+#else
+   uint32_t eax;
+   uint32_t edx;
+
+   //Read XCR0
+   __asm__ __volatile__("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+
+   //Return the lower half of XCR0
+   return eax;
+#endif
+}
+
+#endif
+
+
+/**
+ * @brief Retrieve the instruction set extensions supported by the CPU
+ * @return Bitmask of CPU features (CPU_FEATURE_xxx)
+ **/
+
+uint32_t cpuGetFeatures(void)
+{
+#if defined(CPU_FEATURES_X86)
+   uint32_t maxLeaf;
+   uint32_t xcr0;
+   uint32_t regs[4];
+#endif
+
+   //First call?
+   if(!cpuFeaturesReady)
+   {
+#if defined(CPU_FEATURES_X86)
+      //Retrieve the highest supported standard leaf
+      cpuId(0, 0, regs);
+      maxLeaf = regs[0];
+
+      //Processor info and feature bits
+      if(maxLeaf >= 1)
+      {
+         cpuId(1, 0, regs);
+
+         //SSE2 (EDX bit 26)
+         if(regs[3] & 0x04000000)
+            cpuFeatures |= CPU_FEATURE_SSE2;
+         //SSSE3 (ECX bit 9)
+         if(regs[2] & 0x00000200)
+            cpuFeatures |= CPU_FEATURE_SSSE3;
+         //AES-NI (ECX bit 25)
+         if(regs[2] & 0x02000000)
+            cpuFeatures |= CPU_FEATURE_AESNI;
+         //PCLMULQDQ (ECX bit 1)
+         if(regs[2] & 0x00000002)
+            cpuFeatures |= CPU_FEATURE_PCLMULQDQ;
+         //SSE4.1 (ECX bit 19)
+         if(regs[2] & 0x00080000)
+            cpuFeatures |= CPU_FEATURE_SSE41;
+
+         //The OS must save the extended registers on context switches
+         //(OSXSAVE, ECX bit 27) before AVX instructions can be used
+         if(regs[2] & 0x08000000)
+         {
+            //Retrieve the processor states enabled by the OS
+            xcr0 = cpuXgetbv();
+         }
+         else
+         {
+            //AVX instructions cannot be used
+            xcr0 = 0;
+         }
+
+         //Extended features
+         if(maxLeaf >= 7)
+         {
+            cpuId(7, 0, regs);
+
+            //AVX2 (EBX bit 5) requires XMM and YMM states
+            if((regs[1] & 0x00000020) && (xcr0 & 0x06) == 0x06)
+               cpuFeatures |= CPU_FEATURE_AVX2;
+            //AVX-512F (EBX bit 16) also requires opmask and ZMM states
+            if((regs[1] & 0x00010000) && (xcr0 & 0xE6) == 0xE6)
+               cpuFeatures |= CPU_FEATURE_AVX512F;
+            //SHA extensions (EBX bit 29)
+            if(regs[1] & 0x20000000)
+               cpuFeatures |= CPU_FEATURE_SHA;
+         }
+      }
+
+      //Debug message
+      TRACE_DEBUG("CPU features: 0x%08" PRIX32 "\r\n", cpuFeatures);
+#endif
+
+      //The result is cached for subsequent calls
+      cpuFeaturesReady = TRUE;
+   }
+
+   //Return the set of supported features
+   return cpuFeatures;
+}
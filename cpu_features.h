@@ -0,0 +1,93 @@
+/**
+ * @file cpu_features.h
+ * @brief Run-time detection of CPU instruction set extensions
+ *
+ * @section License
+ *
+ * Copyright (C) 2010-2017 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneCrypto Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 1.7.8
+ **/
+
+#ifndef _CPU_FEATURES_H
+#define _CPU_FEATURES_H
+
+//Dependencies
+#include "crypto.h"
+
+//x86 or x86-64 target?
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+   #define CPU_FEATURES_X86
+#endif
+
+//Little-endian ARM target with Advanced SIMD (NEON) instructions?
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARM_BIG_ENDIAN)
+   #define CPU_FEATURES_NEON
+#endif
+
+//AArch64 target with SHA-1 and SHA-256 instructions (ARMv8 cryptographic
+//extension)?
+#if defined(__aarch64__) && defined(CPU_FEATURES_NEON) && \
+   (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+   #define CPU_FEATURES_ARM_SHA
+#endif
+
+//Check crypto library configuration
+#if (AESNI_SUPPORT == ENABLED && !defined(CPU_FEATURES_X86))
+   #error AESNI_SUPPORT requires an x86 or x86-64 target
+#elif (PCLMUL_SUPPORT == ENABLED && !defined(CPU_FEATURES_X86))
+   #error PCLMUL_SUPPORT requires an x86 or x86-64 target
+#elif (SIMD_SUPPORT == ENABLED && !defined(CPU_FEATURES_X86) && !defined(CPU_FEATURES_NEON))
+   #error SIMD_SUPPORT requires an x86, x86-64 or NEON-capable ARM target
+#elif (SHA_EXT_SUPPORT == ENABLED && !defined(CPU_FEATURES_X86) && !defined(CPU_FEATURES_ARM_SHA))
+   #error SHA_EXT_SUPPORT requires an x86, x86-64 or ARMv8 target with the cryptographic extension
+#endif
+
+//Allow the use of instruction set extensions on a per-function basis
+#if defined(__GNUC__)
+   #define CPU_TARGET(features) __attribute__((target(features)))
+#else
+   #define CPU_TARGET(features)
+#endif
+
+//CPU features
+#define CPU_FEATURE_SSE2      0x00000001
+#define CPU_FEATURE_SSSE3     0x00000002
+#define CPU_FEATURE_AESNI     0x00000004
+#define CPU_FEATURE_PCLMULQDQ 0x00000008
+#define CPU_FEATURE_AVX2      0x00000010
+#define CPU_FEATURE_AVX512F   0x00000020
+#define CPU_FEATURE_SSE41     0x00000040
+#define CPU_FEATURE_SHA       0x00000080
+
+//C++ guard
+#ifdef __cplusplus
+   extern "C" {
+#endif
+
+//CPU feature detection
+uint32_t cpuGetFeatures(void);
+
+//C++ guard
+#ifdef __cplusplus
+   }
+#endif
+
+#endif
@@ -49,6 +49,35 @@
    #error MPI_ASM_SUPPORT parameter is not valid
 #endif
 
+//AES-NI instruction set support (x86 targets only)
+#ifndef AESNI_SUPPORT
+   #define AESNI_SUPPORT DISABLED
+#elif (AESNI_SUPPORT != ENABLED && AESNI_SUPPORT != DISABLED)
+   #error AESNI_SUPPORT parameter is not valid
+#endif
+
+//PCLMULQDQ instruction set support (x86 targets only)
+#ifndef PCLMUL_SUPPORT
+   #define PCLMUL_SUPPORT DISABLED
+#elif (PCLMUL_SUPPORT != ENABLED && PCLMUL_SUPPORT != DISABLED)
+   #error PCLMUL_SUPPORT parameter is not valid
+#endif
+
+//SIMD support (SSE2, AVX2 and AVX-512 on x86 targets, NEON on ARM targets)
+#ifndef SIMD_SUPPORT
+   #define SIMD_SUPPORT DISABLED
+#elif (SIMD_SUPPORT != ENABLED && SIMD_SUPPORT != DISABLED)
+   #error SIMD_SUPPORT parameter is not valid
+#endif
+
+//SHA instruction set extensions (x86 targets, or ARMv8 targets with the
+//cryptographic extension)
+#ifndef SHA_EXT_SUPPORT
+   #define SHA_EXT_SUPPORT DISABLED
+#elif (SHA_EXT_SUPPORT != ENABLED && SHA_EXT_SUPPORT != DISABLED)
+   #error SHA_EXT_SUPPORT parameter is not valid
+#endif
+
 //Base64 encoding support
 #ifndef BASE64_SUPPORT
    #define BASE64_SUPPORT ENABLED
@@ -189,6 +218,13 @@
    #error KECCAK_SUPPORT parameter is not valid
 #endif
 
+//ParallelHash support
+#ifndef PARALLEL_HASH_SUPPORT
+   #define PARALLEL_HASH_SUPPORT DISABLED
+#elif (PARALLEL_HASH_SUPPORT != ENABLED && PARALLEL_HASH_SUPPORT != DISABLED)
+   #error PARALLEL_HASH_SUPPORT parameter is not valid
+#endif
+
 //Tiger hash support
 #ifndef TIGER_SUPPORT
    #define TIGER_SUPPORT ENABLED
@@ -392,6 +428,13 @@
    #error PKCS5_SUPPORT parameter is not valid
 #endif
 
+//HKDF support
+#ifndef HKDF_SUPPORT
+   #define HKDF_SUPPORT ENABLED
+#elif (HKDF_SUPPORT != ENABLED && HKDF_SUPPORT != DISABLED)
+   #error HKDF_SUPPORT parameter is not valid
+#endif
+
 //Yarrow PRNG support
 #ifndef YARROW_SUPPORT
    #define YARROW_SUPPORT ENABLED
@@ -554,6 +597,45 @@
    #define MAX_HASH_DIGEST_SIZE MD2_DIGEST_SIZE
 #endif
 
+//Maximum exported state size (hash algorithms)
+#if (SHA3_224_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA3_224_STATE_SIZE
+#elif (SHA3_256_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA3_256_STATE_SIZE
+#elif (SHA3_384_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA3_384_STATE_SIZE
+#elif (SHA3_512_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA3_512_STATE_SIZE
+#elif (SHA512_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA512_STATE_SIZE
+#elif (SHA384_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA384_STATE_SIZE
+#elif (SHA512_256_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA512_256_STATE_SIZE
+#elif (SHA512_224_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA512_224_STATE_SIZE
+#elif (WHIRLPOOL_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE WHIRLPOOL_STATE_SIZE
+#elif (SHA256_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA256_STATE_SIZE
+#elif (SHA224_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA224_STATE_SIZE
+#elif (TIGER_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE TIGER_STATE_SIZE
+#elif (SHA1_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE SHA1_STATE_SIZE
+#elif (RIPEMD160_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE RIPEMD160_STATE_SIZE
+#elif (RIPEMD128_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE RIPEMD128_STATE_SIZE
+#elif (MD5_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE MD5_STATE_SIZE
+#elif (MD4_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE MD4_STATE_SIZE
+#elif (MD2_SUPPORT == ENABLED)
+   #define MAX_HASH_STATE_SIZE MD2_STATE_SIZE
+#endif
+
 //Maximum context size (cipher algorithms)
 #if (ARIA_SUPPORT == ENABLED)
    #define MAX_CIPHER_CONTEXT_SIZE sizeof(AriaContext)
@@ -594,6 +676,13 @@
    #define MAX_CIPHER_BLOCK_SIZE IDEA_BLOCK_SIZE
 #endif
 
+//Number of blocks processed at a time by the multi-block cipher routines
+#ifndef CIPHER_PARALLEL_BLOCKS
+   #define CIPHER_PARALLEL_BLOCKS 8
+#elif (CIPHER_PARALLEL_BLOCKS < 1)
+   #error CIPHER_PARALLEL_BLOCKS parameter is not valid
+#endif
+
 //Rotate left operation
 #define ROL8(a, n) (((a) << (n)) | ((a) >> (8 - (n))))
 #define ROL16(a, n) (((a) << (n)) | ((a) >> (16 - (n))))
@@ -659,6 +748,11 @@ typedef error_t (*HashAlgoCompute)(const void *data, size_t length, uint8_t *dig
 typedef void (*HashAlgoInit)(void *context);
 typedef void (*HashAlgoUpdate)(void *context, const void *data, size_t length);
 typedef void (*HashAlgoFinal)(void *context, uint8_t *digest);
+//A clone only copies the live part of a context (chaining value, counters and
+//pending bytes), so that a running hash can be forked without re-hashing
+typedef void (*HashAlgoClone)(void *destContext, const void *srcContext);
+typedef size_t (*HashAlgoExportState)(const void *context, uint8_t *output);
+typedef error_t (*HashAlgoImportState)(void *context, const uint8_t *input, size_t length);
 
 //Common API for encryption algorithms
 typedef error_t (*CipherAlgoInit)(void *context, const uint8_t *key, size_t keyLength);
@@ -666,6 +760,8 @@ typedef void (*CipherAlgoEncryptStream)(void *context, const uint8_t *input, uin
 typedef void (*CipherAlgoDecryptStream)(void *context, const uint8_t *input, uint8_t *output, size_t length);
 typedef void (*CipherAlgoEncryptBlock)(void *context, const uint8_t *input, uint8_t *output);
 typedef void (*CipherAlgoDecryptBlock)(void *context, const uint8_t *input, uint8_t *output);
+typedef void (*CipherAlgoEncryptBlocks)(void *context, const uint8_t *input, uint8_t *output, size_t n);
+typedef void (*CipherAlgoDecryptBlocks)(void *context, const uint8_t *input, uint8_t *output, size_t n);
 
 //Common API for pseudo-random number generators
 typedef error_t (*PrngAlgoInit)(void *context);
@@ -697,10 +793,14 @@ typedef struct
    size_t contextSize;
    size_t blockSize;
    size_t digestSize;
+   size_t stateSize;
    HashAlgoCompute compute;
    HashAlgoInit init;
    HashAlgoUpdate update;
    HashAlgoFinal final;
+   HashAlgoClone clone;
+   HashAlgoExportState exportState;
+   HashAlgoImportState importState;
 } HashAlgo;
 
 
@@ -719,6 +819,8 @@ typedef struct
    CipherAlgoDecryptStream decryptStream;
    CipherAlgoEncryptBlock encryptBlock;
    CipherAlgoDecryptBlock decryptBlock;
+   CipherAlgoEncryptBlocks encryptBlocks;
+   CipherAlgoDecryptBlocks decryptBlocks;
 } CipherAlgo;
 
 
@@ -0,0 +1,362 @@
+/**
+ * @file hkdf.c
+ * @brief HKDF (HMAC-based Key Derivation Function)
+ *
+ * @section License
+ *
+ * Copyright (C) 2010-2017 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneCrypto Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * HKDF follows the extract-then-expand paradigm: a pseudorandom key (PRK)
+ * is first extracted from the input keying material, and then expanded into
+ * as many output bytes as required. The expansion runs from the precomputed
+ * inner and outer midstates of the PRK, and writes its output directly into
+ * the caller's buffer. Refer to RFC 5869 and RFC 8446 (HKDF-Expand-Label)
+ * for more details
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 1.7.8
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL CRYPTO_TRACE_LEVEL
+
+//Dependencies
+#include <string.h>
+#include "crypto.h"
+#include "hkdf.h"
+
+//Check crypto library configuration
+#if (HKDF_SUPPORT == ENABLED)
+
+
+/**
+ * @brief HKDF key derivation function
+ * @param[in] hash Underlying hash function
+ * @param[in] ikm Input keying material
+ * @param[in] ikmLen Length of the input keying material
+ * @param[in] salt Optional salt value (a non-secret random value)
+ * @param[in] saltLen Length of the salt
+ * @param[in] info Optional application specific information
+ * @param[in] infoLen Length of the application specific information
+ * @param[out] okm Output keying material
+ * @param[in] okmLen Length of the output keying material
+ * @return Error code
+ **/
+
+error_t hkdf(const HashAlgo *hash, const uint8_t *ikm, size_t ikmLen,
+   const uint8_t *salt, size_t saltLen, const uint8_t *info, size_t infoLen,
+   uint8_t *okm, size_t okmLen)
+{
+   error_t error;
+   HmacKey prk;
+   uint8_t buffer[MAX_HASH_DIGEST_SIZE];
+
+   //Perform HKDF extract step
+   error = hkdfExtract(hash, ikm, ikmLen, salt, saltLen, buffer);
+
+   //Check status code
+   if(!error)
+   {
+      //Precompute the PRK midstates
+      hmacKeyInit(&prk, hash, buffer, hash->digestSize);
+      //Perform HKDF expand step
+      error = hkdfExpandFromKey(&prk, info, infoLen, okm, okmLen);
+   }
+
+   //Clear the pseudorandom key
+   memset(buffer, 0, sizeof(buffer));
+   memset(&prk, 0, sizeof(HmacKey));
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief HKDF extract step
+ * @param[in] hash Underlying hash function
+ * @param[in] ikm Input keying material
+ * @param[in] ikmLen Length of the input keying material
+ * @param[in] salt Optional salt value (a non-secret random value)
+ * @param[in] saltLen Length of the salt
+ * @param[out] prk Pseudorandom key (hash->digestSize bytes)
+ * @return Error code
+ **/
+
+error_t hkdfExtract(const HashAlgo *hash, const uint8_t *ikm, size_t ikmLen,
+   const uint8_t *salt, size_t saltLen, uint8_t *prk)
+{
+   HmacContext context;
+   uint8_t zero[MAX_HASH_DIGEST_SIZE];
+
+   //Check parameters
+   if(hash == NULL || prk == NULL)
+      return ERROR_INVALID_PARAMETER;
+   if(ikm == NULL && ikmLen != 0)
+      return ERROR_INVALID_PARAMETER;
+   if(salt == NULL && saltLen != 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //The salt defaults to a string of zeros whose length is the digest size
+   if(saltLen == 0)
+   {
+      memset(zero, 0, hash->digestSize);
+      salt = zero;
+      saltLen = hash->digestSize;
+   }
+
+   //Compute PRK = HMAC-Hash(salt, IKM)
+   hmacInit(&context, hash, salt, saltLen);
+   hmacUpdate(&context, ikm, ikmLen);
+   hmacFinal(&context, prk);
+
+   //Clear the HMAC context
+   memset(&context, 0, sizeof(HmacContext));
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief HKDF expand step
+ * @param[in] hash Underlying hash function
+ * @param[in] prk Pseudorandom key
+ * @param[in] prkLen Length of the pseudorandom key
+ * @param[in] info Optional application specific information
+ * @param[in] infoLen Length of the application specific information
+ * @param[out] okm Output keying material
+ * @param[in] okmLen Length of the output keying material
+ * @return Error code
+ **/
+
+error_t hkdfExpand(const HashAlgo *hash, const uint8_t *prk, size_t prkLen,
+   const uint8_t *info, size_t infoLen, uint8_t *okm, size_t okmLen)
+{
+   error_t error;
+   HmacKey key;
+
+   //Check parameters
+   if(hash == NULL || prk == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //The PRK must be at least as long as the digest
+   if(prkLen < hash->digestSize)
+      return ERROR_INVALID_LENGTH;
+
+   //Precompute the PRK midstates
+   hmacKeyInit(&key, hash, prk, prkLen);
+   //Expand the PRK
+   error = hkdfExpandFromKey(&key, info, infoLen, okm, okmLen);
+
+   //Clear the precomputed key
+   memset(&key, 0, sizeof(HmacKey));
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief HKDF expand step (precomputed pseudorandom key)
+ *
+ * Each block T(i) = HMAC-Hash(PRK, T(i-1) || info || i) resumes from the
+ * precomputed midstates of the PRK. When T(i-1), info and the counter fit
+ * in a single block, which is the case for all the TLS 1.3 labels, a block
+ * costs only two compression function calls. Complete blocks are written
+ * directly into the output buffer
+ *
+ * @param[in] prk Precomputed pseudorandom key (see hmacKeyInit)
+ * @param[in] info Optional application specific information
+ * @param[in] infoLen Length of the application specific information
+ * @param[out] okm Output keying material
+ * @param[in] okmLen Length of the output keying material
+ * @return Error code
+ **/
+
+error_t hkdfExpandFromKey(const HmacKey *prk, const uint8_t *info,
+   size_t infoLen, uint8_t *okm, size_t okmLen)
+{
+   uint8_t i;
+   size_t digestSize;
+   const uint8_t *t;
+   HmacContext context;
+   uint8_t buffer[MAX_HASH_DIGEST_SIZE];
+
+   //Check parameters
+   if(prk == NULL || prk->hash == NULL)
+      return ERROR_INVALID_PARAMETER;
+   if(info == NULL && infoLen != 0)
+      return ERROR_INVALID_PARAMETER;
+   if(okm == NULL && okmLen != 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //Size of the PRF output
+   digestSize = prk->hash->digestSize;
+
+   //Check the length of the output keying material
+   if(okmLen > (255 * digestSize))
+      return ERROR_INVALID_LENGTH;
+
+   //T(0) is an empty string
+   t = NULL;
+
+   //Compute T(1), T(2), ... until enough keying material is available
+   for(i = 1; okmLen > 0; i++)
+   {
+      //Compute T(i) = HMAC-Hash(PRK, T(i-1) || info || i)
+      hmacInitFromKey(&context, prk);
+
+      if(t != NULL)
+         hmacUpdate(&context, t, digestSize);
+
+      hmacUpdate(&context, info, infoLen);
+      hmacUpdate(&context, &i, sizeof(uint8_t));
+
+      //Complete block?
+      if(okmLen >= digestSize)
+      {
+         //Write T(i) directly into the output buffer
+         hmacFinal(&context, okm);
+
+         //T(i) is the input of the next block
+         t = okm;
+
+         //Point to the next block
+         okm += digestSize;
+         okmLen -= digestSize;
+      }
+      else
+      {
+         //The last block is truncated
+         hmacFinal(&context, buffer);
+         memcpy(okm, buffer, okmLen);
+
+         //The output keying material is complete
+         okmLen = 0;
+      }
+   }
+
+   //Clear the HMAC context
+   memset(&context, 0, sizeof(HmacContext));
+   memset(buffer, 0, sizeof(buffer));
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief TLS 1.3 HKDF-Expand-Label function
+ * @param[in] hash Underlying hash function
+ * @param[in] secret Secret
+ * @param[in] secretLen Length of the secret
+ * @param[in] label Identifying label (NULL-terminated string, without the
+ *   "tls13 " prefix)
+ * @param[in] context Context value
+ * @param[in] contextLen Length of the context value
+ * @param[out] output Output keying material
+ * @param[in] outputLen Length of the output keying material
+ * @return Error code
+ **/
+
+error_t hkdfExpandLabel(const HashAlgo *hash, const uint8_t *secret,
+   size_t secretLen, const char_t *label, const uint8_t *context,
+   size_t contextLen, uint8_t *output, size_t outputLen)
+{
+   error_t error;
+   HmacKey key;
+
+   //Check parameters
+   if(hash == NULL || secret == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Precompute the midstates of the secret
+   hmacKeyInit(&key, hash, secret, secretLen);
+   //Expand the secret
+   error = hkdfExpandLabelFromKey(&key, label, context, contextLen, output,
+      outputLen);
+
+   //Clear the precomputed key
+   memset(&key, 0, sizeof(HmacKey));
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief TLS 1.3 HKDF-Expand-Label function (precomputed secret)
+ *
+ * The HkdfLabel structure (output length, "tls13 " || label, context) is
+ * used as the info parameter of HKDF-Expand. A secret expanded into several
+ * traffic keys only needs to be precomputed once
+ *
+ * @param[in] secret Precomputed secret (see hmacKeyInit)
+ * @param[in] label Identifying label (NULL-terminated string, without the
+ *   "tls13 " prefix)
+ * @param[in] context Context value
+ * @param[in] contextLen Length of the context value
+ * @param[out] output Output keying material
+ * @param[in] outputLen Length of the output keying material
+ * @return Error code
+ **/
+
+error_t hkdfExpandLabelFromKey(const HmacKey *secret, const char_t *label,
+   const uint8_t *context, size_t contextLen, uint8_t *output,
+   size_t outputLen)
+{
+   size_t n;
+   size_t labelLen;
+   uint8_t info[2 + 1 + 255 + 1 + 255];
+
+   //Check parameters
+   if(label == NULL || (context == NULL && contextLen != 0))
+      return ERROR_INVALID_PARAMETER;
+
+   //Length of the label, including the "tls13 " prefix
+   labelLen = strlen(HKDF_TLS13_LABEL_PREFIX) + strlen(label);
+
+   //The length fields are limited to 16 bits and 8 bits respectively
+   if(outputLen > 0xFFFF || labelLen > 255 || contextLen > 255)
+      return ERROR_INVALID_LENGTH;
+
+   //Length of the output keying material (16-bit integer)
+   STORE16BE(outputLen, info);
+   n = sizeof(uint16_t);
+
+   //Label (variable-length vector)
+   info[n++] = (uint8_t) labelLen;
+   memcpy(info + n, HKDF_TLS13_LABEL_PREFIX, strlen(HKDF_TLS13_LABEL_PREFIX));
+   n += strlen(HKDF_TLS13_LABEL_PREFIX);
+   memcpy(info + n, label, strlen(label));
+   n += strlen(label);
+
+   //Context (variable-length vector)
+   info[n++] = (uint8_t) contextLen;
+   memcpy(info + n, context, contextLen);
+   n += contextLen;
+
+   //Expand the secret
+   return hkdfExpandFromKey(secret, info, n, output, outputLen);
+}
+
+#endif
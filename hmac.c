@@ -105,44 +105,63 @@ error_t hmacCompute(const HashAlgo *hash, const void *key, size_t keyLength,
 
 
 /**
- * @brief Initialize HMAC calculation
- * @param[in] context Pointer to the HMAC context to initialize
+ * @brief Pad the key and XOR it with ipad
  * @param[in] hash Hash algorithm used to compute HMAC
+ * @param[in] hashContext Hash context used to digest long keys
  * @param[in] key Key to use in the hash algorithm
  * @param[in] keyLength Length of the key
+ * @param[out] output Resulting block (K0 XOR ipad)
  **/
 
-void hmacInit(HmacContext *context, const HashAlgo *hash,
-   const void *key, size_t keyLength)
+static void hmacPrepareKey(const HashAlgo *hash, void *hashContext,
+   const void *key, size_t keyLength, uint8_t *output)
 {
    uint_t i;
 
-   //Hash algorithm used to compute HMAC
-   context->hash = hash;
-
    //The key is longer than the block size?
    if(keyLength > hash->blockSize)
    {
       //Initialize the hash function context
-      hash->init(context->hashContext);
+      hash->init(hashContext);
       //Digest the original key
-      hash->update(context->hashContext, key, keyLength);
+      hash->update(hashContext, key, keyLength);
       //Finalize the message digest computation
-      hash->final(context->hashContext, context->key);
+      hash->final(hashContext, output);
       //Key is padded to the right with extra zeros
-      memset(context->key + hash->digestSize, 0, hash->blockSize - hash->digestSize);
+      memset(output + hash->digestSize, 0, hash->blockSize - hash->digestSize);
    }
    else
    {
       //Copy the key
-      memcpy(context->key, key, keyLength);
+      memcpy(output, key, keyLength);
       //Key is padded to the right with extra zeros
-      memset(context->key + keyLength, 0, hash->blockSize - keyLength);
+      memset(output + keyLength, 0, hash->blockSize - keyLength);
    }
 
    //XOR the resulting key with ipad
    for(i = 0; i < hash->blockSize; i++)
-      context->key[i] ^= HMAC_IPAD;
+      output[i] ^= HMAC_IPAD;
+}
+
+
+/**
+ * @brief Initialize HMAC calculation
+ * @param[in] context Pointer to the HMAC context to initialize
+ * @param[in] hash Hash algorithm used to compute HMAC
+ * @param[in] key Key to use in the hash algorithm
+ * @param[in] keyLength Length of the key
+ **/
+
+void hmacInit(HmacContext *context, const HashAlgo *hash,
+   const void *key, size_t keyLength)
+{
+   //Hash algorithm used to compute HMAC
+   context->hash = hash;
+   //The outer pad is computed from the key when the HMAC is finalized
+   context->hmacKey = NULL;
+
+   //Pad the key and XOR it with ipad
+   hmacPrepareKey(hash, context->hashContext, key, keyLength, context->key);
 
    //Initialize context for the first pass
    hash->init(context->hashContext);
@@ -182,14 +201,24 @@ void hmacFinal(HmacContext *context, uint8_t *digest)
    //Finish the first pass
    hash->final(context->hashContext, context->digest);
 
-   //XOR the original key with opad
-   for(i = 0; i < hash->blockSize; i++)
-      context->key[i] ^= HMAC_IPAD ^ HMAC_OPAD;
+   //Precomputed key?
+   if(context->hmacKey != NULL)
+   {
+      //Resume the second pass after the outer pad
+      hash->clone(context->hashContext, context->hmacKey->outerContext);
+   }
+   else
+   {
+      //XOR the original key with opad
+      for(i = 0; i < hash->blockSize; i++)
+         context->key[i] ^= HMAC_IPAD ^ HMAC_OPAD;
+
+      //Initialize context for the second pass
+      hash->init(context->hashContext);
+      //Start with outer pad
+      hash->update(context->hashContext, context->key, hash->blockSize);
+   }
 
-   //Initialize context for the second pass
-   hash->init(context->hashContext);
-   //Start with outer pad
-   hash->update(context->hashContext, context->key, hash->blockSize);
    //Then digest the result of the first hash
    hash->update(context->hashContext, context->digest, hash->digestSize);
    //Finish the second pass
@@ -200,4 +229,99 @@ void hmacFinal(HmacContext *context, uint8_t *digest)
       memcpy(digest, context->digest, hash->digestSize);
 }
 
+
+/**
+ * @brief Precompute an HMAC key
+ *
+ * The inner and outer pads are digested once. Every subsequent HMAC
+ * computation with the same key starts from copies of the resulting hash
+ * contexts, which saves two compression function calls per message
+ *
+ * @param[out] hmacKey Pointer to the precomputed key
+ * @param[in] hash Hash algorithm used to compute HMAC
+ * @param[in] key Key to use in the hash algorithm
+ * @param[in] keyLength Length of the key
+ **/
+
+void hmacKeyInit(HmacKey *hmacKey, const HashAlgo *hash,
+   const void *key, size_t keyLength)
+{
+   uint_t i;
+   uint8_t block[MAX_HASH_BLOCK_SIZE];
+
+   //Hash algorithm used to compute HMAC
+   hmacKey->hash = hash;
+
+   //Pad the key and XOR it with ipad
+   hmacPrepareKey(hash, hmacKey->innerContext, key, keyLength, block);
+
+   //Digest the inner pad
+   hash->init(hmacKey->innerContext);
+   hash->update(hmacKey->innerContext, block, hash->blockSize);
+
+   //XOR the original key with opad
+   for(i = 0; i < hash->blockSize; i++)
+      block[i] ^= HMAC_IPAD ^ HMAC_OPAD;
+
+   //Digest the outer pad
+   hash->init(hmacKey->outerContext);
+   hash->update(hmacKey->outerContext, block, hash->blockSize);
+
+   //Clear the padded key from the stack
+   memset(block, 0, sizeof(block));
+}
+
+
+/**
+ * @brief Initialize HMAC calculation with a precomputed key
+ *
+ * The precomputed key must remain valid until hmacFinal is called
+ *
+ * @param[in] context Pointer to the HMAC context to initialize
+ * @param[in] hmacKey Pointer to the precomputed key
+ **/
+
+void hmacInitFromKey(HmacContext *context, const HmacKey *hmacKey)
+{
+   //Hash algorithm used to compute HMAC
+   context->hash = hmacKey->hash;
+   //The outer pad has already been digested
+   context->hmacKey = hmacKey;
+
+   //Resume the first pass after the inner pad
+   hmacKey->hash->clone(context->hashContext, hmacKey->innerContext);
+}
+
+
+/**
+ * @brief Compute HMAC with a precomputed key
+ * @param[in] hmacKey Pointer to the precomputed key
+ * @param[in] data The input data for which to compute the hash code
+ * @param[in] dataLength Length of the input data
+ * @param[out] digest The computed HMAC value
+ * @return Error code
+ **/
+
+error_t hmacComputeFromKey(const HmacKey *hmacKey, const void *data,
+   size_t dataLength, uint8_t *digest)
+{
+   //Allocate a memory buffer to hold the HMAC context
+   HmacContext *context = cryptoAllocMem(sizeof(HmacContext));
+   //Failed to allocate memory?
+   if(context == NULL)
+      return ERROR_OUT_OF_MEMORY;
+
+   //Initialize the HMAC context
+   hmacInitFromKey(context, hmacKey);
+   //Digest the message
+   hmacUpdate(context, data, dataLength);
+   //Finalize the HMAC computation
+   hmacFinal(context, digest);
+
+   //Free previously allocated memory
+   cryptoFreeMem(context);
+   //Successful processing
+   return NO_ERROR;
+}
+
 #endif
@@ -133,6 +133,21 @@
 #endif
 
 
+/**
+ * @brief Precomputed HMAC key
+ *
+ * The hash contexts are captured after the inner and outer pads have been
+ * digested, so that the key is processed only once
+ **/
+
+typedef struct
+{
+   const HashAlgo *hash;
+   uint8_t innerContext[MAX_HASH_CONTEXT_SIZE];
+   uint8_t outerContext[MAX_HASH_CONTEXT_SIZE];
+} HmacKey;
+
+
 /**
  * @brief HMAC algorithm context
  **/
@@ -140,6 +155,7 @@
 typedef struct
 {
    const HashAlgo *hash;
+   const HmacKey *hmacKey;
    uint8_t hashContext[MAX_HASH_CONTEXT_SIZE];
    uint8_t key[MAX_HASH_BLOCK_SIZE];
    uint8_t digest[MAX_HASH_DIGEST_SIZE];
@@ -170,6 +186,14 @@ void hmacInit(HmacContext *context, const HashAlgo *hash,
 void hmacUpdate(HmacContext *context, const void *data, size_t length);
 void hmacFinal(HmacContext *context, uint8_t *digest);
 
+void hmacKeyInit(HmacKey *hmacKey, const HashAlgo *hash,
+   const void *key, size_t keyLength);
+
+void hmacInitFromKey(HmacContext *context, const HmacKey *hmacKey);
+
+error_t hmacComputeFromKey(const HmacKey *hmacKey, const void *data,
+   size_t dataLength, uint8_t *digest);
+
 //C++ guard
 #ifdef __cplusplus
    }
@@ -33,6 +33,12 @@
 #include <string.h>
 #include "crypto.h"
 #include "keccak.h"
+#include "cpu_features.h"
+
+//SIMD support?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   #include <immintrin.h>
+#endif
 
 //Check crypto library configuration
 #if (KECCAK_SUPPORT == ENABLED)
@@ -72,6 +78,167 @@ static const keccak_lane_t rc[KECCAK_NR] =
 #endif
 };
 
+//64-bit lanes?
+#if (KECCAK_L == 6)
+
+//Lane complementing transform (lanes 1, 2, 8, 12, 17 and 20 are kept in
+//complemented form during the permutation)
+#define KECCAK_COMPLEMENT(a) \
+{ \
+   a[1] = ~a[1]; \
+   a[2] = ~a[2]; \
+   a[8] = ~a[8]; \
+   a[12] = ~a[12]; \
+   a[17] = ~a[17]; \
+   a[20] = ~a[20]; \
+}
+
+//Keccak-f[1600] round function. Lane (x, y) is stored at index 5 * y + x,
+//and lane complementing reduces the number of NOT operations of the chi
+//step from 25 to 8
+#define KECCAK_ROUND(a, e, rc) \
+{ \
+   c0 = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20]; \
+   c1 = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21]; \
+   c2 = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22]; \
+   c3 = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23]; \
+   c4 = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24]; \
+   d0 = c4 ^ ROL64(c1, 1); \
+   d1 = c0 ^ ROL64(c2, 1); \
+   d2 = c1 ^ ROL64(c3, 1); \
+   d3 = c2 ^ ROL64(c4, 1); \
+   d4 = c3 ^ ROL64(c0, 1); \
+   b0 = a[0] ^ d0; \
+   b1 = ROL64(a[6] ^ d1, 44); \
+   b2 = ROL64(a[12] ^ d2, 43); \
+   b3 = ROL64(a[18] ^ d3, 21); \
+   b4 = ROL64(a[24] ^ d4, 14); \
+   e[0] = b0 ^ (b1 | b2) ^ (rc); \
+   e[1] = b1 ^ (~b2 | b3); \
+   e[2] = b2 ^ (b3 & b4); \
+   e[3] = b3 ^ (b4 | b0); \
+   e[4] = b4 ^ (b0 & b1); \
+   b0 = ROL64(a[3] ^ d3, 28); \
+   b1 = ROL64(a[9] ^ d4, 20); \
+   b2 = ROL64(a[10] ^ d0, 3); \
+   b3 = ROL64(a[16] ^ d1, 45); \
+   b4 = ROL64(a[22] ^ d2, 61); \
+   e[5] = b0 ^ (b1 | b2); \
+   e[6] = b1 ^ (b2 & b3); \
+   e[7] = b2 ^ (b3 | ~b4); \
+   e[8] = b3 ^ (b4 | b0); \
+   e[9] = b4 ^ (b0 & b1); \
+   b0 = ROL64(a[1] ^ d1, 1); \
+   b1 = ROL64(a[7] ^ d2, 6); \
+   b2 = ROL64(a[13] ^ d3, 25); \
+   b3 = ROL64(a[19] ^ d4, 8); \
+   b4 = ROL64(a[20] ^ d0, 18); \
+   e[10] = b0 ^ (b1 | b2); \
+   e[11] = b1 ^ (b2 & b3); \
+   e[12] = b2 ^ (~b3 & b4); \
+   e[13] = ~b3 ^ (b4 | b0); \
+   e[14] = b4 ^ (b0 & b1); \
+   b0 = ROL64(a[4] ^ d4, 27); \
+   b1 = ROL64(a[5] ^ d0, 36); \
+   b2 = ROL64(a[11] ^ d1, 10); \
+   b3 = ROL64(a[17] ^ d2, 15); \
+   b4 = ROL64(a[23] ^ d3, 56); \
+   e[15] = b0 ^ (b1 & b2); \
+   e[16] = b1 ^ (b2 | b3); \
+   e[17] = b2 ^ (~b3 | b4); \
+   e[18] = ~b3 ^ (b4 & b0); \
+   e[19] = b4 ^ (b0 | b1); \
+   b0 = ROL64(a[2] ^ d2, 62); \
+   b1 = ROL64(a[8] ^ d3, 55); \
+   b2 = ROL64(a[14] ^ d4, 39); \
+   b3 = ROL64(a[15] ^ d0, 41); \
+   b4 = ROL64(a[21] ^ d1, 2); \
+   e[20] = b0 ^ (~b1 & b2); \
+   e[21] = ~b1 ^ (b2 | b3); \
+   e[22] = b2 ^ (b3 & b4); \
+   e[23] = b3 ^ (b4 | b0); \
+   e[24] = b4 ^ (b0 & b1); \
+}
+
+//SIMD support on x86 targets?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+//Keccak-f[1600] auxiliary functions (AVX2)
+#define KECCAK_AVX2_ROL(x, n) _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - (n)))
+#define KECCAK_AVX2_XOR5(v, w, x, y, z) _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(v, w), _mm256_xor_si256(x, y)), z)
+#define KECCAK_AVX2_CHI(x, y, z) _mm256_xor_si256(x, _mm256_andnot_si256(y, z))
+
+//Keccak-f[1600] round function (AVX2, one state per 64-bit element)
+#define KECCAK_AVX2_ROUND(a, e, rc) \
+{ \
+   c0 = KECCAK_AVX2_XOR5(a[0], a[5], a[10], a[15], a[20]); \
+   c1 = KECCAK_AVX2_XOR5(a[1], a[6], a[11], a[16], a[21]); \
+   c2 = KECCAK_AVX2_XOR5(a[2], a[7], a[12], a[17], a[22]); \
+   c3 = KECCAK_AVX2_XOR5(a[3], a[8], a[13], a[18], a[23]); \
+   c4 = KECCAK_AVX2_XOR5(a[4], a[9], a[14], a[19], a[24]); \
+   d0 = _mm256_xor_si256(c4, KECCAK_AVX2_ROL(c1, 1)); \
+   d1 = _mm256_xor_si256(c0, KECCAK_AVX2_ROL(c2, 1)); \
+   d2 = _mm256_xor_si256(c1, KECCAK_AVX2_ROL(c3, 1)); \
+   d3 = _mm256_xor_si256(c2, KECCAK_AVX2_ROL(c4, 1)); \
+   d4 = _mm256_xor_si256(c3, KECCAK_AVX2_ROL(c0, 1)); \
+   b0 = _mm256_xor_si256(a[0], d0); \
+   b1 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[6], d1), 44); \
+   b2 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[12], d2), 43); \
+   b3 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[18], d3), 21); \
+   b4 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[24], d4), 14); \
+   e[0] = _mm256_xor_si256(KECCAK_AVX2_CHI(b0, b1, b2), rc); \
+   e[1] = KECCAK_AVX2_CHI(b1, b2, b3); \
+   e[2] = KECCAK_AVX2_CHI(b2, b3, b4); \
+   e[3] = KECCAK_AVX2_CHI(b3, b4, b0); \
+   e[4] = KECCAK_AVX2_CHI(b4, b0, b1); \
+   b0 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[3], d3), 28); \
+   b1 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[9], d4), 20); \
+   b2 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[10], d0), 3); \
+   b3 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[16], d1), 45); \
+   b4 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[22], d2), 61); \
+   e[5] = KECCAK_AVX2_CHI(b0, b1, b2); \
+   e[6] = KECCAK_AVX2_CHI(b1, b2, b3); \
+   e[7] = KECCAK_AVX2_CHI(b2, b3, b4); \
+   e[8] = KECCAK_AVX2_CHI(b3, b4, b0); \
+   e[9] = KECCAK_AVX2_CHI(b4, b0, b1); \
+   b0 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[1], d1), 1); \
+   b1 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[7], d2), 6); \
+   b2 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[13], d3), 25); \
+   b3 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[19], d4), 8); \
+   b4 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[20], d0), 18); \
+   e[10] = KECCAK_AVX2_CHI(b0, b1, b2); \
+   e[11] = KECCAK_AVX2_CHI(b1, b2, b3); \
+   e[12] = KECCAK_AVX2_CHI(b2, b3, b4); \
+   e[13] = KECCAK_AVX2_CHI(b3, b4, b0); \
+   e[14] = KECCAK_AVX2_CHI(b4, b0, b1); \
+   b0 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[4], d4), 27); \
+   b1 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[5], d0), 36); \
+   b2 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[11], d1), 10); \
+   b3 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[17], d2), 15); \
+   b4 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[23], d3), 56); \
+   e[15] = KECCAK_AVX2_CHI(b0, b1, b2); \
+   e[16] = KECCAK_AVX2_CHI(b1, b2, b3); \
+   e[17] = KECCAK_AVX2_CHI(b2, b3, b4); \
+   e[18] = KECCAK_AVX2_CHI(b3, b4, b0); \
+   e[19] = KECCAK_AVX2_CHI(b4, b0, b1); \
+   b0 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[2], d2), 62); \
+   b1 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[8], d3), 55); \
+   b2 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[14], d4), 39); \
+   b3 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[15], d0), 41); \
+   b4 = KECCAK_AVX2_ROL(_mm256_xor_si256(a[21], d1), 2); \
+   e[20] = KECCAK_AVX2_CHI(b0, b1, b2); \
+   e[21] = KECCAK_AVX2_CHI(b1, b2, b3); \
+   e[22] = KECCAK_AVX2_CHI(b2, b3, b4); \
+   e[23] = KECCAK_AVX2_CHI(b3, b4, b0); \
+   e[24] = KECCAK_AVX2_CHI(b4, b0, b1); \
+}
+
+#endif
+#endif
+
+
+//Generic implementation (8-bit, 16-bit or 32-bit lanes)?
+#if (KECCAK_L != 6)
 
 /**
  * @brief Apply theta transformation
@@ -274,6 +441,8 @@ static void iota(keccak_lane_t a[5][5], uint_t index)
    a[0][0] ^= rc[index];
 }
 
+#endif
+
 
 /**
  * @brief Initialize Keccak context
@@ -358,12 +527,12 @@ void keccakAbsorb(KeccakContext *context, const void *input, size_t length)
 
 
 /**
- * @brief Finish absorbing phase
+ * @brief Absorb the padded final block
  * @param[in] context Pointer to the Keccak context
  * @param[in] pad Value of the padding byte (0x01 for Keccak, 0x06 for SHA-3 and 0x1F for XOF)
  **/
 
-void keccakFinal(KeccakContext *context, uint8_t pad)
+static void keccakPad(KeccakContext *context, uint8_t pad)
 {
    uint_t i;
    size_t q;
@@ -383,6 +552,25 @@ void keccakFinal(KeccakContext *context, uint8_t pad)
    //Absorb the final block
    for(i = 0; i < context->blockSize / sizeof(keccak_lane_t); i++)
       a[i] ^= KECCAK_LETOH(context->block[i]);
+}
+
+
+/**
+ * @brief Finish absorbing phase
+ * @param[in] context Pointer to the Keccak context
+ * @param[in] pad Value of the padding byte (0x01 for Keccak, 0x06 for SHA-3 and 0x1F for XOF)
+ **/
+
+void keccakFinal(KeccakContext *context, uint8_t pad)
+{
+   uint_t i;
+   keccak_lane_t *a;
+
+   //Point to the state array
+   a = (keccak_lane_t *) context->a;
+
+   //Absorb the padded final block
+   keccakPad(context, pad);
 
    //Apply block permutation function
    keccakPermutBlock(context);
@@ -451,6 +639,123 @@ void keccakSqueeze(KeccakContext *context, uint8_t *output, size_t length)
 }
 
 
+/**
+ * @brief Copy a Keccak context
+ *
+ * The state array, the pending bytes and the counters are copied
+ *
+ * @param[out] destContext Pointer to the destination context
+ * @param[in] srcContext Pointer to the Keccak context to be copied
+ **/
+
+void keccakClone(KeccakContext *destContext, const KeccakContext *srcContext)
+{
+   //Copy the state array
+   memcpy(destContext->a, srcContext->a, sizeof(srcContext->a));
+   //Copy the data that have not been absorbed yet
+   memcpy(destContext->buffer, srcContext->buffer, srcContext->length);
+
+   //Save the block size, in bytes
+   destContext->blockSize = srcContext->blockSize;
+   //Number of bytes in the buffer
+   destContext->length = srcContext->length;
+}
+
+
+/**
+ * @brief Export the state of a Keccak context
+ *
+ * The serialized state is made of the state array (25 little-endian lanes),
+ * the number of pending bytes (big-endian 64-bit integer) and the data that
+ * have not been absorbed yet. This function must be called before the
+ * squeezing phase
+ *
+ * @param[in] context Pointer to the Keccak context
+ * @param[out] output Serialized state
+ * @return Length of the serialized state
+ **/
+
+size_t keccakExportState(const KeccakContext *context, uint8_t *output)
+{
+   uint_t i;
+   keccak_lane_t lane;
+   const keccak_lane_t *a;
+
+   //Point to the state array
+   a = (const keccak_lane_t *) context->a;
+
+   //Convert lanes to little-endian byte order
+   for(i = 0; i < 25; i++)
+   {
+      lane = KECCAK_HTOLE(a[i]);
+      memcpy(output + i * sizeof(keccak_lane_t), &lane, sizeof(keccak_lane_t));
+   }
+
+   //Number of bytes that have not been absorbed yet
+   STORE64BE((uint64_t) context->length, output + KECCAK_B / 8);
+   //Data that have not been absorbed yet
+   memcpy(output + KECCAK_B / 8 + 8, context->buffer, context->length);
+
+   //Return the length of the serialized state
+   return KECCAK_B / 8 + 8 + context->length;
+}
+
+
+/**
+ * @brief Import the state of a Keccak context
+ * @param[out] context Pointer to the Keccak context to initialize
+ * @param[in] capacity Capacity of the sponge function
+ * @param[in] input Serialized state (see keccakExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t keccakImportState(KeccakContext *context, uint_t capacity,
+   const uint8_t *input, size_t length)
+{
+   error_t error;
+   uint_t i;
+   uint64_t n;
+   keccak_lane_t lane;
+   keccak_lane_t *a;
+
+   //Initialize the Keccak context
+   error = keccakInit(context, capacity);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Check the length of the serialized state
+   if(length < (KECCAK_B / 8 + 8))
+      return ERROR_INVALID_LENGTH;
+
+   //Number of bytes that have not been absorbed yet
+   n = LOAD64BE(input + KECCAK_B / 8);
+
+   //The pending bytes cannot fill a complete block
+   if(n >= context->blockSize || length != (KECCAK_B / 8 + 8 + n))
+      return ERROR_INVALID_LENGTH;
+
+   //Point to the state array
+   a = (keccak_lane_t *) context->a;
+
+   //Convert lanes to host byte order
+   for(i = 0; i < 25; i++)
+   {
+      memcpy(&lane, input + i * sizeof(keccak_lane_t), sizeof(keccak_lane_t));
+      a[i] = KECCAK_LETOH(lane);
+   }
+
+   //Data that have not been absorbed yet
+   memcpy(context->buffer, input + KECCAK_B / 8 + 8, (size_t) n);
+   //Number of bytes in the buffer
+   context->length = (size_t) n;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Block permutation
  * @param[in] context Pointer to the Keccak context
@@ -459,7 +764,29 @@ void keccakSqueeze(KeccakContext *context, uint8_t *output, size_t length)
 void keccakPermutBlock(KeccakContext *context)
 {
    uint_t i;
+#if (KECCAK_L == 6)
+   uint64_t b0, b1, b2, b3, b4;
+   uint64_t c0, c1, c2, c3, c4;
+   uint64_t d0, d1, d2, d3, d4;
+   uint64_t *a;
+   uint64_t e[25];
 
+   //Point to the state array
+   a = (uint64_t *) context->a;
+
+   //Complement the relevant lanes
+   KECCAK_COMPLEMENT(a);
+
+   //The rounds alternate between the state array and the temporary array
+   for(i = 0; i < KECCAK_NR; i += 2)
+   {
+      KECCAK_ROUND(a, e, rc[i]);
+      KECCAK_ROUND(e, a, rc[i + 1]);
+   }
+
+   //Restore the complemented lanes
+   KECCAK_COMPLEMENT(a);
+#else
    //Each round consists of a sequence of five transformations,
    //which are called the step mappings
    for(i = 0; i < KECCAK_NR; i++)
@@ -475,6 +802,366 @@ void keccakPermutBlock(KeccakContext *context)
       //Apply iota step mapping
       iota(context->a, i);
    }
+#endif
+}
+
+
+//SIMD support on x86 targets?
+#if (KECCAK_L == 6 && SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+/**
+ * @brief Block permutation of 4 independent states (AVX2)
+ * @param[in] context Pointers to the 4 Keccak contexts
+ **/
+
+CPU_TARGET("avx2") static void keccakAvx2PermutBlockX4(KeccakContext *context[4])
+{
+   uint_t i;
+   uint64_t *s0;
+   uint64_t *s1;
+   uint64_t *s2;
+   uint64_t *s3;
+   __m256i b0, b1, b2, b3, b4;
+   __m256i c0, c1, c2, c3, c4;
+   __m256i d0, d1, d2, d3, d4;
+   __m256i a[25];
+   __m256i e[25];
+
+   //Point to the state arrays
+   s0 = (uint64_t *) context[0]->a;
+   s1 = (uint64_t *) context[1]->a;
+   s2 = (uint64_t *) context[2]->a;
+   s3 = (uint64_t *) context[3]->a;
+
+   //Lane i of state j is stored in the 64-bit element j of a[i]
+   for(i = 0; i < 25; i++)
+      a[i] = _mm256_set_epi64x(s3[i], s2[i], s1[i], s0[i]);
+
+   //The rounds alternate between the state array and the temporary array
+   for(i = 0; i < KECCAK_NR; i += 2)
+   {
+      KECCAK_AVX2_ROUND(a, e, _mm256_set1_epi64x(rc[i]));
+      KECCAK_AVX2_ROUND(e, a, _mm256_set1_epi64x(rc[i + 1]));
+   }
+
+   //Save the updated states
+   for(i = 0; i < 25; i++)
+   {
+      s0[i] = _mm256_extract_epi64(a[i], 0);
+      s1[i] = _mm256_extract_epi64(a[i], 1);
+      s2[i] = _mm256_extract_epi64(a[i], 2);
+      s3[i] = _mm256_extract_epi64(a[i], 3);
+   }
+}
+
+#endif
+
+
+/**
+ * @brief Block permutation of 4 independent states
+ *
+ * When AVX2 instructions are available, the 4 states are advanced in
+ * parallel, one state per 64-bit element of the vector registers. The
+ * contexts must be distinct
+ *
+ * @param[in] context Pointers to the 4 Keccak contexts
+ **/
+
+void keccakPermutBlockX4(KeccakContext *context[4])
+{
+   uint_t i;
+
+#if (KECCAK_L == 6 && SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //Use the 4-way implementation when possible
+   if((cpuGetFeatures() & CPU_FEATURE_AVX2) != 0)
+   {
+      keccakAvx2PermutBlockX4(context);
+      return;
+   }
+#endif
+
+   //Apply block permutation function to each state
+   for(i = 0; i < 4; i++)
+      keccakPermutBlock(context[i]);
+}
+
+
+//SIMD support on x86 targets?
+#if (KECCAK_L == 6 && SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+/**
+ * @brief Instance of the multi-buffer implementation
+ **/
+
+typedef struct
+{
+   KeccakContext context;  ///<Keccak context
+   KeccakMessage *message; ///<Message being processed (NULL if the instance is idle)
+   const uint8_t *input;   ///<Remaining input data
+   size_t inputLen;        ///<Number of input bytes left
+   uint8_t *output;        ///<Remaining output
+   size_t outputLen;       ///<Number of output bytes left
+   bool_t squeezing;       ///<The absorbing phase is complete
+} KeccakInstance;
+
+
+/**
+ * @brief Assign a message to an instance
+ * @param[out] instance Instance of the multi-buffer implementation
+ * @param[in] capacity Capacity of the sponge function
+ * @param[in] message Message to be processed
+ **/
+
+static void keccakStartInstance(KeccakInstance *instance, uint_t capacity,
+   KeccakMessage *message)
+{
+   //Initialize the Keccak context
+   keccakInit(&instance->context, capacity);
+
+   //The complete blocks are absorbed directly from the input
+   instance->message = message;
+   instance->input = message->input;
+   instance->inputLen = message->inputLen;
+   instance->output = message->output;
+   instance->outputLen = message->outputLen;
+   instance->squeezing = FALSE;
+}
+
+
+/**
+ * @brief Prepare the state of an instance for the next permutation
+ * @param[in,out] instance Instance of the multi-buffer implementation
+ * @param[in] pad Value of the padding byte
+ **/
+
+static void keccakFeedInstance(KeccakInstance *instance, uint8_t pad)
+{
+   uint_t i;
+   uint_t n;
+   keccak_lane_t *a;
+
+   //Point to the state array
+   a = (keccak_lane_t *) instance->context.a;
+   //Number of lanes in a block
+   n = instance->context.blockSize / sizeof(keccak_lane_t);
+
+   //Check current phase
+   if(instance->squeezing)
+   {
+      //Convert lanes to host byte order
+      for(i = 0; i < n; i++)
+         a[i] = KECCAK_LETOH(a[i]);
+   }
+   else if(instance->inputLen >= instance->context.blockSize)
+   {
+      //Absorb the current block
+      for(i = 0; i < n; i++)
+         a[i] ^= LOAD64LE(instance->input + i * 8);
+
+      //Advance the data pointer
+      instance->input += instance->context.blockSize;
+      instance->inputLen -= instance->context.blockSize;
+   }
+   else
+   {
+      //Buffer the remaining bytes and absorb the padded final block
+      keccakAbsorb(&instance->context, instance->input, instance->inputLen);
+      keccakPad(&instance->context, pad);
+
+      //The squeezing phase starts after the next permutation
+      instance->inputLen = 0;
+      instance->squeezing = TRUE;
+   }
+}
+
+
+/**
+ * @brief Extract the output of an instance after a permutation
+ * @param[in,out] instance Instance of the multi-buffer implementation
+ **/
+
+static void keccakOutputInstance(KeccakInstance *instance)
+{
+   uint_t i;
+   size_t n;
+   keccak_lane_t *a;
+
+   //Point to the state array
+   a = (keccak_lane_t *) instance->context.a;
+
+   //Convert lanes to little-endian byte order
+   for(i = 0; i < instance->context.blockSize / sizeof(keccak_lane_t); i++)
+      a[i] = KECCAK_HTOLE(a[i]);
+
+   //Compute the number of bytes to process at a time
+   n = MIN(instance->outputLen, instance->context.blockSize);
+
+   //Copy the output string
+   if(instance->output != NULL)
+   {
+      memcpy(instance->output, instance->context.digest, n);
+      instance->output += n;
+   }
+
+   //Number of bytes that remains to be written
+   instance->outputLen -= n;
+   //The output buffer is empty
+   instance->context.length = 0;
+
+   //The instance is idle once the output string is complete
+   if(instance->outputLen == 0)
+      instance->message = NULL;
+}
+
+
+/**
+ * @brief Finish processing the message of an instance with the single-buffer code
+ * @param[in,out] instance Instance of the multi-buffer implementation
+ * @param[in] pad Value of the padding byte
+ **/
+
+static void keccakFinishInstance(KeccakInstance *instance, uint8_t pad)
+{
+   //Absorbing phase not complete?
+   if(!instance->squeezing)
+   {
+      //Absorb the remaining input data
+      keccakAbsorb(&instance->context, instance->input, instance->inputLen);
+      //Finish absorbing phase
+      keccakFinal(&instance->context, pad);
+   }
+
+   //Extract the rest of the output string
+   keccakSqueeze(&instance->context, instance->output, instance->outputLen);
+
+   //The instance is now idle
+   instance->message = NULL;
+}
+
+#endif
+
+
+/**
+ * @brief Process several independent messages with the same sponge function
+ *
+ * When AVX2 instructions are available, 4 messages are processed in
+ * parallel with keccakPermutBlockX4. An instance is refilled with the next
+ * pending message as soon as its output string is complete. The results are
+ * identical to those produced by keccakAbsorb, keccakFinal and keccakSqueeze
+ *
+ * @param[in] capacity Capacity of the sponge function
+ * @param[in] pad Value of the padding byte (0x01 for Keccak, 0x06 for SHA-3 and 0x1F for XOF)
+ * @param[in,out] messages Array of messages
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
+
+error_t keccakComputeMulti(uint_t capacity, uint8_t pad,
+   KeccakMessage *messages, uint_t count)
+{
+   error_t error;
+   uint_t i;
+   KeccakContext context;
+#if (KECCAK_L == 6 && SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   uint_t next;
+   uint_t active;
+   KeccakContext *state[4];
+   KeccakInstance instance[4];
+#endif
+
+   //Check parameters
+   if(messages == NULL && count != 0)
+      return ERROR_INVALID_PARAMETER;
+
+#if (KECCAK_L == 6 && SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //Multi-buffer implementation available?
+   if((cpuGetFeatures() & CPU_FEATURE_AVX2) != 0)
+   {
+      //All the instances are idle
+      for(error = NO_ERROR, i = 0; i < 4 && !error; i++)
+      {
+         error = keccakInit(&instance[i].context, capacity);
+         instance[i].message = NULL;
+         state[i] = &instance[i].context;
+      }
+
+      //Invalid capacity?
+      if(error)
+         return error;
+
+      //Process the messages
+      for(next = 0, active = 0; next < count || active > 0; )
+      {
+         //Assign pending messages to the idle instances
+         for(i = 0; i < 4 && next < count; i++)
+         {
+            if(instance[i].message == NULL)
+            {
+               keccakStartInstance(&instance[i], capacity, &messages[next++]);
+               active++;
+            }
+         }
+
+         //When a single instance remains busy, the single-buffer code is faster
+         if(next >= count && active <= 1)
+         {
+            for(i = 0; i < 4; i++)
+            {
+               if(instance[i].message != NULL)
+                  keccakFinishInstance(&instance[i], pad);
+            }
+
+            //All the messages have been processed
+            break;
+         }
+
+         //Absorb the next block of each busy instance
+         for(i = 0; i < 4; i++)
+         {
+            if(instance[i].message != NULL)
+               keccakFeedInstance(&instance[i], pad);
+         }
+
+         //Apply block permutation function to the 4 states. The results of
+         //the idle instances are discarded
+         keccakAvx2PermutBlockX4(state);
+
+         //Extract the output of the instances in the squeezing phase
+         for(i = 0; i < 4; i++)
+         {
+            if(instance[i].message != NULL && instance[i].squeezing)
+            {
+               keccakOutputInstance(&instance[i]);
+
+               //Output string complete?
+               if(instance[i].message == NULL)
+                  active--;
+            }
+         }
+      }
+
+      //Successful processing
+      return NO_ERROR;
+   }
+#endif
+
+   //Process the messages one after the other
+   for(error = NO_ERROR, i = 0; i < count && !error; i++)
+   {
+      //Initialize the Keccak context
+      error = keccakInit(&context, capacity);
+
+      //Check status code
+      if(!error)
+      {
+         keccakAbsorb(&context, messages[i].input, messages[i].inputLen);
+         keccakFinal(&context, pad);
+         keccakSqueeze(&context, messages[i].output, messages[i].outputLen);
+      }
+   }
+
+   //Return status code
+   return error;
 }
 
 #endif
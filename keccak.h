@@ -96,6 +96,8 @@
 #define KECCAK_SHA3_PAD 0x06
 //XOF padding byte
 #define KECCAK_XOF_PAD 0x1F
+//cSHAKE padding byte
+#define KECCAK_CSHAKE_PAD 0x04
 
 
 /**
@@ -119,12 +121,35 @@ typedef struct
 } KeccakContext;
 
 
+/**
+ * @brief Message descriptor (multi-buffer processing)
+ **/
+
+typedef struct
+{
+   const void *input; ///<Input data
+   size_t inputLen;   ///<Length of the input data
+   uint8_t *output;   ///<Output string
+   size_t outputLen;  ///<Desired output length, in bytes
+} KeccakMessage;
+
+
 //Keccak related functions
 error_t keccakInit(KeccakContext *context, uint_t capacity);
 void keccakAbsorb(KeccakContext *context, const void *input, size_t length);
 void keccakFinal(KeccakContext *context, uint8_t pad);
 void keccakSqueeze(KeccakContext *context, uint8_t *output, size_t length);
+void keccakClone(KeccakContext *destContext, const KeccakContext *srcContext);
+size_t keccakExportState(const KeccakContext *context, uint8_t *output);
+
+error_t keccakImportState(KeccakContext *context, uint_t capacity,
+   const uint8_t *input, size_t length);
+
 void keccakPermutBlock(KeccakContext *context);
+void keccakPermutBlockX4(KeccakContext *context[4]);
+
+error_t keccakComputeMulti(uint_t capacity, uint8_t pad,
+   KeccakMessage *messages, uint_t count);
 
 //C++ guard
 #ifdef __cplusplus
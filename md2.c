@@ -75,10 +75,14 @@ const HashAlgo md2HashAlgo =
    sizeof(Md2Context),
    MD2_BLOCK_SIZE,
    MD2_DIGEST_SIZE,
+   MD2_STATE_SIZE,
    (HashAlgoCompute) md2Compute,
    (HashAlgoInit) md2Init,
    (HashAlgoUpdate) md2Update,
-   (HashAlgoFinal) md2Final
+   (HashAlgoFinal) md2Final,
+   (HashAlgoClone) md2Clone,
+   (HashAlgoExportState) md2ExportState,
+   (HashAlgoImportState) md2ImportState
 };
 
 
@@ -196,6 +200,96 @@ void md2Final(Md2Context *context, uint8_t *digest)
 }
 
 
+/**
+ * @brief Copy an MD2 context
+ *
+ * The intermediate hash value, the checksum and the pending bytes are copied
+ *
+ * @param[out] destContext Pointer to the destination context
+ * @param[in] srcContext Pointer to the MD2 context to be copied
+ **/
+
+void md2Clone(Md2Context *destContext, const Md2Context *srcContext)
+{
+   //Copy the intermediate hash value
+   memcpy(destContext->x, srcContext->x, MD2_DIGEST_SIZE);
+   //Copy the checksum
+   memcpy(destContext->c, srcContext->c, 16);
+   //Copy the data that have not been processed yet
+   memcpy(destContext->m, srcContext->m, srcContext->size);
+
+   //Number of bytes in the buffer
+   destContext->size = srcContext->size;
+}
+
+
+/**
+ * @brief Export the state of an MD2 context
+ *
+ * The serialized state is made of the intermediate hash value (16 bytes),
+ * the checksum (16 bytes), the number of pending bytes (big-endian 64-bit
+ * integer) and the data that have not been processed yet
+ *
+ * @param[in] context Pointer to the MD2 context
+ * @param[out] output Serialized state (at most MD2_STATE_SIZE bytes)
+ * @return Length of the serialized state
+ **/
+
+size_t md2ExportState(const Md2Context *context, uint8_t *output)
+{
+   //Intermediate hash value
+   memcpy(output, context->x, MD2_DIGEST_SIZE);
+   //Checksum
+   memcpy(output + MD2_DIGEST_SIZE, context->c, 16);
+
+   //Number of bytes that have not been processed yet
+   STORE64BE((uint64_t) context->size, output + MD2_DIGEST_SIZE + 16);
+   //Data that have not been processed yet
+   memcpy(output + MD2_DIGEST_SIZE + 24, context->m, context->size);
+
+   //Return the length of the serialized state
+   return MD2_DIGEST_SIZE + 24 + context->size;
+}
+
+
+/**
+ * @brief Import the state of an MD2 context
+ * @param[out] context Pointer to the MD2 context to initialize
+ * @param[in] input Serialized state (see md2ExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t md2ImportState(Md2Context *context, const uint8_t *input, size_t length)
+{
+   uint64_t n;
+
+   //Check the length of the serialized state
+   if(length < (MD2_DIGEST_SIZE + 24))
+      return ERROR_INVALID_LENGTH;
+
+   //Number of bytes that have not been processed yet
+   n = LOAD64BE(input + MD2_DIGEST_SIZE + 16);
+
+   //The pending bytes cannot fill a complete block
+   if(n >= MD2_BLOCK_SIZE || length != (MD2_DIGEST_SIZE + 24 + n))
+      return ERROR_INVALID_LENGTH;
+
+   //Intermediate hash value
+   memcpy(context->x, input, MD2_DIGEST_SIZE);
+   //Checksum
+   memcpy(context->c, input + MD2_DIGEST_SIZE, 16);
+   //Data that have not been processed yet
+   memcpy(context->m, input + MD2_DIGEST_SIZE + 24, (size_t) n);
+
+   //Number of bytes in the buffer
+   context->size = (size_t) n;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Process message in 16-word blocks
  * @param[in] m 16-byte data block to process
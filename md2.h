@@ -36,6 +36,8 @@
 #define MD2_BLOCK_SIZE 16
 //MD2 digest size
 #define MD2_DIGEST_SIZE 16
+//MD2 maximum size of the exported state
+#define MD2_STATE_SIZE (MD2_DIGEST_SIZE + 24 + MD2_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define MD2_HASH_ALGO (&md2HashAlgo)
 
@@ -71,6 +73,9 @@ error_t md2Compute(const void *data, size_t length, uint8_t *digest);
 void md2Init(Md2Context *context);
 void md2Update(Md2Context *context, const void *data, size_t length);
 void md2Final(Md2Context *context, uint8_t *digest);
+void md2Clone(Md2Context *destContext, const Md2Context *srcContext);
+size_t md2ExportState(const Md2Context *context, uint8_t *output);
+error_t md2ImportState(Md2Context *context, const uint8_t *input, size_t length);
 void md2ProcessBlock(const uint8_t *m, uint8_t *x, uint8_t *c);
 
 //C++ guard
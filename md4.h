@@ -36,6 +36,8 @@
 #define MD4_BLOCK_SIZE 64
 //MD4 digest size
 #define MD4_DIGEST_SIZE 16
+//MD4 maximum size of the exported state
+#define MD4_STATE_SIZE (MD4_DIGEST_SIZE + 8 + MD4_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define MD4_HASH_ALGO (&md4HashAlgo)
 
@@ -74,6 +76,9 @@ error_t md4Compute(const void *data, size_t length, uint8_t *digest);
 void md4Init(Md4Context *context);
 void md4Update(Md4Context *context, const void *data, size_t length);
 void md4Final(Md4Context *context, uint8_t *digest);
+void md4Clone(Md4Context *destContext, const Md4Context *srcContext);
+size_t md4ExportState(const Md4Context *context, uint8_t *output);
+error_t md4ImportState(Md4Context *context, const uint8_t *input, size_t length);
 void md4ProcessBlock(Md4Context *context);
 
 //C++ guard
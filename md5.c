@@ -87,10 +87,14 @@ const HashAlgo md5HashAlgo =
    sizeof(Md5Context),
    MD5_BLOCK_SIZE,
    MD5_DIGEST_SIZE,
+   MD5_STATE_SIZE,
    (HashAlgoCompute) md5Compute,
    (HashAlgoInit) md5Init,
    (HashAlgoUpdate) md5Update,
-   (HashAlgoFinal) md5Final
+   (HashAlgoFinal) md5Final,
+   (HashAlgoClone) md5Clone,
+   (HashAlgoExportState) md5ExportState,
+   (HashAlgoImportState) md5ImportState
 };
 
 
@@ -225,6 +229,103 @@ void md5Final(Md5Context *context, uint8_t *digest)
 }
 
 
+/**
+ * @brief Copy a MD5 context
+ *
+ * The intermediate hash value, the counters and the pending bytes are copied
+ *
+ * @param[out] destContext Pointer to the destination context
+ * @param[in] srcContext Pointer to the MD5 context to be copied
+ **/
+
+void md5Clone(Md5Context *destContext, const Md5Context *srcContext)
+{
+   //Copy the intermediate hash value
+   memcpy(destContext->h, srcContext->h, sizeof(srcContext->h));
+   //Copy the data that have not been processed yet
+   memcpy(destContext->buffer, srcContext->buffer, srcContext->size);
+
+   //Number of bytes in the buffer
+   destContext->size = srcContext->size;
+   //Total length of the message
+   destContext->totalSize = srcContext->totalSize;
+}
+
+
+/**
+ * @brief Export the state of a MD5 context
+ *
+ * The serialized state is made of the intermediate hash value (four
+ * little-endian 32-bit words), the total length of the message (big-endian
+ * 64-bit integer, in bytes) and the data that have not been processed yet
+ *
+ * @param[in] context Pointer to the MD5 context
+ * @param[out] output Serialized state (at most MD5_STATE_SIZE bytes)
+ * @return Length of the serialized state
+ **/
+
+size_t md5ExportState(const Md5Context *context, uint8_t *output)
+{
+   uint_t i;
+
+   //Intermediate hash value
+   for(i = 0; i < 4; i++)
+      STORE32LE(context->h[i], output + i * 4);
+
+   //Total length of the message
+   STORE64BE(context->totalSize, output + MD5_DIGEST_SIZE);
+   //Data that have not been processed yet
+   memcpy(output + MD5_DIGEST_SIZE + 8, context->buffer, context->size);
+
+   //Return the length of the serialized state
+   return MD5_DIGEST_SIZE + 8 + context->size;
+}
+
+
+/**
+ * @brief Import the state of a MD5 context
+ * @param[out] context Pointer to the MD5 context to initialize
+ * @param[in] input Serialized state (see md5ExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t md5ImportState(Md5Context *context, const uint8_t *input, size_t length)
+{
+   uint_t i;
+   size_t n;
+   uint64_t totalSize;
+
+   //Check the length of the serialized state
+   if(length < (MD5_DIGEST_SIZE + 8))
+      return ERROR_INVALID_LENGTH;
+
+   //Total length of the message
+   totalSize = LOAD64BE(input + MD5_DIGEST_SIZE);
+   //Number of bytes that have not been processed yet
+   n = (size_t) (totalSize % MD5_BLOCK_SIZE);
+
+   //The pending bytes must match the length of the message
+   if(length != (MD5_DIGEST_SIZE + 8 + n))
+      return ERROR_INVALID_LENGTH;
+
+   //Intermediate hash value
+   for(i = 0; i < 4; i++)
+      context->h[i] = LOAD32LE(input + i * 4);
+
+   //Data that have not been processed yet
+   memcpy(context->buffer, input + MD5_DIGEST_SIZE + 8, n);
+
+   //Number of bytes in the buffer
+   context->size = n;
+   //Total length of the message
+   context->totalSize = totalSize;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Process message in 16-word blocks
  * @param[in] context Pointer to the MD5 context
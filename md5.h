@@ -36,6 +36,8 @@
 #define MD5_BLOCK_SIZE 64
 //MD5 digest size
 #define MD5_DIGEST_SIZE 16
+//MD5 maximum size of the exported state
+#define MD5_STATE_SIZE (MD5_DIGEST_SIZE + 8 + MD5_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define MD5_HASH_ALGO (&md5HashAlgo)
 
@@ -74,6 +76,9 @@ error_t md5Compute(const void *data, size_t length, uint8_t *digest);
 void md5Init(Md5Context *context);
 void md5Update(Md5Context *context, const void *data, size_t length);
 void md5Final(Md5Context *context, uint8_t *digest);
+void md5Clone(Md5Context *destContext, const Md5Context *srcContext);
+size_t md5ExportState(const Md5Context *context, uint8_t *output);
+error_t md5ImportState(Md5Context *context, const uint8_t *input, size_t length);
 void md5ProcessBlock(Md5Context *context);
 
 //C++ guard
@@ -0,0 +1,504 @@
+/**
+ * @file parallel_hash.c
+ * @brief ParallelHash function (SP 800-185)
+ *
+ * @section License
+ *
+ * Copyright (C) 2010-2017 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneCrypto Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * ParallelHash splits the input into leaves of B bytes. Each leaf is
+ * digested independently with SHAKE, and the resulting chaining values are
+ * combined by a final cSHAKE invocation. Complete leaves are processed
+ * several at a time with the multi-buffer Keccak implementation. Refer to
+ * SP 800-185 for more details
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 1.7.8
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL CRYPTO_TRACE_LEVEL
+
+//Dependencies
+#include <string.h>
+#include "crypto.h"
+#include "parallel_hash.h"
+
+//Check crypto library configuration
+#if (PARALLEL_HASH_SUPPORT == ENABLED)
+
+//Maximum number of complete leaves processed at a time
+#define PARALLEL_HASH_MAX_LEAVES 8
+
+//Function name (N parameter of cSHAKE)
+static const char_t parallelHashName[] = "ParallelHash";
+
+
+/**
+ * @brief Encode an integer as a byte string (left_encode function)
+ * @param[in] value Integer to be encoded
+ * @param[out] output Byte string (at most 9 bytes)
+ * @return Length of the byte string
+ **/
+
+static size_t parallelHashLeftEncode(uint64_t value, uint8_t *output)
+{
+   uint_t i;
+   uint_t n;
+
+   //Number of bytes needed to represent the integer (at least one)
+   for(n = 1; n < 8 && (value >> (n * 8)) != 0; n++);
+
+   //The length is encoded before the integer
+   output[0] = (uint8_t) n;
+
+   //Big-endian representation of the integer
+   for(i = 0; i < n; i++)
+      output[i + 1] = (uint8_t) (value >> ((n - i - 1) * 8));
+
+   //Return the length of the byte string
+   return n + 1;
+}
+
+
+/**
+ * @brief Encode an integer as a byte string (right_encode function)
+ * @param[in] value Integer to be encoded
+ * @param[out] output Byte string (at most 9 bytes)
+ * @return Length of the byte string
+ **/
+
+static size_t parallelHashRightEncode(uint64_t value, uint8_t *output)
+{
+   uint_t i;
+   uint_t n;
+
+   //Number of bytes needed to represent the integer (at least one)
+   for(n = 1; n < 8 && (value >> (n * 8)) != 0; n++);
+
+   //Big-endian representation of the integer
+   for(i = 0; i < n; i++)
+      output[i] = (uint8_t) (value >> ((n - i - 1) * 8));
+
+   //The length is encoded after the integer
+   output[n] = (uint8_t) n;
+
+   //Return the length of the byte string
+   return n + 1;
+}
+
+
+/**
+ * @brief Digest the current leaf and absorb its chaining value
+ * @param[in] context Pointer to the ParallelHash context
+ **/
+
+static void parallelHashFinishLeaf(ParallelHashContext *context)
+{
+   uint8_t cv[64];
+
+   //The leaves are digested with SHAKE (cSHAKE with empty N and S)
+   keccakFinal(&context->leafContext, KECCAK_XOF_PAD);
+   keccakSqueeze(&context->leafContext, cv, context->cvSize);
+
+   //Absorb the chaining value
+   keccakAbsorb(&context->keccakContext, cv, context->cvSize);
+
+   //Prepare the next leaf
+   keccakInit(&context->leafContext, 2 * context->strength);
+   context->leafLen = 0;
+   context->numLeaves++;
+}
+
+
+/**
+ * @brief Digest complete leaves in parallel
+ * @param[in] strength Security strength, in bits (128 or 256)
+ * @param[in] input Pointer to the leaves
+ * @param[in] blockSize Size of the leaves, in bytes
+ * @param[in] n Number of leaves (at most PARALLEL_HASH_MAX_LEAVES)
+ * @param[out] cv Chaining values
+ **/
+
+static void parallelHashDigestLeaves(uint_t strength, const uint8_t *input,
+   size_t blockSize, size_t n, uint8_t *cv)
+{
+   uint_t i;
+   KeccakMessage leaves[PARALLEL_HASH_MAX_LEAVES];
+
+   //Describe the leaves
+   for(i = 0; i < n; i++)
+   {
+      leaves[i].input = input + i * blockSize;
+      leaves[i].inputLen = blockSize;
+      leaves[i].output = cv + i * (strength / 4);
+      leaves[i].outputLen = strength / 4;
+   }
+
+   //The leaves are digested with SHAKE (cSHAKE with empty N and S)
+   keccakComputeMulti(2 * strength, KECCAK_XOF_PAD, leaves, n);
+}
+
+
+/**
+ * @brief Compute ParallelHash
+ * @param[in] strength Security strength, in bits (128 or 256)
+ * @param[in] input Pointer to the input data
+ * @param[in] inputLen Length of the input data
+ * @param[in] blockSize Size of the leaves, in bytes
+ * @param[in] custom Customization string (S)
+ * @param[in] customLen Length of the customization string
+ * @param[out] output Pointer to the output data
+ * @param[in] outputLen Expected length of the output data
+ * @return Error code
+ **/
+
+static error_t parallelHashCompute(uint_t strength, const void *input,
+   size_t inputLen, size_t blockSize, const void *custom, size_t customLen,
+   uint8_t *output, size_t outputLen)
+{
+   error_t error;
+   ParallelHashContext *context;
+
+   //Allocate a memory buffer to hold the ParallelHash context
+   context = cryptoAllocMem(sizeof(ParallelHashContext));
+   //Failed to allocate memory?
+   if(context == NULL)
+      return ERROR_OUT_OF_MEMORY;
+
+   //Initialize the ParallelHash context
+   error = parallelHashInit(context, strength, blockSize, custom, customLen);
+
+   //Check status code
+   if(!error)
+   {
+      //Absorb input data
+      parallelHashAbsorb(context, input, inputLen);
+      //Finish absorbing phase
+      parallelHashFinal(context, outputLen);
+      //Extract data from the squeezing phase
+      parallelHashSqueeze(context, output, outputLen);
+   }
+
+   //Free previously allocated memory
+   cryptoFreeMem(context);
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Compute ParallelHash128
+ * @param[in] input Pointer to the input data
+ * @param[in] inputLen Length of the input data
+ * @param[in] blockSize Size of the leaves, in bytes
+ * @param[in] custom Customization string (S)
+ * @param[in] customLen Length of the customization string
+ * @param[out] output Pointer to the output data
+ * @param[in] outputLen Expected length of the output data
+ * @return Error code
+ **/
+
+error_t parallelHash128Compute(const void *input, size_t inputLen,
+   size_t blockSize, const void *custom, size_t customLen,
+   uint8_t *output, size_t outputLen)
+{
+   //ParallelHash128 supports 128 bits of security strength
+   return parallelHashCompute(128, input, inputLen, blockSize, custom,
+      customLen, output, outputLen);
+}
+
+
+/**
+ * @brief Compute ParallelHash256
+ * @param[in] input Pointer to the input data
+ * @param[in] inputLen Length of the input data
+ * @param[in] blockSize Size of the leaves, in bytes
+ * @param[in] custom Customization string (S)
+ * @param[in] customLen Length of the customization string
+ * @param[out] output Pointer to the output data
+ * @param[in] outputLen Expected length of the output data
+ * @return Error code
+ **/
+
+error_t parallelHash256Compute(const void *input, size_t inputLen,
+   size_t blockSize, const void *custom, size_t customLen,
+   uint8_t *output, size_t outputLen)
+{
+   //ParallelHash256 supports 256 bits of security strength
+   return parallelHashCompute(256, input, inputLen, blockSize, custom,
+      customLen, output, outputLen);
+}
+
+
+/**
+ * @brief Initialize ParallelHash context
+ * @param[in] context Pointer to the ParallelHash context to initialize
+ * @param[in] strength Security strength, in bits (128 or 256)
+ * @param[in] blockSize Size of the leaves, in bytes
+ * @param[in] custom Customization string (S)
+ * @param[in] customLen Length of the customization string
+ * @return Error code
+ **/
+
+error_t parallelHashInit(ParallelHashContext *context, uint_t strength,
+   size_t blockSize, const void *custom, size_t customLen)
+{
+   error_t error;
+   size_t n;
+   uint8_t buffer[9];
+
+   //Check parameters
+   if(context == NULL || blockSize == 0 || (custom == NULL && customLen != 0))
+      return ERROR_INVALID_PARAMETER;
+
+   //Only ParallelHash128 and ParallelHash256 are defined
+   if(strength != 128 && strength != 256)
+      return ERROR_INVALID_PARAMETER;
+
+   //The chaining values are 2 * strength bits long
+   context->strength = strength;
+   context->cvSize = strength / 4;
+   context->blockSize = blockSize;
+   context->leafLen = 0;
+   context->numLeaves = 0;
+
+   //The capacity of the sponge is twice the security strength
+   error = keccakInit(&context->keccakContext, 2 * strength);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Initialize the sponge of the first leaf
+   error = keccakInit(&context->leafContext, 2 * strength);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //The cSHAKE prefix is bytepad(encode_string(N) || encode_string(S), rate)
+   n = parallelHashLeftEncode(context->keccakContext.blockSize, buffer);
+   keccakAbsorb(&context->keccakContext, buffer, n);
+
+   //Encode the function name
+   n = parallelHashLeftEncode((sizeof(parallelHashName) - 1) * 8, buffer);
+   keccakAbsorb(&context->keccakContext, buffer, n);
+   keccakAbsorb(&context->keccakContext, parallelHashName, sizeof(parallelHashName) - 1);
+
+   //Encode the customization string
+   n = parallelHashLeftEncode((uint64_t) customLen * 8, buffer);
+   keccakAbsorb(&context->keccakContext, buffer, n);
+   keccakAbsorb(&context->keccakContext, custom, customLen);
+
+   //Pad the prefix with zeros to a multiple of the rate
+   memset(buffer, 0, sizeof(buffer));
+
+   while(context->keccakContext.length != 0)
+   {
+      n = MIN(sizeof(buffer), context->keccakContext.blockSize -
+         context->keccakContext.length);
+
+      keccakAbsorb(&context->keccakContext, buffer, n);
+   }
+
+   //The input of the final node starts with left_encode(B)
+   n = parallelHashLeftEncode(blockSize, buffer);
+   keccakAbsorb(&context->keccakContext, buffer, n);
+
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Absorb data
+ * @param[in] context Pointer to the ParallelHash context
+ * @param[in] input Pointer to the buffer being hashed
+ * @param[in] length Length of the buffer
+ **/
+
+void parallelHashAbsorb(ParallelHashContext *context, const void *input,
+   size_t length)
+{
+   size_t n;
+   uint8_t cv[PARALLEL_HASH_MAX_LEAVES * 64];
+
+   //Process the incoming data
+   while(length > 0)
+   {
+      //Complete leaves are processed directly from the input
+      if(context->leafLen == 0 && length >= context->blockSize)
+      {
+         //Limit the number of leaves to process at a time
+         n = MIN(length / context->blockSize, PARALLEL_HASH_MAX_LEAVES);
+
+         //Digest the leaves and absorb the chaining values
+         parallelHashDigestLeaves(context->strength, input,
+            context->blockSize, n, cv);
+
+         keccakAbsorb(&context->keccakContext, cv, n * context->cvSize);
+         context->numLeaves += n;
+
+         //Number of bytes consumed
+         n *= context->blockSize;
+      }
+      else
+      {
+         //Fill the current leaf
+         n = MIN(length, context->blockSize - context->leafLen);
+         keccakAbsorb(&context->leafContext, input, n);
+         context->leafLen += n;
+
+         //Complete leaf?
+         if(context->leafLen == context->blockSize)
+            parallelHashFinishLeaf(context);
+      }
+
+      //Advance the data pointer
+      input = (uint8_t *) input + n;
+      //Remaining bytes to process
+      length -= n;
+   }
+}
+
+
+/**
+ * @brief Digest a range of complete leaves
+ *
+ * The leaves are independent, so disjoint ranges of a large input may be
+ * digested concurrently (one range per thread, for instance). The chaining
+ * values are then absorbed in order with parallelHashAbsorbLeaves
+ *
+ * @param[in] strength Security strength, in bits (128 or 256)
+ * @param[in] input Pointer to the leaves
+ * @param[in] inputLen Length of the leaves (multiple of the leaf size)
+ * @param[in] blockSize Size of the leaves, in bytes
+ * @param[out] cv Chaining values (strength / 4 bytes per leaf)
+ * @return Error code
+ **/
+
+error_t parallelHashComputeLeaves(uint_t strength, const void *input,
+   size_t inputLen, size_t blockSize, uint8_t *cv)
+{
+   size_t n;
+
+   //Check parameters
+   if(((input == NULL || cv == NULL) && inputLen != 0) || blockSize == 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //Only ParallelHash128 and ParallelHash256 are defined
+   if(strength != 128 && strength != 256)
+      return ERROR_INVALID_PARAMETER;
+
+   //The input must consist of complete leaves
+   if((inputLen % blockSize) != 0)
+      return ERROR_INVALID_LENGTH;
+
+   //Process the leaves
+   while(inputLen > 0)
+   {
+      //Limit the number of leaves to process at a time
+      n = MIN(inputLen / blockSize, PARALLEL_HASH_MAX_LEAVES);
+
+      //Digest the leaves
+      parallelHashDigestLeaves(strength, input, blockSize, n, cv);
+
+      //Advance the data pointers
+      input = (uint8_t *) input + n * blockSize;
+      inputLen -= n * blockSize;
+      cv += n * (strength / 4);
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Absorb the chaining values of complete leaves
+ * @param[in] context Pointer to the ParallelHash context
+ * @param[in] cv Chaining values computed by parallelHashComputeLeaves
+ * @param[in] numLeaves Number of leaves
+ * @return Error code
+ **/
+
+error_t parallelHashAbsorbLeaves(ParallelHashContext *context,
+   const uint8_t *cv, size_t numLeaves)
+{
+   //Check parameters
+   if(context == NULL || (cv == NULL && numLeaves != 0))
+      return ERROR_INVALID_PARAMETER;
+
+   //The chaining values can only be absorbed at a leaf boundary
+   if(context->leafLen != 0)
+      return ERROR_WRONG_STATE;
+
+   //Absorb the chaining values
+   keccakAbsorb(&context->keccakContext, cv, numLeaves * context->cvSize);
+   context->numLeaves += numLeaves;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Finish absorbing phase
+ * @param[in] context Pointer to the ParallelHash context
+ * @param[in] outputLen Desired output length, in bytes (0 for ParallelHashXOF)
+ **/
+
+void parallelHashFinal(ParallelHashContext *context, size_t outputLen)
+{
+   size_t n;
+   uint8_t buffer[9];
+
+   //The last leaf may be shorter than B bytes
+   if(context->leafLen > 0)
+      parallelHashFinishLeaf(context);
+
+   //Append the number of leaves
+   n = parallelHashRightEncode(context->numLeaves, buffer);
+   keccakAbsorb(&context->keccakContext, buffer, n);
+
+   //Append the output length, in bits
+   n = parallelHashRightEncode((uint64_t) outputLen * 8, buffer);
+   keccakAbsorb(&context->keccakContext, buffer, n);
+
+   //Finish absorbing phase (padding byte is 0x04 for cSHAKE)
+   keccakFinal(&context->keccakContext, KECCAK_CSHAKE_PAD);
+}
+
+
+/**
+ * @brief Extract data from the squeezing phase
+ * @param[in] context Pointer to the ParallelHash context
+ * @param[out] output Output string
+ * @param[in] length Desired output length, in bytes
+ **/
+
+void parallelHashSqueeze(ParallelHashContext *context, uint8_t *output,
+   size_t length)
+{
+   //Extract data from the squeezing phase
+   keccakSqueeze(&context->keccakContext, output, length);
+}
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file parallel_hash.h
+ * @brief ParallelHash function (SP 800-185)
+ *
+ * @section License
+ *
+ * Copyright (C) 2010-2017 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneCrypto Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 1.7.8
+ **/
+
+#ifndef _PARALLEL_HASH_H
+#define _PARALLEL_HASH_H
+
+//Dependencies
+#include "crypto.h"
+#include "keccak.h"
+
+//C++ guard
+#ifdef __cplusplus
+   extern "C" {
+#endif
+
+
+/**
+ * @brief ParallelHash context
+ **/
+
+typedef struct
+{
+   KeccakContext keccakContext; ///<Final node (cSHAKE)
+   KeccakContext leafContext;   ///<Current leaf (SHAKE)
+   uint_t strength;             ///<Security strength, in bits
+   uint_t cvSize;               ///<Size of the chaining values, in bytes
+   size_t blockSize;            ///<Size of the leaves, in bytes
+   size_t leafLen;              ///<Number of bytes in the current leaf
+   uint64_t numLeaves;          ///<Number of leaves processed so far
+} ParallelHashContext;
+
+
+//ParallelHash related functions
+error_t parallelHash128Compute(const void *input, size_t inputLen,
+   size_t blockSize, const void *custom, size_t customLen,
+   uint8_t *output, size_t outputLen);
+
+error_t parallelHash256Compute(const void *input, size_t inputLen,
+   size_t blockSize, const void *custom, size_t customLen,
+   uint8_t *output, size_t outputLen);
+
+error_t parallelHashInit(ParallelHashContext *context, uint_t strength,
+   size_t blockSize, const void *custom, size_t customLen);
+
+void parallelHashAbsorb(ParallelHashContext *context, const void *input,
+   size_t length);
+
+error_t parallelHashComputeLeaves(uint_t strength, const void *input,
+   size_t inputLen, size_t blockSize, uint8_t *cv);
+
+error_t parallelHashAbsorbLeaves(ParallelHashContext *context,
+   const uint8_t *cv, size_t numLeaves);
+
+void parallelHashFinal(ParallelHashContext *context, size_t outputLen);
+
+void parallelHashSqueeze(ParallelHashContext *context, uint8_t *output,
+   size_t length);
+
+//C++ guard
+#ifdef __cplusplus
+   }
+#endif
+
+#endif
@@ -44,6 +44,48 @@ const uint8_t PKCS5_OID[8] = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x05};
 const uint8_t PBKDF2_OID[9] = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x05, 0x0C};
 
 
+/**
+ * @brief PBKDF2 slot (block of a derived key being computed)
+ **/
+
+typedef struct
+{
+   Pbkdf2Job *job;                  ///<Job being processed (NULL if the slot is idle)
+   uint32_t i;                      ///<Index of the block
+   uint_t remaining;                ///<Number of iterations left
+   HmacKey hmacKey;                 ///<Precomputed HMAC key
+   uint8_t u[MAX_HASH_DIGEST_SIZE]; ///<U(j)
+   uint8_t t[MAX_HASH_DIGEST_SIZE]; ///<T = U(1) xor U(2) xor ... xor U(j)
+   union
+   {
+      HmacContext hmacContext;
+#if (SHA1_SUPPORT == ENABLED)
+      Sha1Context sha1Context;
+#endif
+#if (SHA224_SUPPORT == ENABLED || SHA256_SUPPORT == ENABLED)
+      Sha256Context sha256Context;
+#endif
+#if (SHA384_SUPPORT == ENABLED || SHA512_SUPPORT == ENABLED)
+      Sha512Context sha512Context;
+#endif
+   };
+} Pbkdf2Slot;
+
+
+/**
+ * @brief PBKDF2 workspace
+ **/
+
+typedef struct
+{
+   const HashAlgo *hash;                 ///<Hash algorithm used by the underlying PRF
+   uint8_t pad[MAX_HASH_BLOCK_SIZE];     ///<Padding of a digest-sized message
+   Pbkdf2Slot *active[PBKDF2_MAX_SLOTS]; ///<Busy slots
+   uint_t numSlots;                      ///<Number of slots
+   Pbkdf2Slot slot[1];                   ///<Blocks being computed (numSlots entries)
+} Pbkdf2Workspace;
+
+
 /**
  * @brief PBKDF1 key derivation function
  *
@@ -116,12 +158,574 @@ error_t pbkdf1(const HashAlgo *hash, const uint8_t *p, size_t pLen,
 }
 
 
+/**
+ * @brief Allocate a PBKDF2 workspace
+ * @param[in] numSlots Number of slots (1 to PBKDF2_MAX_SLOTS)
+ * @return Pointer to the workspace (NULL if memory allocation failed)
+ **/
+
+static Pbkdf2Workspace *pbkdf2AllocWorkspace(uint_t numSlots)
+{
+   Pbkdf2Workspace *workspace;
+
+   //The slots are stored at the end of the workspace
+   workspace = cryptoAllocMem(sizeof(Pbkdf2Workspace) +
+      (numSlots - 1) * sizeof(Pbkdf2Slot));
+
+   //Successful memory allocation?
+   if(workspace != NULL)
+      workspace->numSlots = numSlots;
+
+   //Return a pointer to the workspace
+   return workspace;
+}
+
+
+/**
+ * @brief Release a PBKDF2 workspace
+ * @param[in] workspace PBKDF2 workspace
+ **/
+
+static void pbkdf2FreeWorkspace(Pbkdf2Workspace *workspace)
+{
+   //Clear the precomputed keys before freeing memory
+   memset(workspace, 0, sizeof(Pbkdf2Workspace) +
+      (workspace->numSlots - 1) * sizeof(Pbkdf2Slot));
+
+   //Free previously allocated memory
+   cryptoFreeMem(workspace);
+}
+
+
+/**
+ * @brief Check the parameters of a PBKDF2 job
+ * @param[in] job PBKDF2 job
+ * @return Error code
+ **/
+
+static error_t pbkdf2CheckJob(const Pbkdf2Job *job)
+{
+   //Iteration count must be a positive integer
+   if(job->c < 1)
+      return ERROR_INVALID_PARAMETER;
+
+   //Check password, salt and derived key
+   if(job->p == NULL && job->pLen != 0)
+      return ERROR_INVALID_PARAMETER;
+   if(job->s == NULL && job->sLen != 0)
+      return ERROR_INVALID_PARAMETER;
+   if(job->dk == NULL && job->dkLen != 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //The job parameters are valid
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Assign a block of the derived key to a slot
+ *
+ * The password is processed once per job: the slots computing the other
+ * blocks of the same job reuse the precomputed HMAC key
+ *
+ * @param[in] workspace PBKDF2 workspace
+ * @param[out] slot Idle slot
+ * @param[in] job PBKDF2 job
+ * @param[in] i Index of the block
+ * @param[in] prev Slot the previous block was assigned to (or NULL)
+ **/
+
+static void pbkdf2StartSlot(Pbkdf2Workspace *workspace, Pbkdf2Slot *slot,
+   Pbkdf2Job *job, uint32_t i, const Pbkdf2Slot *prev)
+{
+   uint8_t a[4];
+
+   //Precompute the HMAC key, unless the previous slot already holds it
+   if(prev == NULL || prev->job != job)
+      hmacKeyInit(&slot->hmacKey, workspace->hash, job->p, job->pLen);
+   else if(prev != slot)
+      memcpy(&slot->hmacKey, &prev->hmacKey, sizeof(HmacKey));
+
+   //Calculate the 4-octet encoding of the integer i (MSB first)
+   STORE32BE(i, a);
+
+   //Compute U1 = PRF(P, S || INT(i))
+   hmacInitFromKey(&slot->hmacContext, &slot->hmacKey);
+   hmacUpdate(&slot->hmacContext, job->s, job->sLen);
+   hmacUpdate(&slot->hmacContext, a, 4);
+   hmacFinal(&slot->hmacContext, slot->u);
+
+   //Save the resulting HMAC value
+   memcpy(slot->t, slot->u, workspace->hash->digestSize);
+
+   //The slot is now busy
+   slot->job = job;
+   slot->i = i;
+   slot->remaining = job->c - 1;
+}
+
+
+#if (SHA1_SUPPORT == ENABLED)
+
+/**
+ * @brief Perform one iteration in each busy slot (SHA-1)
+ *
+ * Each iteration boils down to two compression function calls, since
+ * the inner and outer hashes resume from the precomputed midstates and
+ * digest a single padded block holding the previous PRF output. The
+ * compression function calls of the busy slots run in the lanes of the
+ * multi-buffer implementation
+ *
+ * @param[in] workspace PBKDF2 workspace
+ * @param[in] n Number of busy slots
+ **/
+
+static void pbkdf2Sha1Step(Pbkdf2Workspace *workspace, uint_t n)
+{
+   uint_t i;
+   uint_t k;
+   Pbkdf2Slot *slot;
+   const Sha1Context *inner;
+   const Sha1Context *outer;
+   Sha1Context *context[PBKDF2_MAX_SLOTS];
+
+   //Compute H(K xor ipad || U(j-1))
+   for(k = 0; k < n; k++)
+   {
+      slot = workspace->active[k];
+      context[k] = &slot->sha1Context;
+      inner = (const Sha1Context *) slot->hmacKey.innerContext;
+
+      memcpy(context[k]->h, inner->h, 20);
+      memcpy(context[k]->buffer, slot->u, 20);
+      memcpy(context[k]->buffer + 20, workspace->pad + 20, 64 - 20);
+   }
+
+   sha1ProcessBlockMulti(context, n);
+
+   //Compute U(j) = H(K xor opad || H(K xor ipad || U(j-1)))
+   for(k = 0; k < n; k++)
+   {
+      slot = workspace->active[k];
+      outer = (const Sha1Context *) slot->hmacKey.outerContext;
+
+      for(i = 0; i < 5; i++)
+         STORE32BE(context[k]->h[i], context[k]->buffer + i * 4);
+
+      memcpy(context[k]->h, outer->h, 20);
+      memcpy(context[k]->buffer + 20, workspace->pad + 20, 64 - 20);
+   }
+
+   sha1ProcessBlockMulti(context, n);
+
+   //Compute T = U(1) xor U(2) xor ... xor U(j)
+   for(k = 0; k < n; k++)
+   {
+      slot = workspace->active[k];
+
+      for(i = 0; i < 5; i++)
+         STORE32BE(context[k]->h[i], slot->u + i * 4);
+
+      for(i = 0; i < 20; i++)
+         slot->t[i] ^= slot->u[i];
+   }
+}
+
+#endif
+#if (SHA224_SUPPORT == ENABLED || SHA256_SUPPORT == ENABLED)
+
+/**
+ * @brief Perform one iteration in each busy slot (SHA-224 or SHA-256)
+ * @param[in] workspace PBKDF2 workspace
+ * @param[in] n Number of busy slots
+ **/
+
+static void pbkdf2Sha256Step(Pbkdf2Workspace *workspace, uint_t n)
+{
+   uint_t i;
+   uint_t k;
+   size_t digestSize;
+   Pbkdf2Slot *slot;
+   const Sha256Context *inner;
+   const Sha256Context *outer;
+   Sha256Context *context[PBKDF2_MAX_SLOTS];
+
+   //Size of the PRF output
+   digestSize = workspace->hash->digestSize;
+
+   //Compute H(K xor ipad || U(j-1))
+   for(k = 0; k < n; k++)
+   {
+      slot = workspace->active[k];
+      context[k] = &slot->sha256Context;
+      inner = (const Sha256Context *) slot->hmacKey.innerContext;
+
+      memcpy(context[k]->h, inner->h, 32);
+      memcpy(context[k]->buffer, slot->u, digestSize);
+      memcpy(context[k]->buffer + digestSize, workspace->pad + digestSize,
+         64 - digestSize);
+   }
+
+   sha256ProcessBlockMulti(context, n);
+
+   //Compute U(j) = H(K xor opad || H(K xor ipad || U(j-1)))
+   for(k = 0; k < n; k++)
+   {
+      slot = workspace->active[k];
+      outer = (const Sha256Context *) slot->hmacKey.outerContext;
+
+      for(i = 0; i < digestSize / 4; i++)
+         STORE32BE(context[k]->h[i], context[k]->buffer + i * 4);
+
+      memcpy(context[k]->h, outer->h, 32);
+      memcpy(context[k]->buffer + digestSize, workspace->pad + digestSize,
+         64 - digestSize);
+   }
+
+   sha256ProcessBlockMulti(context, n);
+
+   //Compute T = U(1) xor U(2) xor ... xor U(j)
+   for(k = 0; k < n; k++)
+   {
+      slot = workspace->active[k];
+
+      for(i = 0; i < digestSize / 4; i++)
+         STORE32BE(context[k]->h[i], slot->u + i * 4);
+
+      for(i = 0; i < digestSize; i++)
+         slot->t[i] ^= slot->u[i];
+   }
+}
+
+#endif
+#if (SHA384_SUPPORT == ENABLED || SHA512_SUPPORT == ENABLED)
+
+/**
+ * @brief Perform one iteration in each busy slot (SHA-384 or SHA-512)
+ * @param[in] workspace PBKDF2 workspace
+ * @param[in] n Number of busy slots
+ **/
+
+static void pbkdf2Sha512Step(Pbkdf2Workspace *workspace, uint_t n)
+{
+   uint_t i;
+   uint_t k;
+   size_t digestSize;
+   Pbkdf2Slot *slot;
+   const Sha512Context *inner;
+   const Sha512Context *outer;
+   Sha512Context *context[PBKDF2_MAX_SLOTS];
+
+   //Size of the PRF output
+   digestSize = workspace->hash->digestSize;
+
+   //Compute H(K xor ipad || U(j-1))
+   for(k = 0; k < n; k++)
+   {
+      slot = workspace->active[k];
+      context[k] = &slot->sha512Context;
+      inner = (const Sha512Context *) slot->hmacKey.innerContext;
+
+      memcpy(context[k]->h, inner->h, 64);
+      memcpy(context[k]->buffer, slot->u, digestSize);
+      memcpy(context[k]->buffer + digestSize, workspace->pad + digestSize,
+         128 - digestSize);
+   }
+
+   sha512ProcessBlockMulti(context, n);
+
+   //Compute U(j) = H(K xor opad || H(K xor ipad || U(j-1)))
+   for(k = 0; k < n; k++)
+   {
+      slot = workspace->active[k];
+      outer = (const Sha512Context *) slot->hmacKey.outerContext;
+
+      for(i = 0; i < digestSize / 8; i++)
+         STORE64BE(context[k]->h[i], context[k]->buffer + i * 8);
+
+      memcpy(context[k]->h, outer->h, 64);
+      memcpy(context[k]->buffer + digestSize, workspace->pad + digestSize,
+         128 - digestSize);
+   }
+
+   sha512ProcessBlockMulti(context, n);
+
+   //Compute T = U(1) xor U(2) xor ... xor U(j)
+   for(k = 0; k < n; k++)
+   {
+      slot = workspace->active[k];
+
+      for(i = 0; i < digestSize / 8; i++)
+         STORE64BE(context[k]->h[i], slot->u + i * 8);
+
+      for(i = 0; i < digestSize; i++)
+         slot->t[i] ^= slot->u[i];
+   }
+}
+
+#endif
+
+
+/**
+ * @brief Perform one iteration in each busy slot
+ * @param[in] workspace PBKDF2 workspace
+ * @param[in] n Number of busy slots
+ **/
+
+static void pbkdf2Step(Pbkdf2Workspace *workspace, uint_t n)
+{
+   uint_t k;
+   size_t i;
+   size_t digestSize;
+   const HashAlgo *hash;
+   Pbkdf2Slot *slot;
+
+   //Hash algorithm used by the underlying PRF
+   hash = workspace->hash;
+
+#if (SHA1_SUPPORT == ENABLED)
+   //SHA-1 fast path?
+   if(hash == SHA1_HASH_ALGO)
+   {
+      pbkdf2Sha1Step(workspace, n);
+      return;
+   }
+#endif
+#if (SHA224_SUPPORT == ENABLED)
+   //SHA-224 fast path?
+   if(hash == SHA224_HASH_ALGO)
+   {
+      pbkdf2Sha256Step(workspace, n);
+      return;
+   }
+#endif
+#if (SHA256_SUPPORT == ENABLED)
+   //SHA-256 fast path?
+   if(hash == SHA256_HASH_ALGO)
+   {
+      pbkdf2Sha256Step(workspace, n);
+      return;
+   }
+#endif
+#if (SHA384_SUPPORT == ENABLED)
+   //SHA-384 fast path?
+   if(hash == SHA384_HASH_ALGO)
+   {
+      pbkdf2Sha512Step(workspace, n);
+      return;
+   }
+#endif
+#if (SHA512_SUPPORT == ENABLED)
+   //SHA-512 fast path?
+   if(hash == SHA512_HASH_ALGO)
+   {
+      pbkdf2Sha512Step(workspace, n);
+      return;
+   }
+#endif
+
+   //Size of the PRF output
+   digestSize = hash->digestSize;
+
+   //Other hash algorithms rely on the generic HMAC code
+   for(k = 0; k < n; k++)
+   {
+      //Point to the current slot
+      slot = workspace->active[k];
+
+      //Compute U(j) = PRF(P, U(j-1))
+      hmacInitFromKey(&slot->hmacContext, &slot->hmacKey);
+      hmacUpdate(&slot->hmacContext, slot->u, digestSize);
+      hmacFinal(&slot->hmacContext, slot->u);
+
+      //Compute T = U(1) xor U(2) xor ... xor U(j)
+      for(i = 0; i < digestSize; i++)
+         slot->t[i] ^= slot->u[i];
+   }
+}
+
+
+/**
+ * @brief Process a set of PBKDF2 jobs
+ *
+ * The blocks of the derived keys are assigned to the slots of the
+ * workspace, and every step performs one iteration in each busy slot. A
+ * slot is refilled with the next pending block as soon as its current
+ * block is complete, so that jobs with different iteration counts keep
+ * the slots busy
+ *
+ * @param[in] workspace PBKDF2 workspace
+ * @param[in] hash Hash algorithm used by the underlying PRF
+ * @param[in,out] jobs Array of jobs
+ * @param[in] count Number of jobs
+ * @param[in] callback Completion callback (optional)
+ * @param[in] param Opaque parameter passed to the completion callback
+ **/
+
+static void pbkdf2Run(Pbkdf2Workspace *workspace, const HashAlgo *hash,
+   Pbkdf2Job *jobs, uint_t count, Pbkdf2Callback callback, void *param)
+{
+   error_t error;
+   uint_t k;
+   uint_t n;
+   uint_t next;
+   uint32_t i;
+   bool_t done;
+   size_t offset;
+   size_t digestSize;
+   Pbkdf2Job *job;
+   Pbkdf2Slot *slot;
+   Pbkdf2Slot *prev;
+
+   //Save the hash algorithm
+   workspace->hash = hash;
+   //Size of the PRF output
+   digestSize = hash->digestSize;
+
+   //The second block of the inner and outer hashes is a padded digest
+   //(SHA-1 and SHA-2 fast paths)
+   if((digestSize + 9) <= hash->blockSize)
+   {
+      memset(workspace->pad, 0, hash->blockSize);
+      workspace->pad[digestSize] = 0x80;
+      STORE64BE((hash->blockSize + digestSize) * 8,
+         workspace->pad + hash->blockSize - 8);
+   }
+
+   //All the slots are idle
+   for(k = 0; k < workspace->numSlots; k++)
+      workspace->slot[k].job = NULL;
+
+   //Index of the next block to be assigned
+   next = 0;
+   i = 1;
+   prev = NULL;
+
+   //Process the jobs
+   while(1)
+   {
+      //Assign pending blocks to the idle slots
+      for(k = 0; k < workspace->numSlots && next < count; )
+      {
+         //Point to the current slot and to the next pending job
+         slot = &workspace->slot[k];
+         job = &jobs[next];
+
+         //Check the parameters of the job
+         error = pbkdf2CheckJob(job);
+
+         //Busy slot?
+         if(slot->job != NULL)
+         {
+            //Try the next slot
+            k++;
+         }
+         else if(error || job->dkLen == 0)
+         {
+            //Jobs that do not need any block are completed right away
+            if(callback != NULL)
+               callback(job, error, param);
+
+            //Move to the next job
+            next++;
+         }
+         else
+         {
+            //Compute U(1) for the current block
+            pbkdf2StartSlot(workspace, slot, job, i, prev);
+            prev = slot;
+
+            //Last block of the job?
+            if((size_t) i * digestSize >= job->dkLen)
+            {
+               next++;
+               i = 1;
+            }
+            else
+            {
+               i++;
+            }
+
+            //Try the next slot
+            k++;
+         }
+      }
+
+      //Save the blocks whose iterations are all done
+      for(done = FALSE, k = 0; k < workspace->numSlots; k++)
+      {
+         slot = &workspace->slot[k];
+
+         if(slot->job != NULL && slot->remaining == 0)
+         {
+            //Copy the resulting block
+            offset = (slot->i - 1) * digestSize;
+            memcpy(slot->job->dk + offset, slot->t,
+               MIN(slot->job->dkLen - offset, digestSize));
+
+            done = TRUE;
+         }
+      }
+
+      //Any block complete?
+      if(done)
+      {
+         //The last block of a job is never complete before the other ones
+         for(k = 0; k < workspace->numSlots; k++)
+         {
+            slot = &workspace->slot[k];
+
+            if(slot->job != NULL && slot->remaining == 0)
+            {
+               //Last block of the job?
+               if((size_t) slot->i * digestSize >= slot->job->dkLen)
+               {
+                  if(callback != NULL)
+                     callback(slot->job, NO_ERROR, param);
+               }
+
+               //The slot is now idle
+               slot->job = NULL;
+            }
+         }
+
+         //Refill the idle slots
+         continue;
+      }
+
+      //Retrieve the busy slots
+      for(n = 0, k = 0; k < workspace->numSlots; k++)
+      {
+         if(workspace->slot[k].job != NULL)
+            workspace->active[n++] = &workspace->slot[k];
+      }
+
+      //All the jobs have been processed?
+      if(n == 0)
+         break;
+
+      //Perform one iteration in each busy slot
+      pbkdf2Step(workspace, n);
+
+      //Update the iteration counters
+      for(k = 0; k < n; k++)
+         workspace->active[k]->remaining--;
+   }
+}
+
+
 /**
  * @brief PBKDF2 key derivation function
  *
  * PBKDF2 applies a pseudorandom function to derive keys. The
  * length of the derived key is essentially unbounded
  *
+ * The password is processed only once, and every iteration of the PRF then
+ * resumes from the precomputed inner and outer midstates. With SHA-1 and
+ * SHA-2 hash functions, the iterations are run directly on the compression
+ * function, and the blocks of the derived key are computed in parallel
+ * whenever SIMD instructions are available
+ *
  * @param[in] hash Hash algorithm used by the underlying PRF
  * @param[in] p Password, an octet string
  * @param[in] pLen Length in octets of password
@@ -136,81 +740,100 @@ error_t pbkdf1(const HashAlgo *hash, const uint8_t *p, size_t pLen,
 error_t pbkdf2(const HashAlgo *hash, const uint8_t *p, size_t pLen,
    const uint8_t *s, size_t sLen, uint_t c, uint8_t *dk, size_t dkLen)
 {
-   uint_t i;
-   uint_t j;
-   uint_t k;
-   uint8_t *u;
-   uint8_t *t;
-   HmacContext *context;
-   uint8_t a[4];
+   error_t error;
+   uint_t numSlots;
+   Pbkdf2Job job;
+   Pbkdf2Workspace *workspace;
+
+   //Describe the key derivation
+   job.p = p;
+   job.pLen = pLen;
+   job.s = s;
+   job.sLen = sLen;
+   job.c = c;
+   job.dk = dk;
+   job.dkLen = dkLen;
+
+   //Check parameters
+   error = pbkdf2CheckJob(&job);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //One slot per block of the derived key, up to PBKDF2_MAX_SLOTS
+   numSlots = (uint_t) MIN((dkLen + hash->digestSize - 1) / hash->digestSize,
+      PBKDF2_MAX_SLOTS);
+
+   //Allocate a memory buffer to hold the workspace
+   workspace = pbkdf2AllocWorkspace(MAX(numSlots, 1));
+   //Failed to allocate memory?
+   if(workspace == NULL)
+      return ERROR_OUT_OF_MEMORY;
 
-   //Iteration count must be a positive integer
-   if(c < 1)
-      return ERROR_INVALID_PARAMETER;
+   //Derive the key
+   pbkdf2Run(workspace, hash, &job, 1, NULL, NULL);
 
-   //Allocate a memory buffer to hold the HMAC context
-   context = cryptoAllocMem(sizeof(HmacContext));
-   //Allocate temporary buffers
-   u = cryptoAllocMem(hash->digestSize);
-   t = cryptoAllocMem(hash->digestSize);
+   //Release the workspace
+   pbkdf2FreeWorkspace(workspace);
 
-   //Failed to allocate memory?
-   if(!context || !u || !t)
-   {
-      //Free previously allocated memory
-      cryptoFreeMem(context);
-      cryptoFreeMem(u);
-      cryptoFreeMem(t);
+   //Successful processing
+   return NO_ERROR;
+}
 
-      //Report an error
-      return ERROR_OUT_OF_MEMORY;
-   }
 
-   //For each block of the derived key apply the function F
-   for(i = 1; dkLen > 0; i++)
-   {
-      //Calculate the 4-octet encoding of the integer i (MSB first)
-      a[0] = (i >> 24) & 0xFF;
-      a[1] = (i >> 16) & 0xFF;
-      a[2] = (i >> 8) & 0xFF;
-      a[3] = i & 0xFF;
+/**
+ * @brief Run several PBKDF2 key derivations
+ *
+ * The jobs share the same hash algorithm, but each job has its own
+ * password, salt and iteration count. Up to PBKDF2_MAX_SLOTS blocks of the
+ * derived keys, possibly belonging to different jobs, are computed
+ * concurrently. With SHA-1 and SHA-2 hash functions, their compression
+ * function calls run in the lanes of the multi-buffer implementation
+ * whenever SIMD instructions are available. The derived keys are identical
+ * to those produced by pbkdf2
+ *
+ * The completion callback is invoked once per job, as soon as its derived
+ * key is available or as soon as its parameters are found to be invalid.
+ * The function is reentrant, so that a large batch can be split among
+ * several threads
+ *
+ * @param[in] hash Hash algorithm used by the underlying PRF
+ * @param[in,out] jobs Array of jobs
+ * @param[in] count Number of jobs
+ * @param[in] callback Completion callback
+ * @param[in] param Opaque parameter passed to the completion callback
+ * @return Error code
+ **/
 
-      //Compute U1 = PRF(P, S || INT(i))
-      hmacInit(context, hash, p, pLen);
-      hmacUpdate(context, s, sLen);
-      hmacUpdate(context, a, 4);
-      hmacFinal(context, u);
+error_t pbkdf2Batch(const HashAlgo *hash, Pbkdf2Job *jobs, uint_t count,
+   Pbkdf2Callback callback, void *param)
+{
+   uint_t k;
+   size_t n;
+   Pbkdf2Workspace *workspace;
 
-      //Save the resulting HMAC value
-      memcpy(t, u, hash->digestSize);
+   //Check parameters
+   if(hash == NULL || callback == NULL || (jobs == NULL && count != 0))
+      return ERROR_INVALID_PARAMETER;
 
-      //Iterate as many times as required
-      for(j = 1; j < c; j++)
-      {
-         //Compute U(j) = PRF(P, U(j-1))
-         hmacInit(context, hash, p, pLen);
-         hmacUpdate(context, u, hash->digestSize);
-         hmacFinal(context, u);
-
-         //Compute T = U(1) xor U(2) xor ... xor U(c)
-         for(k = 0; k < hash->digestSize; k++)
-            t[k] ^= u[k];
-      }
+   //Count the blocks of the derived keys, up to PBKDF2_MAX_SLOTS
+   for(n = 0, k = 0; k < count && n < PBKDF2_MAX_SLOTS; k++)
+   {
+      if(!pbkdf2CheckJob(&jobs[k]))
+         n += (jobs[k].dkLen + hash->digestSize - 1) / hash->digestSize;
+   }
 
-      //Number of octets in the current block
-      k = MIN(dkLen, hash->digestSize);
-      //Save the resulting block
-      memcpy(dk, t, k);
+   //Allocate a memory buffer to hold the workspace
+   workspace = pbkdf2AllocWorkspace((uint_t) MAX(MIN(n, PBKDF2_MAX_SLOTS), 1));
+   //Failed to allocate memory?
+   if(workspace == NULL)
+      return ERROR_OUT_OF_MEMORY;
 
-      //Point to the next block
-      dk += k;
-      dkLen -= k;
-   }
+   //Derive the keys
+   pbkdf2Run(workspace, hash, jobs, count, callback, param);
 
-   //Free previously allocated memory
-   cryptoFreeMem(context);
-   cryptoFreeMem(u);
-   cryptoFreeMem(t);
+   //Release the workspace
+   pbkdf2FreeWorkspace(workspace);
 
    //Successful processing
    return NO_ERROR;
@@ -32,11 +32,42 @@
 //Dependencies
 #include "crypto.h"
 
+//Maximum number of blocks of the derived keys computed in parallel
+#ifndef PBKDF2_MAX_SLOTS
+   #define PBKDF2_MAX_SLOTS 16
+#elif (PBKDF2_MAX_SLOTS < 1)
+   #error PBKDF2_MAX_SLOTS parameter is not valid
+#endif
+
 //C++ guard
 #ifdef __cplusplus
    extern "C" {
 #endif
 
+
+/**
+ * @brief PBKDF2 job (batch key derivation)
+ **/
+
+typedef struct
+{
+   const uint8_t *p; ///<Password
+   size_t pLen;      ///<Length of the password
+   const uint8_t *s; ///<Salt
+   size_t sLen;      ///<Length of the salt
+   uint_t c;         ///<Iteration count
+   uint8_t *dk;      ///<Derived key
+   size_t dkLen;     ///<Intended length of the derived key
+} Pbkdf2Job;
+
+
+/**
+ * @brief PBKDF2 completion callback
+ **/
+
+typedef void (*Pbkdf2Callback)(Pbkdf2Job *job, error_t error, void *param);
+
+
 //PKCS #5 related constants
 extern const uint8_t PKCS5_OID[8];
 extern const uint8_t PBKDF2_OID[9];
@@ -48,6 +79,9 @@ error_t pbkdf1(const HashAlgo *hash, const uint8_t *p, size_t pLen,
 error_t pbkdf2(const HashAlgo *hash, const uint8_t *p, size_t pLen,
    const uint8_t *s, size_t sLen, uint_t c, uint8_t *dk, size_t dkLen);
 
+error_t pbkdf2Batch(const HashAlgo *hash, Pbkdf2Job *jobs, uint_t count,
+   Pbkdf2Callback callback, void *param);
+
 //C++ guard
 #ifdef __cplusplus
    }
@@ -33,11 +33,452 @@
 #include <string.h>
 #include "crypto.h"
 #include "poly1305.h"
+#include "cpu_features.h"
 #include "debug.h"
 
+//SIMD support?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   #include <immintrin.h>
+#endif
+
 //Check crypto library configuration
 #if (POLY1305_SUPPORT == ENABLED)
 
+//64-bit implementation based on 128-bit products
+#if defined(__SIZEOF_INT128__)
+   #define POLY1305_INT128_SUPPORT
+#endif
+
+//Limb masks
+#define POLY1305_MASK26 0x03FFFFFF
+#define POLY1305_MASK42 0x000003FFFFFFFFFFULL
+#define POLY1305_MASK44 0x00000FFFFFFFFFFFULL
+
+
+//SIMD support?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+/**
+ * @brief Multiplication modulo 2^130 - 5 (radix 2^26 representation)
+ * @param[in,out] h First operand, and result of the multiplication
+ * @param[in] r Second operand
+ **/
+
+static void poly1305Mul26(uint32_t *h, const uint32_t *r)
+{
+   uint64_t c;
+   uint64_t d[5];
+
+   //Multiply h by r (5 * 2^130 = 5 mod p is used to fold the upper part)
+   d[0] = (uint64_t) h[0] * r[0] + (uint64_t) h[1] * (r[4] * 5) +
+      (uint64_t) h[2] * (r[3] * 5) + (uint64_t) h[3] * (r[2] * 5) +
+      (uint64_t) h[4] * (r[1] * 5);
+
+   d[1] = (uint64_t) h[0] * r[1] + (uint64_t) h[1] * r[0] +
+      (uint64_t) h[2] * (r[4] * 5) + (uint64_t) h[3] * (r[3] * 5) +
+      (uint64_t) h[4] * (r[2] * 5);
+
+   d[2] = (uint64_t) h[0] * r[2] + (uint64_t) h[1] * r[1] +
+      (uint64_t) h[2] * r[0] + (uint64_t) h[3] * (r[4] * 5) +
+      (uint64_t) h[4] * (r[3] * 5);
+
+   d[3] = (uint64_t) h[0] * r[3] + (uint64_t) h[1] * r[2] +
+      (uint64_t) h[2] * r[1] + (uint64_t) h[3] * r[0] +
+      (uint64_t) h[4] * (r[4] * 5);
+
+   d[4] = (uint64_t) h[0] * r[4] + (uint64_t) h[1] * r[3] +
+      (uint64_t) h[2] * r[2] + (uint64_t) h[3] * r[1] +
+      (uint64_t) h[4] * r[0];
+
+   //Propagate the carry
+   c = d[0] >> 26;
+   d[1] += c;
+   c = d[1] >> 26;
+   d[2] += c;
+   c = d[2] >> 26;
+   d[3] += c;
+   c = d[3] >> 26;
+   d[4] += c;
+   c = d[4] >> 26;
+
+   //Perform modular reduction
+   d[0] = (d[0] & POLY1305_MASK26) + c * 5;
+   c = d[0] >> 26;
+
+   //Save the result
+   h[0] = d[0] & POLY1305_MASK26;
+   h[1] = (d[1] & POLY1305_MASK26) + (uint32_t) c;
+   h[2] = d[2] & POLY1305_MASK26;
+   h[3] = d[3] & POLY1305_MASK26;
+   h[4] = d[4] & POLY1305_MASK26;
+}
+
+#endif
+
+
+//SIMD support on x86 targets?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+/**
+ * @brief Multiplication modulo 2^130 - 5 (4 lanes, radix 2^26)
+ * @param[in,out] h First operand, and result of the multiplication
+ * @param[in] r Second operand
+ * @param[in] s Second operand multiplied by 5
+ **/
+
+CPU_TARGET("avx2") static void poly1305Avx2Mul(__m256i *h, const __m256i *r,
+   const __m256i *s)
+{
+   __m256i c;
+   __m256i m;
+   __m256i d[5];
+
+   //Multiply h by r (5 * 2^130 = 5 mod p is used to fold the upper part)
+   d[0] = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(h[0], r[0]),
+      _mm256_mul_epu32(h[1], s[4])), _mm256_add_epi64(_mm256_mul_epu32(h[2], s[3]),
+      _mm256_add_epi64(_mm256_mul_epu32(h[3], s[2]), _mm256_mul_epu32(h[4], s[1]))));
+
+   d[1] = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(h[0], r[1]),
+      _mm256_mul_epu32(h[1], r[0])), _mm256_add_epi64(_mm256_mul_epu32(h[2], s[4]),
+      _mm256_add_epi64(_mm256_mul_epu32(h[3], s[3]), _mm256_mul_epu32(h[4], s[2]))));
+
+   d[2] = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(h[0], r[2]),
+      _mm256_mul_epu32(h[1], r[1])), _mm256_add_epi64(_mm256_mul_epu32(h[2], r[0]),
+      _mm256_add_epi64(_mm256_mul_epu32(h[3], s[4]), _mm256_mul_epu32(h[4], s[3]))));
+
+   d[3] = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(h[0], r[3]),
+      _mm256_mul_epu32(h[1], r[2])), _mm256_add_epi64(_mm256_mul_epu32(h[2], r[1]),
+      _mm256_add_epi64(_mm256_mul_epu32(h[3], r[0]), _mm256_mul_epu32(h[4], s[4]))));
+
+   d[4] = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(h[0], r[4]),
+      _mm256_mul_epu32(h[1], r[3])), _mm256_add_epi64(_mm256_mul_epu32(h[2], r[2]),
+      _mm256_add_epi64(_mm256_mul_epu32(h[3], r[1]), _mm256_mul_epu32(h[4], r[0]))));
+
+   //Limb mask
+   m = _mm256_set1_epi64x(POLY1305_MASK26);
+
+   //Propagate the carry
+   c = _mm256_srli_epi64(d[0], 26);
+   h[0] = _mm256_and_si256(d[0], m);
+   d[1] = _mm256_add_epi64(d[1], c);
+   c = _mm256_srli_epi64(d[1], 26);
+   h[1] = _mm256_and_si256(d[1], m);
+   d[2] = _mm256_add_epi64(d[2], c);
+   c = _mm256_srli_epi64(d[2], 26);
+   h[2] = _mm256_and_si256(d[2], m);
+   d[3] = _mm256_add_epi64(d[3], c);
+   c = _mm256_srli_epi64(d[3], 26);
+   h[3] = _mm256_and_si256(d[3], m);
+   d[4] = _mm256_add_epi64(d[4], c);
+   c = _mm256_srli_epi64(d[4], 26);
+   h[4] = _mm256_and_si256(d[4], m);
+
+   //Perform modular reduction
+   h[0] = _mm256_add_epi64(h[0], _mm256_add_epi64(c, _mm256_slli_epi64(c, 2)));
+   c = _mm256_srli_epi64(h[0], 26);
+   h[0] = _mm256_and_si256(h[0], m);
+   h[1] = _mm256_add_epi64(h[1], c);
+}
+
+
+/**
+ * @brief Process message in 64-byte chunks using AVX2 instructions
+ *
+ * Each of the 4 lanes handles every fourth block, using r^4 as multiplier.
+ * The lanes are then multiplied by r^4, r^3, r^2 and r respectively, and
+ * summed to form the new value of the accumulator
+ *
+ * @param[in] context Pointer to the Poly1305 context
+ * @param[in] data Pointer to the message
+ * @param[in] length Length of the message (multiple of 64)
+ **/
+
+CPU_TARGET("avx2") static void poly1305Avx2ProcessBlocks(Poly1305Context *context,
+   const uint8_t *data, size_t length)
+{
+   uint_t i;
+   uint_t j;
+   uint64_t c;
+   uint64_t t0;
+   uint64_t t1;
+   uint64_t h[5];
+   uint64_t m[4][5];
+   uint64_t d[5][4];
+   __m256i hv[5];
+   __m256i rv[5];
+   __m256i sv[5];
+
+   //Convert the accumulator to radix 2^26
+   t0 = context->a[0] | (context->a[1] << 32);
+   t1 = context->a[2] | (context->a[3] << 32);
+
+   h[0] = t0 & POLY1305_MASK26;
+   h[1] = (t0 >> 26) & POLY1305_MASK26;
+   h[2] = ((t0 >> 52) | (t1 << 12)) & POLY1305_MASK26;
+   h[3] = (t1 >> 14) & POLY1305_MASK26;
+   h[4] = (t1 >> 40) | (context->a[4] << 24);
+
+   //The accumulator is added to the first lane
+   for(i = 0; i < 5; i++)
+      hv[i] = _mm256_set_epi64x(0, 0, 0, h[i]);
+
+   //Load r^4
+   for(i = 0; i < 5; i++)
+   {
+      rv[i] = _mm256_set1_epi64x(context->rp[3][i]);
+      sv[i] = _mm256_set1_epi64x(context->rp[3][i] * 5);
+   }
+
+   //Process the message
+   while(length > 0)
+   {
+      //Split each block into 26-bit limbs and add one bit beyond the
+      //number of octets
+      for(j = 0; j < 4; j++)
+      {
+         t0 = LOAD32LE(data + 16 * j) | ((uint64_t) LOAD32LE(data + 16 * j + 4) << 32);
+         t1 = LOAD32LE(data + 16 * j + 8) | ((uint64_t) LOAD32LE(data + 16 * j + 12) << 32);
+
+         m[j][0] = t0 & POLY1305_MASK26;
+         m[j][1] = (t0 >> 26) & POLY1305_MASK26;
+         m[j][2] = ((t0 >> 52) | (t1 << 12)) & POLY1305_MASK26;
+         m[j][3] = (t1 >> 14) & POLY1305_MASK26;
+         m[j][4] = (t1 >> 40) | (1 << 24);
+      }
+
+      //Add the blocks to the accumulator
+      for(i = 0; i < 5; i++)
+      {
+         hv[i] = _mm256_add_epi64(hv[i], _mm256_set_epi64x(m[3][i], m[2][i],
+            m[1][i], m[0][i]));
+      }
+
+      //Next blocks
+      data += 64;
+      length -= 64;
+
+      //Multiply the accumulator by r^4, except for the last blocks
+      if(length > 0)
+         poly1305Avx2Mul(hv, rv, sv);
+   }
+
+   //Multiply the lanes by r^4, r^3, r^2 and r respectively
+   for(i = 0; i < 5; i++)
+   {
+      rv[i] = _mm256_set_epi64x(context->rp[0][i], context->rp[1][i],
+         context->rp[2][i], context->rp[3][i]);
+
+      sv[i] = _mm256_set_epi64x(context->rp[0][i] * 5, context->rp[1][i] * 5,
+         context->rp[2][i] * 5, context->rp[3][i] * 5);
+   }
+
+   poly1305Avx2Mul(hv, rv, sv);
+
+   //Sum the lanes
+   for(i = 0; i < 5; i++)
+   {
+      _mm256_storeu_si256((__m256i *) d[i], hv[i]);
+      h[i] = d[i][0] + d[i][1] + d[i][2] + d[i][3];
+   }
+
+   //Propagate the carry
+   c = h[0] >> 26;
+   h[0] &= POLY1305_MASK26;
+   h[1] += c;
+   c = h[1] >> 26;
+   h[1] &= POLY1305_MASK26;
+   h[2] += c;
+   c = h[2] >> 26;
+   h[2] &= POLY1305_MASK26;
+   h[3] += c;
+   c = h[3] >> 26;
+   h[3] &= POLY1305_MASK26;
+   h[4] += c;
+   c = h[4] >> 26;
+   h[4] &= POLY1305_MASK26;
+
+   //Perform modular reduction
+   h[0] += c * 5;
+   c = h[0] >> 26;
+   h[0] &= POLY1305_MASK26;
+   h[1] += c;
+   c = h[1] >> 26;
+   h[1] &= POLY1305_MASK26;
+   h[2] += c;
+   c = h[2] >> 26;
+   h[2] &= POLY1305_MASK26;
+   h[3] += c;
+   c = h[3] >> 26;
+   h[3] &= POLY1305_MASK26;
+   h[4] += c;
+
+   //Convert the accumulator back to radix 2^32
+   context->a[0] = (h[0] | (h[1] << 26)) & 0xFFFFFFFF;
+   context->a[1] = ((h[1] >> 6) | (h[2] << 20)) & 0xFFFFFFFF;
+   context->a[2] = ((h[2] >> 12) | (h[3] << 14)) & 0xFFFFFFFF;
+   context->a[3] = ((h[3] >> 18) | (h[4] << 8)) & 0xFFFFFFFF;
+   context->a[4] = h[4] >> 24;
+}
+
+#endif
+
+
+//64-bit implementation?
+#if defined(POLY1305_INT128_SUPPORT)
+
+/**
+ * @brief Process message in 16-byte blocks (radix 2^44, 128-bit products)
+ * @param[in] context Pointer to the Poly1305 context
+ * @param[in] data Pointer to the message
+ * @param[in] length Length of the message (multiple of 16)
+ **/
+
+static void poly1305ProcessBlocks64(Poly1305Context *context,
+   const uint8_t *data, size_t length)
+{
+   uint64_t c;
+   uint64_t t0;
+   uint64_t t1;
+   uint64_t h0;
+   uint64_t h1;
+   uint64_t h2;
+   uint64_t r0;
+   uint64_t r1;
+   uint64_t r2;
+   uint64_t s1;
+   uint64_t s2;
+   unsigned __int128 d0;
+   unsigned __int128 d1;
+   unsigned __int128 d2;
+
+   //Convert r to radix 2^44
+   t0 = context->r[0] | ((uint64_t) context->r[1] << 32);
+   t1 = context->r[2] | ((uint64_t) context->r[3] << 32);
+
+   r0 = t0 & POLY1305_MASK44;
+   r1 = ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+   r2 = t1 >> 24;
+
+   //Precompute 4 * 5 * r (2^132 = 4 * 5 mod p)
+   s1 = r1 * 20;
+   s2 = r2 * 20;
+
+   //Convert the accumulator to radix 2^44
+   t0 = context->a[0] | (context->a[1] << 32);
+   t1 = context->a[2] | (context->a[3] << 32);
+
+   h0 = t0 & POLY1305_MASK44;
+   h1 = ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+   h2 = (t1 >> 24) | (context->a[4] << 40);
+
+   //Process the message
+   while(length > 0)
+   {
+      //Read the block as a little-endian number
+      t0 = LOAD32LE(data) | ((uint64_t) LOAD32LE(data + 4) << 32);
+      t1 = LOAD32LE(data + 8) | ((uint64_t) LOAD32LE(data + 12) << 32);
+
+      //Add this number to the accumulator, together with 2^128
+      h0 += t0 & POLY1305_MASK44;
+      h1 += ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+      h2 += (t1 >> 24) | ((uint64_t) 1 << 40);
+
+      //Multiply the accumulator by r
+      d0 = (unsigned __int128) h0 * r0 + (unsigned __int128) h1 * s2 +
+         (unsigned __int128) h2 * s1;
+      d1 = (unsigned __int128) h0 * r1 + (unsigned __int128) h1 * r0 +
+         (unsigned __int128) h2 * s2;
+      d2 = (unsigned __int128) h0 * r2 + (unsigned __int128) h1 * r1 +
+         (unsigned __int128) h2 * r0;
+
+      //Propagate the carry
+      c = (uint64_t) (d0 >> 44);
+      h0 = (uint64_t) d0 & POLY1305_MASK44;
+      d1 += c;
+      c = (uint64_t) (d1 >> 44);
+      h1 = (uint64_t) d1 & POLY1305_MASK44;
+      d2 += c;
+      c = (uint64_t) (d2 >> 42);
+      h2 = (uint64_t) d2 & POLY1305_MASK42;
+
+      //Perform modular reduction
+      h0 += c * 5;
+      c = h0 >> 44;
+      h0 &= POLY1305_MASK44;
+      h1 += c;
+
+      //Next block
+      data += 16;
+      length -= 16;
+   }
+
+   //Propagate the carry
+   c = h1 >> 44;
+   h1 &= POLY1305_MASK44;
+   h2 += c;
+
+   //Convert the accumulator back to radix 2^32
+   t0 = h0 | (h1 << 44);
+   t1 = (h1 >> 20) | (h2 << 24);
+
+   context->a[0] = t0 & 0xFFFFFFFF;
+   context->a[1] = t0 >> 32;
+   context->a[2] = t1 & 0xFFFFFFFF;
+   context->a[3] = t1 >> 32;
+   context->a[4] = h2 >> 40;
+}
+
+#endif
+
+
+/**
+ * @brief Process message in 16-byte blocks, directly from the input
+ * @param[in] context Pointer to the Poly1305 context
+ * @param[in] data Pointer to the message
+ * @param[in] length Length of the message (multiple of 16)
+ **/
+
+static void poly1305ProcessBlocks(Poly1305Context *context,
+   const uint8_t *data, size_t length)
+{
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   size_t n;
+
+   //Process 4 blocks at a time using AVX2 instructions
+   if((cpuGetFeatures() & CPU_FEATURE_AVX2) != 0 && length >= 64)
+   {
+      n = length - (length % 64);
+      poly1305Avx2ProcessBlocks(context, data, n);
+
+      //Remaining blocks
+      data += n;
+      length -= n;
+   }
+#endif
+
+#if defined(POLY1305_INT128_SUPPORT)
+   //Process the remaining blocks using 128-bit products
+   if(length > 0)
+      poly1305ProcessBlocks64(context, data, length);
+#else
+   //Process the remaining blocks one at a time
+   while(length > 0)
+   {
+      //Copy the block to the buffer
+      memcpy(context->buffer, data, 16);
+      context->size = 16;
+
+      //Transform the 16-byte block
+      poly1305ProcessBlock(context);
+      context->size = 0;
+
+      //Next block
+      data += 16;
+      length -= 16;
+   }
+#endif
+}
+
 
 /**
  * @brief Initialize Poly1305 message-authentication code computation
@@ -47,6 +488,10 @@
 
 void poly1305Init(Poly1305Context *context, const uint8_t *key)
 {
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   uint_t i;
+#endif
+
    //The 256-bit key is partitioned into two parts, called r and s
    context->r[0] = LOAD32LE(key);
    context->r[1] = LOAD32LE(key + 4);
@@ -75,6 +520,22 @@ void poly1305Init(Poly1305Context *context, const uint8_t *key)
 
    //Number of bytes in the buffer
    context->size = 0;
+
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //Convert r to radix 2^26
+   context->rp[0][0] = context->r[0] & POLY1305_MASK26;
+   context->rp[0][1] = ((context->r[0] >> 26) | (context->r[1] << 6)) & POLY1305_MASK26;
+   context->rp[0][2] = ((context->r[1] >> 20) | (context->r[2] << 12)) & POLY1305_MASK26;
+   context->rp[0][3] = ((context->r[2] >> 14) | (context->r[3] << 18)) & POLY1305_MASK26;
+   context->rp[0][4] = context->r[3] >> 8;
+
+   //Precompute r^2, r^3 and r^4
+   for(i = 1; i < 4; i++)
+   {
+      memcpy(context->rp[i], context->rp[i - 1], sizeof(context->rp[i]));
+      poly1305Mul26(context->rp[i], context->rp[0]);
+   }
+#endif
 }
 
 
@@ -92,6 +553,24 @@ void poly1305Update(Poly1305Context *context, const void *data, size_t length)
    //Process the incoming data
    while(length > 0)
    {
+      //Complete blocks can be processed directly from the input
+      if(context->size == 0 && length >= 16)
+      {
+         //Number of bytes to process
+         n = length - (length % 16);
+
+         //Process as many blocks as possible
+         poly1305ProcessBlocks(context, data, n);
+
+         //Advance the data pointer
+         data = (uint8_t *) data + n;
+         //Remaining bytes to process
+         length -= n;
+
+         //Process the remaining bytes, if any
+         continue;
+      }
+
       //The buffer can hold at most 16 bytes
       n = MIN(length, 16 - context->size);
 
@@ -201,6 +680,11 @@ void poly1305Final(Poly1305Context *context, uint8_t *tag)
    context->s[1] = 0;
    context->s[2] = 0;
    context->s[3] = 0;
+
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //Clear the powers of r
+   memset(context->rp, 0, sizeof(context->rp));
+#endif
 }
 
 
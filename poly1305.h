@@ -31,6 +31,7 @@
 
 //Dependencies
 #include "crypto.h"
+#include "cpu_features.h"
 #include "mpi.h"
 
 //C++ guard
@@ -50,6 +51,9 @@ typedef struct
    uint64_t a[8];
    uint8_t buffer[17];
    size_t size;
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   uint32_t rp[4][5];
+#endif
 } Poly1305Context;
 
 
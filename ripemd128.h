@@ -36,6 +36,8 @@
 #define RIPEMD128_BLOCK_SIZE 64
 //RIPEMD-128 digest size
 #define RIPEMD128_DIGEST_SIZE 16
+//RIPEMD-128 maximum size of the exported state
+#define RIPEMD128_STATE_SIZE (RIPEMD128_DIGEST_SIZE + 8 + RIPEMD128_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define RIPEMD128_HASH_ALGO (&ripemd128HashAlgo)
 
@@ -74,6 +76,9 @@ error_t ripemd128Compute(const void *data, size_t length, uint8_t *digest);
 void ripemd128Init(Ripemd128Context *context);
 void ripemd128Update(Ripemd128Context *context, const void *data, size_t length);
 void ripemd128Final(Ripemd128Context *context, uint8_t *digest);
+void ripemd128Clone(Ripemd128Context *destContext, const Ripemd128Context *srcContext);
+size_t ripemd128ExportState(const Ripemd128Context *context, uint8_t *output);
+error_t ripemd128ImportState(Ripemd128Context *context, const uint8_t *input, size_t length);
 void ripemd128ProcessBlock(Ripemd128Context *context);
 
 //C++ guard
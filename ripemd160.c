@@ -77,10 +77,14 @@ const HashAlgo ripemd160HashAlgo =
    sizeof(Ripemd160Context),
    RIPEMD160_BLOCK_SIZE,
    RIPEMD160_DIGEST_SIZE,
+   RIPEMD160_STATE_SIZE,
    (HashAlgoCompute) ripemd160Compute,
    (HashAlgoInit) ripemd160Init,
    (HashAlgoUpdate) ripemd160Update,
-   (HashAlgoFinal) ripemd160Final
+   (HashAlgoFinal) ripemd160Final,
+   (HashAlgoClone) ripemd160Clone,
+   (HashAlgoExportState) ripemd160ExportState,
+   (HashAlgoImportState) ripemd160ImportState
 };
 
 
@@ -216,6 +220,105 @@ void ripemd160Final(Ripemd160Context *context, uint8_t *digest)
 }
 
 
+/**
+ * @brief Copy a RIPEMD-160 context
+ *
+ * The intermediate hash value, the counters and the pending bytes are copied
+ *
+ * @param[out] destContext Pointer to the destination context
+ * @param[in] srcContext Pointer to the RIPEMD-160 context to be copied
+ **/
+
+void ripemd160Clone(Ripemd160Context *destContext,
+   const Ripemd160Context *srcContext)
+{
+   //Copy the intermediate hash value
+   memcpy(destContext->h, srcContext->h, sizeof(srcContext->h));
+   //Copy the data that have not been processed yet
+   memcpy(destContext->buffer, srcContext->buffer, srcContext->size);
+
+   //Number of bytes in the buffer
+   destContext->size = srcContext->size;
+   //Total length of the message
+   destContext->totalSize = srcContext->totalSize;
+}
+
+
+/**
+ * @brief Export the state of a RIPEMD-160 context
+ *
+ * The serialized state is made of the intermediate hash value (five
+ * little-endian 32-bit words), the total length of the message (big-endian
+ * 64-bit integer, in bytes) and the data that have not been processed yet
+ *
+ * @param[in] context Pointer to the RIPEMD-160 context
+ * @param[out] output Serialized state (at most RIPEMD160_STATE_SIZE bytes)
+ * @return Length of the serialized state
+ **/
+
+size_t ripemd160ExportState(const Ripemd160Context *context, uint8_t *output)
+{
+   uint_t i;
+
+   //Intermediate hash value
+   for(i = 0; i < 5; i++)
+      STORE32LE(context->h[i], output + i * 4);
+
+   //Total length of the message
+   STORE64BE(context->totalSize, output + RIPEMD160_DIGEST_SIZE);
+   //Data that have not been processed yet
+   memcpy(output + RIPEMD160_DIGEST_SIZE + 8, context->buffer, context->size);
+
+   //Return the length of the serialized state
+   return RIPEMD160_DIGEST_SIZE + 8 + context->size;
+}
+
+
+/**
+ * @brief Import the state of a RIPEMD-160 context
+ * @param[out] context Pointer to the RIPEMD-160 context to initialize
+ * @param[in] input Serialized state (see ripemd160ExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t ripemd160ImportState(Ripemd160Context *context, const uint8_t *input,
+   size_t length)
+{
+   uint_t i;
+   size_t n;
+   uint64_t totalSize;
+
+   //Check the length of the serialized state
+   if(length < (RIPEMD160_DIGEST_SIZE + 8))
+      return ERROR_INVALID_LENGTH;
+
+   //Total length of the message
+   totalSize = LOAD64BE(input + RIPEMD160_DIGEST_SIZE);
+   //Number of bytes that have not been processed yet
+   n = (size_t) (totalSize % RIPEMD160_BLOCK_SIZE);
+
+   //The pending bytes must match the length of the message
+   if(length != (RIPEMD160_DIGEST_SIZE + 8 + n))
+      return ERROR_INVALID_LENGTH;
+
+   //Intermediate hash value
+   for(i = 0; i < 5; i++)
+      context->h[i] = LOAD32LE(input + i * 4);
+
+   //Data that have not been processed yet
+   memcpy(context->buffer, input + RIPEMD160_DIGEST_SIZE + 8, n);
+
+   //Number of bytes in the buffer
+   context->size = n;
+   //Total length of the message
+   context->totalSize = totalSize;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Process message in 16-word blocks
  * @param[in] context Pointer to the RIPEMD-160 context
@@ -36,6 +36,8 @@
 #define RIPEMD160_BLOCK_SIZE 64
 //RIPEMD-160 digest size
 #define RIPEMD160_DIGEST_SIZE 20
+//RIPEMD-160 maximum size of the exported state
+#define RIPEMD160_STATE_SIZE (RIPEMD160_DIGEST_SIZE + 8 + RIPEMD160_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define RIPEMD160_HASH_ALGO (&ripemd160HashAlgo)
 
@@ -74,6 +76,9 @@ error_t ripemd160Compute(const void *data, size_t length, uint8_t *digest);
 void ripemd160Init(Ripemd160Context *context);
 void ripemd160Update(Ripemd160Context *context, const void *data, size_t length);
 void ripemd160Final(Ripemd160Context *context, uint8_t *digest);
+void ripemd160Clone(Ripemd160Context *destContext, const Ripemd160Context *srcContext);
+size_t ripemd160ExportState(const Ripemd160Context *context, uint8_t *output);
+error_t ripemd160ImportState(Ripemd160Context *context, const uint8_t *input, size_t length);
 void ripemd160ProcessBlock(Ripemd160Context *context);
 
 //C++ guard
@@ -38,6 +38,15 @@
 #include <string.h>
 #include "crypto.h"
 #include "sha1.h"
+#include "cpu_features.h"
+
+//SHA instruction set extensions or SIMD support?
+#if ((SHA_EXT_SUPPORT == ENABLED || SIMD_SUPPORT == ENABLED) && defined(CPU_FEATURES_X86))
+   #include <immintrin.h>
+#elif ((SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_ARM_SHA)) || \
+   (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_NEON)))
+   #include <arm_neon.h>
+#endif
 
 //Check crypto library configuration
 #if (SHA1_SUPPORT == ENABLED)
@@ -80,10 +89,14 @@ const HashAlgo sha1HashAlgo =
    sizeof(Sha1Context),
    SHA1_BLOCK_SIZE,
    SHA1_DIGEST_SIZE,
+   SHA1_STATE_SIZE,
    (HashAlgoCompute) sha1Compute,
    (HashAlgoInit) sha1Init,
    (HashAlgoUpdate) sha1Update,
-   (HashAlgoFinal) sha1Final
+   (HashAlgoFinal) sha1Final,
+   (HashAlgoClone) sha1Clone,
+   (HashAlgoExportState) sha1ExportState,
+   (HashAlgoImportState) sha1ImportState
 };
 
 
@@ -219,6 +232,254 @@ void sha1Final(Sha1Context *context, uint8_t *digest)
 }
 
 
+/**
+ * @brief Copy a SHA-1 context
+ *
+ * The intermediate hash value, the counters and the pending bytes are copied
+ *
+ * @param[out] destContext Pointer to the destination context
+ * @param[in] srcContext Pointer to the SHA-1 context to be copied
+ **/
+
+void sha1Clone(Sha1Context *destContext, const Sha1Context *srcContext)
+{
+   //Copy the intermediate hash value
+   memcpy(destContext->h, srcContext->h, sizeof(srcContext->h));
+   //Copy the data that have not been processed yet
+   memcpy(destContext->buffer, srcContext->buffer, srcContext->size);
+
+   //Number of bytes in the buffer
+   destContext->size = srcContext->size;
+   //Total length of the message
+   destContext->totalSize = srcContext->totalSize;
+}
+
+
+/**
+ * @brief Export the state of a SHA-1 context
+ *
+ * The serialized state is made of the intermediate hash value (five
+ * big-endian 32-bit words), the total length of the message (big-endian
+ * 64-bit integer, in bytes) and the data that have not been processed yet
+ *
+ * @param[in] context Pointer to the SHA-1 context
+ * @param[out] output Serialized state (at most SHA1_STATE_SIZE bytes)
+ * @return Length of the serialized state
+ **/
+
+size_t sha1ExportState(const Sha1Context *context, uint8_t *output)
+{
+   uint_t i;
+
+   //Intermediate hash value
+   for(i = 0; i < 5; i++)
+      STORE32BE(context->h[i], output + i * 4);
+
+   //Total length of the message
+   STORE64BE(context->totalSize, output + SHA1_DIGEST_SIZE);
+   //Data that have not been processed yet
+   memcpy(output + SHA1_DIGEST_SIZE + 8, context->buffer, context->size);
+
+   //Return the length of the serialized state
+   return SHA1_DIGEST_SIZE + 8 + context->size;
+}
+
+
+/**
+ * @brief Import the state of a SHA-1 context
+ * @param[out] context Pointer to the SHA-1 context to initialize
+ * @param[in] input Serialized state (see sha1ExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t sha1ImportState(Sha1Context *context, const uint8_t *input,
+   size_t length)
+{
+   uint_t i;
+   size_t n;
+   uint64_t totalSize;
+
+   //Check the length of the serialized state
+   if(length < (SHA1_DIGEST_SIZE + 8))
+      return ERROR_INVALID_LENGTH;
+
+   //Total length of the message
+   totalSize = LOAD64BE(input + SHA1_DIGEST_SIZE);
+   //Number of bytes that have not been processed yet
+   n = (size_t) (totalSize % SHA1_BLOCK_SIZE);
+
+   //The pending bytes must match the length of the message
+   if(length != (SHA1_DIGEST_SIZE + 8 + n))
+      return ERROR_INVALID_LENGTH;
+
+   //Intermediate hash value
+   for(i = 0; i < 5; i++)
+      context->h[i] = LOAD32BE(input + i * 4);
+
+   //Data that have not been processed yet
+   memcpy(context->buffer, input + SHA1_DIGEST_SIZE + 8, n);
+
+   //Number of bytes in the buffer
+   context->size = n;
+   //Total length of the message
+   context->totalSize = totalSize;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+//SHA instruction set extensions on x86 targets?
+#if (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+//Required CPU features
+#define SHA1_SHANI_FEATURES (CPU_FEATURE_SSSE3 | CPU_FEATURE_SSE41 | CPU_FEATURE_SHA)
+
+
+/**
+ * @brief Process a 64-byte block using Intel SHA extensions
+ * @param[in,out] h Intermediate hash value
+ * @param[in] data Pointer to the 64-byte block
+ **/
+
+CPU_TARGET("sha,sse4.1") static void sha1ShaniProcessBlock(uint32_t *h,
+   const uint8_t *data)
+{
+   uint_t i;
+   __m128i abcd;
+   __m128i e;
+   __m128i prev;
+   __m128i save0;
+   __m128i save1;
+   __m128i mask;
+   __m128i m[4];
+
+   //Byte order mask
+   mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090A0B0C0D0E0FULL);
+
+   //Load the current state (A in the most significant word)
+   abcd = _mm_shuffle_epi32(_mm_loadu_si128((__m128i *) h), 0x1B);
+   e = _mm_set_epi32(h[4], 0, 0, 0);
+
+   //Save the current state
+   save0 = abcd;
+   save1 = e;
+
+   //Each iteration performs 4 rounds
+   for(i = 0; i < 20; i++)
+   {
+      //Prepare the message schedule
+      if(i < 4)
+      {
+         //Convert from big-endian byte order
+         m[i] = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *) (data + 16 * i)), mask);
+      }
+      else
+      {
+         //W(t) = ROL32(W(t - 3) ^ W(t - 8) ^ W(t - 14) ^ W(t - 16), 1)
+         m[i % 4] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(m[i % 4],
+            m[(i + 1) % 4]), m[(i + 2) % 4]), m[(i + 3) % 4]);
+      }
+
+      //Compute E + W(t)
+      if(i == 0)
+         e = _mm_add_epi32(e, m[0]);
+      else
+         e = _mm_sha1nexte_epu32(e, m[i % 4]);
+
+      //Perform 4 rounds (the round function and the constant are selected
+      //by an immediate operand)
+      prev = abcd;
+
+      if(i < 5)
+         abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+      else if(i < 10)
+         abcd = _mm_sha1rnds4_epu32(abcd, e, 1);
+      else if(i < 15)
+         abcd = _mm_sha1rnds4_epu32(abcd, e, 2);
+      else
+         abcd = _mm_sha1rnds4_epu32(abcd, e, 3);
+
+      //The value of E for the next rounds is derived from A
+      e = prev;
+   }
+
+   //Update the hash value
+   e = _mm_sha1nexte_epu32(e, save1);
+   abcd = _mm_add_epi32(abcd, save0);
+
+   //Save the hash value
+   _mm_storeu_si128((__m128i *) h, _mm_shuffle_epi32(abcd, 0x1B));
+   h[4] = _mm_extract_epi32(e, 3);
+}
+
+#endif
+
+
+//SHA instruction set extensions on ARM targets?
+#if (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_ARM_SHA))
+
+/**
+ * @brief Process a 64-byte block using ARMv8 SHA-1 instructions
+ * @param[in,out] h Intermediate hash value
+ * @param[in] data Pointer to the 64-byte block
+ **/
+
+static void sha1ArmProcessBlock(uint32_t *h, const uint8_t *data)
+{
+   uint_t i;
+   uint32_t e;
+   uint32_t next;
+   uint32x4_t abcd;
+   uint32x4_t temp;
+   uint32x4_t m[4];
+
+   //Load the current state
+   abcd = vld1q_u32(h);
+   e = h[4];
+
+   //Each iteration performs 4 rounds
+   for(i = 0; i < 20; i++)
+   {
+      //Prepare the message schedule
+      if(i < 4)
+      {
+         //Convert from big-endian byte order
+         m[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+      }
+      else
+      {
+         //W(t) = ROL32(W(t - 3) ^ W(t - 8) ^ W(t - 14) ^ W(t - 16), 1)
+         temp = vsha1su0q_u32(m[i % 4], m[(i + 1) % 4], m[(i + 2) % 4]);
+         m[i % 4] = vsha1su1q_u32(temp, m[(i + 3) % 4]);
+      }
+
+      //Add the round constant
+      temp = vaddq_u32(m[i % 4], vdupq_n_u32(k[i / 5]));
+
+      //The value of E for the next rounds is derived from A
+      next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+
+      //Perform 4 rounds
+      if(i < 5)
+         abcd = vsha1cq_u32(abcd, e, temp);
+      else if(i < 10 || i >= 15)
+         abcd = vsha1pq_u32(abcd, e, temp);
+      else
+         abcd = vsha1mq_u32(abcd, e, temp);
+
+      e = next;
+   }
+
+   //Update the hash value
+   vst1q_u32(h, vaddq_u32(abcd, vld1q_u32(h)));
+   h[4] += e;
+}
+
+#endif
+
+
 /**
  * @brief Process message in 16-word blocks
  * @param[in] context Pointer to the SHA-1 context
@@ -228,16 +489,35 @@ void sha1ProcessBlock(Sha1Context *context)
 {
    uint_t t;
    uint32_t temp;
+   uint32_t a;
+   uint32_t b;
+   uint32_t c;
+   uint32_t d;
+   uint32_t e;
+   uint32_t *w;
+
+#if (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //Use Intel SHA extensions when available
+   if((cpuGetFeatures() & SHA1_SHANI_FEATURES) == SHA1_SHANI_FEATURES)
+   {
+      sha1ShaniProcessBlock(context->h, context->buffer);
+      return;
+   }
+#elif (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_ARM_SHA))
+   //Use ARMv8 SHA-1 instructions
+   sha1ArmProcessBlock(context->h, context->buffer);
+   return;
+#endif
 
    //Initialize the 5 working registers
-   uint32_t a = context->h[0];
-   uint32_t b = context->h[1];
-   uint32_t c = context->h[2];
-   uint32_t d = context->h[3];
-   uint32_t e = context->h[4];
+   a = context->h[0];
+   b = context->h[1];
+   c = context->h[2];
+   d = context->h[3];
+   e = context->h[4];
 
    //Process message in 16-word blocks
-   uint32_t *w = context->w;
+   w = context->w;
 
    //Convert from big-endian byte order to host byte order
    for(t = 0; t < 16; t++)
@@ -276,4 +556,638 @@ void sha1ProcessBlock(Sha1Context *context)
    context->h[4] += e;
 }
 
+
+//SIMD support?
+#if (SIMD_SUPPORT == ENABLED)
+
+//Maximum number of lanes of the multi-buffer implementation
+#define SHA1_MAX_LANES 16
+
+//Workspace of the multi-buffer implementation
+#define WV(t) w[(t) & 0x0F]
+
+
+/**
+ * @brief Load one block of each lane, in structure-of-arrays layout
+ * @param[out] m Message words (word t of lane j is stored at m[t * lanes + j])
+ * @param[in] data Pointers to the blocks
+ * @param[in] lanes Number of lanes
+ **/
+
+static void sha1LoadBlocks(uint32_t *m, const uint8_t **data, uint_t lanes)
+{
+   uint_t j;
+   uint_t t;
+
+   //Convert from big-endian byte order to host byte order
+   for(t = 0; t < 16; t++)
+   {
+      for(j = 0; j < lanes; j++)
+         m[t * lanes + j] = LOAD32BE(data[j] + 4 * t);
+   }
+}
+
+
+//x86 or x86-64 target?
+#if defined(CPU_FEATURES_X86)
+
+//SHA-1 round function (SSE2)
+#define SHA1_SSE2_ROL(x, n) _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+#define SHA1_SSE2_CH(x, y, z) _mm_xor_si128(_mm_and_si128(x, y), _mm_andnot_si128(x, z))
+#define SHA1_SSE2_PARITY(x, y, z) _mm_xor_si128(_mm_xor_si128(x, y), z)
+#define SHA1_SSE2_MAJ(x, y, z) _mm_or_si128(_mm_and_si128(x, y), _mm_and_si128(z, _mm_or_si128(x, y)))
+
+#define SHA1_SSE2_ROUND(a, b, c, d, e, f, t) \
+{ \
+   if((t) >= 16) \
+      WV(t) = SHA1_SSE2_ROL(_mm_xor_si128(_mm_xor_si128(WV((t) + 13), WV((t) + 8)), _mm_xor_si128(WV((t) + 2), WV(t))), 1); \
+   e = _mm_add_epi32(_mm_add_epi32(e, SHA1_SSE2_ROL(a, 5)), _mm_add_epi32(f(b, c, d), _mm_add_epi32(_mm_set1_epi32(k[(t) / 20]), WV(t)))); \
+   b = SHA1_SSE2_ROL(b, 30); \
+}
+
+//SHA-1 round function (AVX2)
+#define SHA1_AVX2_ROL(x, n) _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - (n)))
+#define SHA1_AVX2_CH(x, y, z) _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define SHA1_AVX2_PARITY(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define SHA1_AVX2_MAJ(x, y, z) _mm256_or_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_or_si256(x, y)))
+
+#define SHA1_AVX2_ROUND(a, b, c, d, e, f, t) \
+{ \
+   if((t) >= 16) \
+      WV(t) = SHA1_AVX2_ROL(_mm256_xor_si256(_mm256_xor_si256(WV((t) + 13), WV((t) + 8)), _mm256_xor_si256(WV((t) + 2), WV(t))), 1); \
+   e = _mm256_add_epi32(_mm256_add_epi32(e, SHA1_AVX2_ROL(a, 5)), _mm256_add_epi32(f(b, c, d), _mm256_add_epi32(_mm256_set1_epi32(k[(t) / 20]), WV(t)))); \
+   b = SHA1_AVX2_ROL(b, 30); \
+}
+
+//SHA-1 round function (AVX-512)
+#define SHA1_AVX512_ROL(x, n) _mm512_rol_epi32(x, n)
+#define SHA1_AVX512_CH(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xCA)
+#define SHA1_AVX512_PARITY(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+#define SHA1_AVX512_MAJ(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xE8)
+
+#define SHA1_AVX512_ROUND(a, b, c, d, e, f, t) \
+{ \
+   if((t) >= 16) \
+      WV(t) = SHA1_AVX512_ROL(_mm512_ternarylogic_epi32(WV((t) + 13), WV((t) + 8), _mm512_xor_si512(WV((t) + 2), WV(t)), 0x96), 1); \
+   e = _mm512_add_epi32(_mm512_add_epi32(e, SHA1_AVX512_ROL(a, 5)), _mm512_add_epi32(f(b, c, d), _mm512_add_epi32(_mm512_set1_epi32(k[(t) / 20]), WV(t)))); \
+   b = SHA1_AVX512_ROL(b, 30); \
+}
+
+
+/**
+ * @brief Process blocks of 4 independent messages using SSE2 instructions
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of each lane
+ * @param[in] n Number of consecutive blocks to process in each lane
+ **/
+
+CPU_TARGET("sse2") static void sha1Sse2ProcessBlocks(uint32_t *h,
+   const uint8_t **data, size_t n)
+{
+   uint_t i;
+   uint_t t;
+   size_t j;
+   __m128i a, b, c, d, e;
+   __m128i s[5];
+   __m128i w[16];
+   uint32_t m[16 * 4];
+   const uint8_t *p[4];
+
+   //Load the intermediate hash values
+   for(i = 0; i < 5; i++)
+      s[i] = _mm_loadu_si128((__m128i *) (h + 4 * i));
+
+   //Point to the first block of each lane
+   for(i = 0; i < 4; i++)
+      p[i] = data[i];
+
+   //Process the blocks
+   for(j = 0; j < n; j++)
+   {
+      //Transpose the message words
+      sha1LoadBlocks(m, p, 4);
+
+      for(t = 0; t < 16; t++)
+         w[t] = _mm_loadu_si128((__m128i *) (m + 4 * t));
+
+      //Initialize the 5 working registers
+      a = s[0];
+      b = s[1];
+      c = s[2];
+      d = s[3];
+      e = s[4];
+
+      //SHA-1 hash computation
+      for(t = 0; t < 20; t += 5)
+      {
+         SHA1_SSE2_ROUND(a, b, c, d, e, SHA1_SSE2_CH, t);
+         SHA1_SSE2_ROUND(e, a, b, c, d, SHA1_SSE2_CH, t + 1);
+         SHA1_SSE2_ROUND(d, e, a, b, c, SHA1_SSE2_CH, t + 2);
+         SHA1_SSE2_ROUND(c, d, e, a, b, SHA1_SSE2_CH, t + 3);
+         SHA1_SSE2_ROUND(b, c, d, e, a, SHA1_SSE2_CH, t + 4);
+      }
+
+      for(t = 20; t < 40; t += 5)
+      {
+         SHA1_SSE2_ROUND(a, b, c, d, e, SHA1_SSE2_PARITY, t);
+         SHA1_SSE2_ROUND(e, a, b, c, d, SHA1_SSE2_PARITY, t + 1);
+         SHA1_SSE2_ROUND(d, e, a, b, c, SHA1_SSE2_PARITY, t + 2);
+         SHA1_SSE2_ROUND(c, d, e, a, b, SHA1_SSE2_PARITY, t + 3);
+         SHA1_SSE2_ROUND(b, c, d, e, a, SHA1_SSE2_PARITY, t + 4);
+      }
+
+      for(t = 40; t < 60; t += 5)
+      {
+         SHA1_SSE2_ROUND(a, b, c, d, e, SHA1_SSE2_MAJ, t);
+         SHA1_SSE2_ROUND(e, a, b, c, d, SHA1_SSE2_MAJ, t + 1);
+         SHA1_SSE2_ROUND(d, e, a, b, c, SHA1_SSE2_MAJ, t + 2);
+         SHA1_SSE2_ROUND(c, d, e, a, b, SHA1_SSE2_MAJ, t + 3);
+         SHA1_SSE2_ROUND(b, c, d, e, a, SHA1_SSE2_MAJ, t + 4);
+      }
+
+      for(t = 60; t < 80; t += 5)
+      {
+         SHA1_SSE2_ROUND(a, b, c, d, e, SHA1_SSE2_PARITY, t);
+         SHA1_SSE2_ROUND(e, a, b, c, d, SHA1_SSE2_PARITY, t + 1);
+         SHA1_SSE2_ROUND(d, e, a, b, c, SHA1_SSE2_PARITY, t + 2);
+         SHA1_SSE2_ROUND(c, d, e, a, b, SHA1_SSE2_PARITY, t + 3);
+         SHA1_SSE2_ROUND(b, c, d, e, a, SHA1_SSE2_PARITY, t + 4);
+      }
+
+      //Update the hash values
+      s[0] = _mm_add_epi32(s[0], a);
+      s[1] = _mm_add_epi32(s[1], b);
+      s[2] = _mm_add_epi32(s[2], c);
+      s[3] = _mm_add_epi32(s[3], d);
+      s[4] = _mm_add_epi32(s[4], e);
+
+      //Next blocks
+      for(i = 0; i < 4; i++)
+         p[i] += 64;
+   }
+
+   //Save the intermediate hash values
+   for(i = 0; i < 5; i++)
+      _mm_storeu_si128((__m128i *) (h + 4 * i), s[i]);
+}
+
+
+/**
+ * @brief Process blocks of 8 independent messages using AVX2 instructions
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of each lane
+ * @param[in] n Number of consecutive blocks to process in each lane
+ **/
+
+CPU_TARGET("avx2") static void sha1Avx2ProcessBlocks(uint32_t *h,
+   const uint8_t **data, size_t n)
+{
+   uint_t i;
+   uint_t t;
+   size_t j;
+   __m256i a, b, c, d, e;
+   __m256i s[5];
+   __m256i w[16];
+   uint32_t m[16 * 8];
+   const uint8_t *p[8];
+
+   //Load the intermediate hash values
+   for(i = 0; i < 5; i++)
+      s[i] = _mm256_loadu_si256((__m256i *) (h + 8 * i));
+
+   //Point to the first block of each lane
+   for(i = 0; i < 8; i++)
+      p[i] = data[i];
+
+   //Process the blocks
+   for(j = 0; j < n; j++)
+   {
+      //Transpose the message words
+      sha1LoadBlocks(m, p, 8);
+
+      for(t = 0; t < 16; t++)
+         w[t] = _mm256_loadu_si256((__m256i *) (m + 8 * t));
+
+      //Initialize the 5 working registers
+      a = s[0];
+      b = s[1];
+      c = s[2];
+      d = s[3];
+      e = s[4];
+
+      //SHA-1 hash computation
+      for(t = 0; t < 20; t += 5)
+      {
+         SHA1_AVX2_ROUND(a, b, c, d, e, SHA1_AVX2_CH, t);
+         SHA1_AVX2_ROUND(e, a, b, c, d, SHA1_AVX2_CH, t + 1);
+         SHA1_AVX2_ROUND(d, e, a, b, c, SHA1_AVX2_CH, t + 2);
+         SHA1_AVX2_ROUND(c, d, e, a, b, SHA1_AVX2_CH, t + 3);
+         SHA1_AVX2_ROUND(b, c, d, e, a, SHA1_AVX2_CH, t + 4);
+      }
+
+      for(t = 20; t < 40; t += 5)
+      {
+         SHA1_AVX2_ROUND(a, b, c, d, e, SHA1_AVX2_PARITY, t);
+         SHA1_AVX2_ROUND(e, a, b, c, d, SHA1_AVX2_PARITY, t + 1);
+         SHA1_AVX2_ROUND(d, e, a, b, c, SHA1_AVX2_PARITY, t + 2);
+         SHA1_AVX2_ROUND(c, d, e, a, b, SHA1_AVX2_PARITY, t + 3);
+         SHA1_AVX2_ROUND(b, c, d, e, a, SHA1_AVX2_PARITY, t + 4);
+      }
+
+      for(t = 40; t < 60; t += 5)
+      {
+         SHA1_AVX2_ROUND(a, b, c, d, e, SHA1_AVX2_MAJ, t);
+         SHA1_AVX2_ROUND(e, a, b, c, d, SHA1_AVX2_MAJ, t + 1);
+         SHA1_AVX2_ROUND(d, e, a, b, c, SHA1_AVX2_MAJ, t + 2);
+         SHA1_AVX2_ROUND(c, d, e, a, b, SHA1_AVX2_MAJ, t + 3);
+         SHA1_AVX2_ROUND(b, c, d, e, a, SHA1_AVX2_MAJ, t + 4);
+      }
+
+      for(t = 60; t < 80; t += 5)
+      {
+         SHA1_AVX2_ROUND(a, b, c, d, e, SHA1_AVX2_PARITY, t);
+         SHA1_AVX2_ROUND(e, a, b, c, d, SHA1_AVX2_PARITY, t + 1);
+         SHA1_AVX2_ROUND(d, e, a, b, c, SHA1_AVX2_PARITY, t + 2);
+         SHA1_AVX2_ROUND(c, d, e, a, b, SHA1_AVX2_PARITY, t + 3);
+         SHA1_AVX2_ROUND(b, c, d, e, a, SHA1_AVX2_PARITY, t + 4);
+      }
+
+      //Update the hash values
+      s[0] = _mm256_add_epi32(s[0], a);
+      s[1] = _mm256_add_epi32(s[1], b);
+      s[2] = _mm256_add_epi32(s[2], c);
+      s[3] = _mm256_add_epi32(s[3], d);
+      s[4] = _mm256_add_epi32(s[4], e);
+
+      //Next blocks
+      for(i = 0; i < 8; i++)
+         p[i] += 64;
+   }
+
+   //Save the intermediate hash values
+   for(i = 0; i < 5; i++)
+      _mm256_storeu_si256((__m256i *) (h + 8 * i), s[i]);
+}
+
+
+/**
+ * @brief Process blocks of 16 independent messages using AVX-512 instructions
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of each lane
+ * @param[in] n Number of consecutive blocks to process in each lane
+ **/
+
+CPU_TARGET("avx512f") static void sha1Avx512ProcessBlocks(uint32_t *h,
+   const uint8_t **data, size_t n)
+{
+   uint_t i;
+   uint_t t;
+   size_t j;
+   __m512i a, b, c, d, e;
+   __m512i s[5];
+   __m512i w[16];
+   uint32_t m[16 * 16];
+   const uint8_t *p[16];
+
+   //Load the intermediate hash values
+   for(i = 0; i < 5; i++)
+      s[i] = _mm512_loadu_si512((h + 16 * i));
+
+   //Point to the first block of each lane
+   for(i = 0; i < 16; i++)
+      p[i] = data[i];
+
+   //Process the blocks
+   for(j = 0; j < n; j++)
+   {
+      //Transpose the message words
+      sha1LoadBlocks(m, p, 16);
+
+      for(t = 0; t < 16; t++)
+         w[t] = _mm512_loadu_si512((m + 16 * t));
+
+      //Initialize the 5 working registers
+      a = s[0];
+      b = s[1];
+      c = s[2];
+      d = s[3];
+      e = s[4];
+
+      //SHA-1 hash computation
+      for(t = 0; t < 20; t += 5)
+      {
+         SHA1_AVX512_ROUND(a, b, c, d, e, SHA1_AVX512_CH, t);
+         SHA1_AVX512_ROUND(e, a, b, c, d, SHA1_AVX512_CH, t + 1);
+         SHA1_AVX512_ROUND(d, e, a, b, c, SHA1_AVX512_CH, t + 2);
+         SHA1_AVX512_ROUND(c, d, e, a, b, SHA1_AVX512_CH, t + 3);
+         SHA1_AVX512_ROUND(b, c, d, e, a, SHA1_AVX512_CH, t + 4);
+      }
+
+      for(t = 20; t < 40; t += 5)
+      {
+         SHA1_AVX512_ROUND(a, b, c, d, e, SHA1_AVX512_PARITY, t);
+         SHA1_AVX512_ROUND(e, a, b, c, d, SHA1_AVX512_PARITY, t + 1);
+         SHA1_AVX512_ROUND(d, e, a, b, c, SHA1_AVX512_PARITY, t + 2);
+         SHA1_AVX512_ROUND(c, d, e, a, b, SHA1_AVX512_PARITY, t + 3);
+         SHA1_AVX512_ROUND(b, c, d, e, a, SHA1_AVX512_PARITY, t + 4);
+      }
+
+      for(t = 40; t < 60; t += 5)
+      {
+         SHA1_AVX512_ROUND(a, b, c, d, e, SHA1_AVX512_MAJ, t);
+         SHA1_AVX512_ROUND(e, a, b, c, d, SHA1_AVX512_MAJ, t + 1);
+         SHA1_AVX512_ROUND(d, e, a, b, c, SHA1_AVX512_MAJ, t + 2);
+         SHA1_AVX512_ROUND(c, d, e, a, b, SHA1_AVX512_MAJ, t + 3);
+         SHA1_AVX512_ROUND(b, c, d, e, a, SHA1_AVX512_MAJ, t + 4);
+      }
+
+      for(t = 60; t < 80; t += 5)
+      {
+         SHA1_AVX512_ROUND(a, b, c, d, e, SHA1_AVX512_PARITY, t);
+         SHA1_AVX512_ROUND(e, a, b, c, d, SHA1_AVX512_PARITY, t + 1);
+         SHA1_AVX512_ROUND(d, e, a, b, c, SHA1_AVX512_PARITY, t + 2);
+         SHA1_AVX512_ROUND(c, d, e, a, b, SHA1_AVX512_PARITY, t + 3);
+         SHA1_AVX512_ROUND(b, c, d, e, a, SHA1_AVX512_PARITY, t + 4);
+      }
+
+      //Update the hash values
+      s[0] = _mm512_add_epi32(s[0], a);
+      s[1] = _mm512_add_epi32(s[1], b);
+      s[2] = _mm512_add_epi32(s[2], c);
+      s[3] = _mm512_add_epi32(s[3], d);
+      s[4] = _mm512_add_epi32(s[4], e);
+
+      //Next blocks
+      for(i = 0; i < 16; i++)
+         p[i] += 64;
+   }
+
+   //Save the intermediate hash values
+   for(i = 0; i < 5; i++)
+      _mm512_storeu_si512((h + 16 * i), s[i]);
+}
+
+//ARM target with NEON instructions?
+#else
+
+//SHA-1 round function (NEON)
+#define SHA1_NEON_ROL(x, n) vsriq_n_u32(vshlq_n_u32(x, n), x, 32 - (n))
+#define SHA1_NEON_CH(x, y, z) vbslq_u32(x, y, z)
+#define SHA1_NEON_PARITY(x, y, z) veorq_u32(veorq_u32(x, y), z)
+#define SHA1_NEON_MAJ(x, y, z) vbslq_u32(veorq_u32(x, y), z, y)
+
+#define SHA1_NEON_ROUND(a, b, c, d, e, f, t) \
+{ \
+   if((t) >= 16) \
+      WV(t) = SHA1_NEON_ROL(veorq_u32(veorq_u32(WV((t) + 13), WV((t) + 8)), veorq_u32(WV((t) + 2), WV(t))), 1); \
+   e = vaddq_u32(vaddq_u32(e, SHA1_NEON_ROL(a, 5)), vaddq_u32(f(b, c, d), vaddq_u32(vdupq_n_u32(k[(t) / 20]), WV(t)))); \
+   b = SHA1_NEON_ROL(b, 30); \
+}
+
+
+/**
+ * @brief Process blocks of 4 independent messages using NEON instructions
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of each lane
+ * @param[in] n Number of consecutive blocks to process in each lane
+ **/
+
+static void sha1NeonProcessBlocks(uint32_t *h,
+   const uint8_t **data, size_t n)
+{
+   uint_t i;
+   uint_t t;
+   size_t j;
+   uint32x4_t a, b, c, d, e;
+   uint32x4_t s[5];
+   uint32x4_t w[16];
+   uint32_t m[16 * 4];
+   const uint8_t *p[4];
+
+   //Load the intermediate hash values
+   for(i = 0; i < 5; i++)
+      s[i] = vld1q_u32(h + 4 * i);
+
+   //Point to the first block of each lane
+   for(i = 0; i < 4; i++)
+      p[i] = data[i];
+
+   //Process the blocks
+   for(j = 0; j < n; j++)
+   {
+      //Transpose the message words
+      sha1LoadBlocks(m, p, 4);
+
+      for(t = 0; t < 16; t++)
+         w[t] = vld1q_u32(m + 4 * t);
+
+      //Initialize the 5 working registers
+      a = s[0];
+      b = s[1];
+      c = s[2];
+      d = s[3];
+      e = s[4];
+
+      //SHA-1 hash computation
+      for(t = 0; t < 20; t += 5)
+      {
+         SHA1_NEON_ROUND(a, b, c, d, e, SHA1_NEON_CH, t);
+         SHA1_NEON_ROUND(e, a, b, c, d, SHA1_NEON_CH, t + 1);
+         SHA1_NEON_ROUND(d, e, a, b, c, SHA1_NEON_CH, t + 2);
+         SHA1_NEON_ROUND(c, d, e, a, b, SHA1_NEON_CH, t + 3);
+         SHA1_NEON_ROUND(b, c, d, e, a, SHA1_NEON_CH, t + 4);
+      }
+
+      for(t = 20; t < 40; t += 5)
+      {
+         SHA1_NEON_ROUND(a, b, c, d, e, SHA1_NEON_PARITY, t);
+         SHA1_NEON_ROUND(e, a, b, c, d, SHA1_NEON_PARITY, t + 1);
+         SHA1_NEON_ROUND(d, e, a, b, c, SHA1_NEON_PARITY, t + 2);
+         SHA1_NEON_ROUND(c, d, e, a, b, SHA1_NEON_PARITY, t + 3);
+         SHA1_NEON_ROUND(b, c, d, e, a, SHA1_NEON_PARITY, t + 4);
+      }
+
+      for(t = 40; t < 60; t += 5)
+      {
+         SHA1_NEON_ROUND(a, b, c, d, e, SHA1_NEON_MAJ, t);
+         SHA1_NEON_ROUND(e, a, b, c, d, SHA1_NEON_MAJ, t + 1);
+         SHA1_NEON_ROUND(d, e, a, b, c, SHA1_NEON_MAJ, t + 2);
+         SHA1_NEON_ROUND(c, d, e, a, b, SHA1_NEON_MAJ, t + 3);
+         SHA1_NEON_ROUND(b, c, d, e, a, SHA1_NEON_MAJ, t + 4);
+      }
+
+      for(t = 60; t < 80; t += 5)
+      {
+         SHA1_NEON_ROUND(a, b, c, d, e, SHA1_NEON_PARITY, t);
+         SHA1_NEON_ROUND(e, a, b, c, d, SHA1_NEON_PARITY, t + 1);
+         SHA1_NEON_ROUND(d, e, a, b, c, SHA1_NEON_PARITY, t + 2);
+         SHA1_NEON_ROUND(c, d, e, a, b, SHA1_NEON_PARITY, t + 3);
+         SHA1_NEON_ROUND(b, c, d, e, a, SHA1_NEON_PARITY, t + 4);
+      }
+
+      //Update the hash values
+      s[0] = vaddq_u32(s[0], a);
+      s[1] = vaddq_u32(s[1], b);
+      s[2] = vaddq_u32(s[2], c);
+      s[3] = vaddq_u32(s[3], d);
+      s[4] = vaddq_u32(s[4], e);
+
+      //Next blocks
+      for(i = 0; i < 4; i++)
+         p[i] += 64;
+   }
+
+   //Save the intermediate hash values
+   for(i = 0; i < 5; i++)
+      vst1q_u32(h + 4 * i, s[i]);
+}
+
+#endif
+
+
+/**
+ * @brief Select the multi-buffer implementation
+ * @return Number of lanes (0 if the single-buffer code is faster)
+ **/
+
+static uint_t sha1GetLanes(void)
+{
+#if defined(CPU_FEATURES_X86)
+   uint32_t features;
+
+   //Retrieve the instruction set extensions supported by the CPU
+   features = cpuGetFeatures();
+
+   //SHA extensions outperform the 4-way and 8-way implementations
+   if((features & CPU_FEATURE_AVX512F) != 0)
+      return 16;
+#if (SHA_EXT_SUPPORT == ENABLED)
+   else if((features & SHA1_SHANI_FEATURES) == SHA1_SHANI_FEATURES)
+      return 0;
+#endif
+   else if((features & CPU_FEATURE_AVX2) != 0)
+      return 8;
+   else if((features & CPU_FEATURE_SSE2) != 0)
+      return 4;
+   else
+      return 0;
+#elif (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_ARM_SHA))
+   //SHA-1 instructions are faster than the 4-way implementation
+   return 0;
+#else
+   //4-way implementation
+   return 4;
+#endif
+}
+
+
+/**
+ * @brief Process n blocks of each lane
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of the lanes
+ * @param[in] n Number of blocks to be processed in every lane
+ * @param[in] lanes Number of lanes
+ **/
+
+static void sha1ProcessLanes(uint32_t *h, const uint8_t **data, size_t n,
+   uint_t lanes)
+{
+#if defined(CPU_FEATURES_X86)
+   if(lanes == 16)
+      sha1Avx512ProcessBlocks(h, data, n);
+   else if(lanes == 8)
+      sha1Avx2ProcessBlocks(h, data, n);
+   else
+      sha1Sse2ProcessBlocks(h, data, n);
+#else
+   sha1NeonProcessBlocks(h, data, n);
+#endif
+}
+
+#endif
+
+
+/**
+ * @brief Process one block for each of several SHA-1 contexts
+ *
+ * The block held in the buffer of each context is processed and the
+ * intermediate hash value of the context is updated accordingly, as
+ * sha1ProcessBlock would do. The other fields of the contexts are left
+ * unchanged. When SIMD instructions are available, the blocks are processed
+ * in parallel, one context per lane
+ *
+ * @param[in,out] context Array of pointers to the SHA-1 contexts
+ * @param[in] count Number of contexts
+ **/
+
+void sha1ProcessBlockMulti(Sha1Context **context, uint_t count)
+{
+   uint_t i;
+#if (SIMD_SUPPORT == ENABLED)
+   uint_t j;
+   uint_t k;
+   uint_t n;
+   uint_t lanes;
+   uint_t threshold;
+   const uint8_t *data[SHA1_MAX_LANES];
+   uint32_t h[5 * SHA1_MAX_LANES];
+#endif
+
+   //Index of the first context to be processed
+   i = 0;
+
+#if (SIMD_SUPPORT == ENABLED)
+   //Select the multi-buffer implementation
+   lanes = sha1GetLanes();
+   //Minimum number of busy lanes for the multi-buffer code to be faster
+   threshold = lanes / 4 + 1;
+
+#if (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //The SHA extensions are faster than the 16-way implementation unless
+   //all the lanes are busy
+   if((cpuGetFeatures() & SHA1_SHANI_FEATURES) == SHA1_SHANI_FEATURES)
+      threshold = lanes;
+#endif
+
+   //Multi-buffer implementation available?
+   if(lanes > 0)
+   {
+      //Process the contexts by groups of at most lanes contexts
+      for(; i < count; i += n)
+      {
+         //Number of busy lanes
+         n = MIN(count - i, lanes);
+
+         //When too few lanes would be busy, the single-buffer code is faster
+         if(n < threshold)
+            break;
+
+         //Idle lanes process the block of the first context, and their
+         //results are discarded
+         for(j = 0; j < lanes; j++)
+         {
+            data[j] = context[(j < n) ? i + j : i]->buffer;
+
+            for(k = 0; k < 5; k++)
+               h[k * lanes + j] = context[(j < n) ? i + j : i]->h[k];
+         }
+
+         //Process one block of each lane
+         sha1ProcessLanes(h, data, 1, lanes);
+
+         //Update the intermediate hash values of the contexts
+         for(j = 0; j < n; j++)
+         {
+            for(k = 0; k < 5; k++)
+               context[i + j]->h[k] = h[k * lanes + j];
+         }
+      }
+   }
+#endif
+
+   //Process the remaining contexts one after the other
+   for(; i < count; i++)
+      sha1ProcessBlock(context[i]);
+}
+
 #endif
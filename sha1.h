@@ -36,6 +36,8 @@
 #define SHA1_BLOCK_SIZE 64
 //SHA-1 digest size
 #define SHA1_DIGEST_SIZE 20
+//SHA-1 maximum size of the exported state
+#define SHA1_STATE_SIZE (SHA1_DIGEST_SIZE + 8 + SHA1_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define SHA1_HASH_ALGO (&sha1HashAlgo)
 
@@ -74,7 +76,11 @@ error_t sha1Compute(const void *data, size_t length, uint8_t *digest);
 void sha1Init(Sha1Context *context);
 void sha1Update(Sha1Context *context, const void *data, size_t length);
 void sha1Final(Sha1Context *context, uint8_t *digest);
+void sha1Clone(Sha1Context *destContext, const Sha1Context *srcContext);
+size_t sha1ExportState(const Sha1Context *context, uint8_t *output);
+error_t sha1ImportState(Sha1Context *context, const uint8_t *input, size_t length);
 void sha1ProcessBlock(Sha1Context *context);
+void sha1ProcessBlockMulti(Sha1Context **context, uint_t count);
 
 //C++ guard
 #ifdef __cplusplus
@@ -54,10 +54,14 @@ const HashAlgo sha224HashAlgo =
    sizeof(Sha224Context),
    SHA224_BLOCK_SIZE,
    SHA224_DIGEST_SIZE,
+   SHA224_STATE_SIZE,
    (HashAlgoCompute) sha224Compute,
    (HashAlgoInit) sha224Init,
    (HashAlgoUpdate) sha224Update,
-   (HashAlgoFinal) sha224Final
+   (HashAlgoFinal) sha224Final,
+   (HashAlgoClone) sha256Clone,
+   (HashAlgoExportState) sha256ExportState,
+   (HashAlgoImportState) sha256ImportState
 };
 
 
@@ -37,6 +37,8 @@
 #define SHA224_BLOCK_SIZE 64
 //SHA-224 digest size
 #define SHA224_DIGEST_SIZE 28
+//SHA-224 maximum size of the exported state
+#define SHA224_STATE_SIZE SHA256_STATE_SIZE
 //Common interface for hash algorithms
 #define SHA224_HASH_ALGO (&sha224HashAlgo)
 
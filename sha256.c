@@ -38,6 +38,15 @@
 #include <string.h>
 #include "crypto.h"
 #include "sha256.h"
+#include "cpu_features.h"
+
+//SHA instruction set extensions or SIMD support?
+#if ((SHA_EXT_SUPPORT == ENABLED || SIMD_SUPPORT == ENABLED) && defined(CPU_FEATURES_X86))
+   #include <immintrin.h>
+#elif ((SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_ARM_SHA)) || \
+   (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_NEON)))
+   #include <arm_neon.h>
+#endif
 
 //Check crypto library configuration
 #if (SHA224_SUPPORT == ENABLED || SHA256_SUPPORT == ENABLED)
@@ -87,10 +96,14 @@ const HashAlgo sha256HashAlgo =
    sizeof(Sha256Context),
    SHA256_BLOCK_SIZE,
    SHA256_DIGEST_SIZE,
+   SHA256_STATE_SIZE,
    (HashAlgoCompute) sha256Compute,
    (HashAlgoInit) sha256Init,
    (HashAlgoUpdate) sha256Update,
-   (HashAlgoFinal) sha256Final
+   (HashAlgoFinal) sha256Final,
+   (HashAlgoClone) sha256Clone,
+   (HashAlgoExportState) sha256ExportState,
+   (HashAlgoImportState) sha256ImportState
 };
 
 
@@ -229,6 +242,241 @@ void sha256Final(Sha256Context *context, uint8_t *digest)
 }
 
 
+/**
+ * @brief Copy a SHA-256 context
+ *
+ * The intermediate hash value, the counters and the pending bytes are copied
+ *
+ * @param[out] destContext Pointer to the destination context
+ * @param[in] srcContext Pointer to the SHA-256 context to be copied
+ **/
+
+void sha256Clone(Sha256Context *destContext, const Sha256Context *srcContext)
+{
+   //Copy the intermediate hash value
+   memcpy(destContext->h, srcContext->h, sizeof(srcContext->h));
+   //Copy the data that have not been processed yet
+   memcpy(destContext->buffer, srcContext->buffer, srcContext->size);
+
+   //Number of bytes in the buffer
+   destContext->size = srcContext->size;
+   //Total length of the message
+   destContext->totalSize = srcContext->totalSize;
+}
+
+
+/**
+ * @brief Export the state of a SHA-256 context
+ *
+ * The serialized state is made of the intermediate hash value (eight
+ * big-endian 32-bit words), the total length of the message (big-endian
+ * 64-bit integer, in bytes) and the data that have not been processed yet
+ *
+ * @param[in] context Pointer to the SHA-256 context
+ * @param[out] output Serialized state (at most SHA256_STATE_SIZE bytes)
+ * @return Length of the serialized state
+ **/
+
+size_t sha256ExportState(const Sha256Context *context, uint8_t *output)
+{
+   uint_t i;
+
+   //Intermediate hash value
+   for(i = 0; i < 8; i++)
+      STORE32BE(context->h[i], output + i * 4);
+
+   //Total length of the message
+   STORE64BE(context->totalSize, output + SHA256_DIGEST_SIZE);
+   //Data that have not been processed yet
+   memcpy(output + SHA256_DIGEST_SIZE + 8, context->buffer, context->size);
+
+   //Return the length of the serialized state
+   return SHA256_DIGEST_SIZE + 8 + context->size;
+}
+
+
+/**
+ * @brief Import the state of a SHA-256 context
+ * @param[out] context Pointer to the SHA-256 context to initialize
+ * @param[in] input Serialized state (see sha256ExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t sha256ImportState(Sha256Context *context, const uint8_t *input,
+   size_t length)
+{
+   uint_t i;
+   size_t n;
+   uint64_t totalSize;
+
+   //Check the length of the serialized state
+   if(length < (SHA256_DIGEST_SIZE + 8))
+      return ERROR_INVALID_LENGTH;
+
+   //Total length of the message
+   totalSize = LOAD64BE(input + SHA256_DIGEST_SIZE);
+   //Number of bytes that have not been processed yet
+   n = (size_t) (totalSize % SHA256_BLOCK_SIZE);
+
+   //The pending bytes must match the length of the message
+   if(length != (SHA256_DIGEST_SIZE + 8 + n))
+      return ERROR_INVALID_LENGTH;
+
+   //Intermediate hash value
+   for(i = 0; i < 8; i++)
+      context->h[i] = LOAD32BE(input + i * 4);
+
+   //Data that have not been processed yet
+   memcpy(context->buffer, input + SHA256_DIGEST_SIZE + 8, n);
+
+   //Number of bytes in the buffer
+   context->size = n;
+   //Total length of the message
+   context->totalSize = totalSize;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+//SHA instruction set extensions on x86 targets?
+#if (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+//Required CPU features
+#define SHA256_SHANI_FEATURES (CPU_FEATURE_SSSE3 | CPU_FEATURE_SSE41 | CPU_FEATURE_SHA)
+
+
+/**
+ * @brief Process a 64-byte block using Intel SHA extensions
+ * @param[in,out] h Intermediate hash value
+ * @param[in] data Pointer to the 64-byte block
+ **/
+
+CPU_TARGET("sha,sse4.1") static void sha256ShaniProcessBlock(uint32_t *h,
+   const uint8_t *data)
+{
+   uint_t i;
+   __m128i state0;
+   __m128i state1;
+   __m128i save0;
+   __m128i save1;
+   __m128i temp;
+   __m128i mask;
+   __m128i m[4];
+
+   //Byte order mask
+   mask = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+
+   //The SHA256RNDS2 instruction operates on the ABEF and CDGH halves
+   //of the state
+   temp = _mm_shuffle_epi32(_mm_loadu_si128((__m128i *) h), 0xB1);
+   state1 = _mm_shuffle_epi32(_mm_loadu_si128((__m128i *) (h + 4)), 0x1B);
+   state0 = _mm_alignr_epi8(temp, state1, 8);
+   state1 = _mm_blend_epi16(state1, temp, 0xF0);
+
+   //Save the current state
+   save0 = state0;
+   save1 = state1;
+
+   //Each iteration performs 4 rounds
+   for(i = 0; i < 16; i++)
+   {
+      //Prepare the message schedule
+      if(i < 4)
+      {
+         //Convert from big-endian byte order
+         m[i] = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *) (data + 16 * i)), mask);
+      }
+      else
+      {
+         //W(t) = SIGMA4(W(t - 2)) + W(t - 7) + SIGMA3(W(t - 15)) + W(t - 16)
+         temp = _mm_sha256msg1_epu32(m[i % 4], m[(i + 1) % 4]);
+         temp = _mm_add_epi32(temp, _mm_alignr_epi8(m[(i + 3) % 4], m[(i + 2) % 4], 4));
+         m[i % 4] = _mm_sha256msg2_epu32(temp, m[(i + 3) % 4]);
+      }
+
+      //Add the round constants
+      temp = _mm_add_epi32(m[i % 4], _mm_loadu_si128((__m128i *) (k + 4 * i)));
+
+      //Perform 2 x 2 rounds
+      state1 = _mm_sha256rnds2_epu32(state1, state0, temp);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(temp, 0x0E));
+   }
+
+   //Update the hash value
+   state0 = _mm_add_epi32(state0, save0);
+   state1 = _mm_add_epi32(state1, save1);
+
+   //Convert the state back to ABCD and EFGH
+   temp = _mm_shuffle_epi32(state0, 0x1B);
+   state1 = _mm_shuffle_epi32(state1, 0xB1);
+   state0 = _mm_blend_epi16(temp, state1, 0xF0);
+   state1 = _mm_alignr_epi8(state1, temp, 8);
+
+   //Save the hash value
+   _mm_storeu_si128((__m128i *) h, state0);
+   _mm_storeu_si128((__m128i *) (h + 4), state1);
+}
+
+#endif
+
+
+//SHA instruction set extensions on ARM targets?
+#if (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_ARM_SHA))
+
+/**
+ * @brief Process a 64-byte block using ARMv8 SHA-256 instructions
+ * @param[in,out] h Intermediate hash value
+ * @param[in] data Pointer to the 64-byte block
+ **/
+
+static void sha256ArmProcessBlock(uint32_t *h, const uint8_t *data)
+{
+   uint_t i;
+   uint32x4_t state0;
+   uint32x4_t state1;
+   uint32x4_t save0;
+   uint32x4_t temp;
+   uint32x4_t m[4];
+
+   //Load the current state
+   state0 = vld1q_u32(h);
+   state1 = vld1q_u32(h + 4);
+
+   //Each iteration performs 4 rounds
+   for(i = 0; i < 16; i++)
+   {
+      //Prepare the message schedule
+      if(i < 4)
+      {
+         //Convert from big-endian byte order
+         m[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+      }
+      else
+      {
+         //W(t) = SIGMA4(W(t - 2)) + W(t - 7) + SIGMA3(W(t - 15)) + W(t - 16)
+         temp = vsha256su0q_u32(m[i % 4], m[(i + 1) % 4]);
+         m[i % 4] = vsha256su1q_u32(temp, m[(i + 2) % 4], m[(i + 3) % 4]);
+      }
+
+      //Add the round constants
+      temp = vaddq_u32(m[i % 4], vld1q_u32(k + 4 * i));
+
+      //Perform 4 rounds
+      save0 = state0;
+      state0 = vsha256hq_u32(state0, state1, temp);
+      state1 = vsha256h2q_u32(state1, save0, temp);
+   }
+
+   //Update the hash value
+   vst1q_u32(h, vaddq_u32(state0, vld1q_u32(h)));
+   vst1q_u32(h + 4, vaddq_u32(state1, vld1q_u32(h + 4)));
+}
+
+#endif
+
+
 /**
  * @brief Process message in 16-word blocks
  * @param[in] context Pointer to the SHA-256 context
@@ -239,19 +487,41 @@ void sha256ProcessBlock(Sha256Context *context)
    uint_t t;
    uint32_t temp1;
    uint32_t temp2;
+   uint32_t a;
+   uint32_t b;
+   uint32_t c;
+   uint32_t d;
+   uint32_t e;
+   uint32_t f;
+   uint32_t g;
+   uint32_t h;
+   uint32_t *w;
+
+#if (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //Use Intel SHA extensions when available
+   if((cpuGetFeatures() & SHA256_SHANI_FEATURES) == SHA256_SHANI_FEATURES)
+   {
+      sha256ShaniProcessBlock(context->h, context->buffer);
+      return;
+   }
+#elif (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_ARM_SHA))
+   //Use ARMv8 SHA-256 instructions
+   sha256ArmProcessBlock(context->h, context->buffer);
+   return;
+#endif
 
    //Initialize the 8 working registers
-   uint32_t a = context->h[0];
-   uint32_t b = context->h[1];
-   uint32_t c = context->h[2];
-   uint32_t d = context->h[3];
-   uint32_t e = context->h[4];
-   uint32_t f = context->h[5];
-   uint32_t g = context->h[6];
-   uint32_t h = context->h[7];
+   a = context->h[0];
+   b = context->h[1];
+   c = context->h[2];
+   d = context->h[3];
+   e = context->h[4];
+   f = context->h[5];
+   g = context->h[6];
+   h = context->h[7];
 
    //Process message in 16-word blocks
-   uint32_t *w = context->w;
+   w = context->w;
 
    //Convert from big-endian byte order to host byte order
    for(t = 0; t < 16; t++)
@@ -290,4 +560,879 @@ void sha256ProcessBlock(Sha256Context *context)
    context->h[7] += h;
 }
 
+
+//SIMD support?
+#if (SIMD_SUPPORT == ENABLED)
+
+//Maximum number of lanes of the multi-buffer implementation
+#define SHA256_MAX_LANES 16
+
+//Workspace of the multi-buffer implementation
+#define WV(t) w[(t) & 0x0F]
+
+/**
+ * @brief Lane of the multi-buffer implementation
+ **/
+
+typedef struct
+{
+   Sha256Message *message; ///<Message being hashed (NULL if the lane is idle)
+   const uint8_t *data;    ///<Next block to be processed
+   size_t n;               ///<Number of contiguous blocks left in the current segment
+   bool_t last;            ///<The current segment holds the padded final blocks
+   uint8_t buffer[128];    ///<Padded final blocks
+} Sha256Lane;
+
+
+/**
+ * @brief Load one block of each lane, in structure-of-arrays layout
+ * @param[out] m Message words (word t of lane j is stored at m[t * lanes + j])
+ * @param[in] data Pointers to the blocks
+ * @param[in] lanes Number of lanes
+ **/
+
+static void sha256LoadBlocks(uint32_t *m, const uint8_t **data, uint_t lanes)
+{
+   uint_t j;
+   uint_t t;
+
+   //Convert from big-endian byte order to host byte order
+   for(t = 0; t < 16; t++)
+   {
+      for(j = 0; j < lanes; j++)
+         m[t * lanes + j] = LOAD32BE(data[j] + 4 * t);
+   }
+}
+
+
+//x86 or x86-64 target?
+#if defined(CPU_FEATURES_X86)
+
+//SHA-256 round function (SSE2)
+#define SHA256_SSE2_ROR(x, n) _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - (n)))
+#define SHA256_SSE2_XOR3(x, y, z) _mm_xor_si128(_mm_xor_si128(x, y), z)
+#define SHA256_SSE2_CH(x, y, z) _mm_xor_si128(_mm_and_si128(x, y), _mm_andnot_si128(x, z))
+#define SHA256_SSE2_MAJ(x, y, z) _mm_or_si128(_mm_and_si128(x, y), _mm_and_si128(z, _mm_or_si128(x, y)))
+#define SHA256_SSE2_SIGMA1(x) SHA256_SSE2_XOR3(SHA256_SSE2_ROR(x, 2), SHA256_SSE2_ROR(x, 13), SHA256_SSE2_ROR(x, 22))
+#define SHA256_SSE2_SIGMA2(x) SHA256_SSE2_XOR3(SHA256_SSE2_ROR(x, 6), SHA256_SSE2_ROR(x, 11), SHA256_SSE2_ROR(x, 25))
+#define SHA256_SSE2_SIGMA3(x) SHA256_SSE2_XOR3(SHA256_SSE2_ROR(x, 7), SHA256_SSE2_ROR(x, 18), _mm_srli_epi32(x, 3))
+#define SHA256_SSE2_SIGMA4(x) SHA256_SSE2_XOR3(SHA256_SSE2_ROR(x, 17), SHA256_SSE2_ROR(x, 19), _mm_srli_epi32(x, 10))
+
+#define SHA256_SSE2_ROUND(a, b, c, d, e, f, g, h, t) \
+{ \
+   if((t) >= 16) \
+      WV(t) = _mm_add_epi32(_mm_add_epi32(SHA256_SSE2_SIGMA4(WV((t) + 14)), WV((t) + 9)), \
+         _mm_add_epi32(SHA256_SSE2_SIGMA3(WV((t) + 1)), WV(t))); \
+   temp1 = _mm_add_epi32(_mm_add_epi32(h, SHA256_SSE2_SIGMA2(e)), _mm_add_epi32(SHA256_SSE2_CH(e, f, g), \
+      _mm_add_epi32(_mm_set1_epi32(k[t]), WV(t)))); \
+   temp2 = _mm_add_epi32(SHA256_SSE2_SIGMA1(a), SHA256_SSE2_MAJ(a, b, c)); \
+   d = _mm_add_epi32(d, temp1); \
+   h = _mm_add_epi32(temp1, temp2); \
+}
+
+//SHA-256 round function (AVX2)
+#define SHA256_AVX2_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define SHA256_AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define SHA256_AVX2_CH(x, y, z) _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define SHA256_AVX2_MAJ(x, y, z) _mm256_or_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_or_si256(x, y)))
+#define SHA256_AVX2_SIGMA1(x) SHA256_AVX2_XOR3(SHA256_AVX2_ROR(x, 2), SHA256_AVX2_ROR(x, 13), SHA256_AVX2_ROR(x, 22))
+#define SHA256_AVX2_SIGMA2(x) SHA256_AVX2_XOR3(SHA256_AVX2_ROR(x, 6), SHA256_AVX2_ROR(x, 11), SHA256_AVX2_ROR(x, 25))
+#define SHA256_AVX2_SIGMA3(x) SHA256_AVX2_XOR3(SHA256_AVX2_ROR(x, 7), SHA256_AVX2_ROR(x, 18), _mm256_srli_epi32(x, 3))
+#define SHA256_AVX2_SIGMA4(x) SHA256_AVX2_XOR3(SHA256_AVX2_ROR(x, 17), SHA256_AVX2_ROR(x, 19), _mm256_srli_epi32(x, 10))
+
+#define SHA256_AVX2_ROUND(a, b, c, d, e, f, g, h, t) \
+{ \
+   if((t) >= 16) \
+      WV(t) = _mm256_add_epi32(_mm256_add_epi32(SHA256_AVX2_SIGMA4(WV((t) + 14)), WV((t) + 9)), \
+         _mm256_add_epi32(SHA256_AVX2_SIGMA3(WV((t) + 1)), WV(t))); \
+   temp1 = _mm256_add_epi32(_mm256_add_epi32(h, SHA256_AVX2_SIGMA2(e)), _mm256_add_epi32(SHA256_AVX2_CH(e, f, g), \
+      _mm256_add_epi32(_mm256_set1_epi32(k[t]), WV(t)))); \
+   temp2 = _mm256_add_epi32(SHA256_AVX2_SIGMA1(a), SHA256_AVX2_MAJ(a, b, c)); \
+   d = _mm256_add_epi32(d, temp1); \
+   h = _mm256_add_epi32(temp1, temp2); \
+}
+
+//SHA-256 round function (AVX-512)
+#define SHA256_AVX512_XOR3(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+#define SHA256_AVX512_CH(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xCA)
+#define SHA256_AVX512_MAJ(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xE8)
+#define SHA256_AVX512_SIGMA1(x) SHA256_AVX512_XOR3(_mm512_ror_epi32(x, 2), _mm512_ror_epi32(x, 13), _mm512_ror_epi32(x, 22))
+#define SHA256_AVX512_SIGMA2(x) SHA256_AVX512_XOR3(_mm512_ror_epi32(x, 6), _mm512_ror_epi32(x, 11), _mm512_ror_epi32(x, 25))
+#define SHA256_AVX512_SIGMA3(x) SHA256_AVX512_XOR3(_mm512_ror_epi32(x, 7), _mm512_ror_epi32(x, 18), _mm512_srli_epi32(x, 3))
+#define SHA256_AVX512_SIGMA4(x) SHA256_AVX512_XOR3(_mm512_ror_epi32(x, 17), _mm512_ror_epi32(x, 19), _mm512_srli_epi32(x, 10))
+
+#define SHA256_AVX512_ROUND(a, b, c, d, e, f, g, h, t) \
+{ \
+   if((t) >= 16) \
+      WV(t) = _mm512_add_epi32(_mm512_add_epi32(SHA256_AVX512_SIGMA4(WV((t) + 14)), WV((t) + 9)), \
+         _mm512_add_epi32(SHA256_AVX512_SIGMA3(WV((t) + 1)), WV(t))); \
+   temp1 = _mm512_add_epi32(_mm512_add_epi32(h, SHA256_AVX512_SIGMA2(e)), _mm512_add_epi32(SHA256_AVX512_CH(e, f, g), \
+      _mm512_add_epi32(_mm512_set1_epi32(k[t]), WV(t)))); \
+   temp2 = _mm512_add_epi32(SHA256_AVX512_SIGMA1(a), SHA256_AVX512_MAJ(a, b, c)); \
+   d = _mm512_add_epi32(d, temp1); \
+   h = _mm512_add_epi32(temp1, temp2); \
+}
+
+
+/**
+ * @brief Process blocks of 4 independent messages using SSE2 instructions
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of each lane
+ * @param[in] n Number of consecutive blocks to process in each lane
+ **/
+
+CPU_TARGET("sse2") static void sha256Sse2ProcessBlocks(uint32_t *h,
+   const uint8_t **data, size_t n)
+{
+   uint_t i;
+   uint_t t;
+   size_t j;
+   __m128i a, b, c, d, e, f, g, hh;
+   __m128i temp1;
+   __m128i temp2;
+   __m128i s[8];
+   __m128i w[16];
+   uint32_t m[16 * 4];
+   const uint8_t *p[4];
+
+   //Load the intermediate hash values
+   for(i = 0; i < 8; i++)
+      s[i] = _mm_loadu_si128((__m128i *) (h + 4 * i));
+
+   //Point to the first block of each lane
+   for(i = 0; i < 4; i++)
+      p[i] = data[i];
+
+   //Process the blocks
+   for(j = 0; j < n; j++)
+   {
+      //Transpose the message words
+      sha256LoadBlocks(m, p, 4);
+
+      for(t = 0; t < 16; t++)
+         w[t] = _mm_loadu_si128((__m128i *) (m + 4 * t));
+
+      //Initialize the 8 working registers
+      a = s[0];
+      b = s[1];
+      c = s[2];
+      d = s[3];
+      e = s[4];
+      f = s[5];
+      g = s[6];
+      hh = s[7];
+
+      //SHA-256 hash computation
+      for(t = 0; t < 64; t += 8)
+      {
+         SHA256_SSE2_ROUND(a, b, c, d, e, f, g, hh, t);
+         SHA256_SSE2_ROUND(hh, a, b, c, d, e, f, g, t + 1);
+         SHA256_SSE2_ROUND(g, hh, a, b, c, d, e, f, t + 2);
+         SHA256_SSE2_ROUND(f, g, hh, a, b, c, d, e, t + 3);
+         SHA256_SSE2_ROUND(e, f, g, hh, a, b, c, d, t + 4);
+         SHA256_SSE2_ROUND(d, e, f, g, hh, a, b, c, t + 5);
+         SHA256_SSE2_ROUND(c, d, e, f, g, hh, a, b, t + 6);
+         SHA256_SSE2_ROUND(b, c, d, e, f, g, hh, a, t + 7);
+      }
+
+      //Update the hash values
+      s[0] = _mm_add_epi32(s[0], a);
+      s[1] = _mm_add_epi32(s[1], b);
+      s[2] = _mm_add_epi32(s[2], c);
+      s[3] = _mm_add_epi32(s[3], d);
+      s[4] = _mm_add_epi32(s[4], e);
+      s[5] = _mm_add_epi32(s[5], f);
+      s[6] = _mm_add_epi32(s[6], g);
+      s[7] = _mm_add_epi32(s[7], hh);
+
+      //Next blocks
+      for(i = 0; i < 4; i++)
+         p[i] += 64;
+   }
+
+   //Save the intermediate hash values
+   for(i = 0; i < 8; i++)
+      _mm_storeu_si128((__m128i *) (h + 4 * i), s[i]);
+}
+
+
+/**
+ * @brief Process blocks of 8 independent messages using AVX2 instructions
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of each lane
+ * @param[in] n Number of consecutive blocks to process in each lane
+ **/
+
+CPU_TARGET("avx2") static void sha256Avx2ProcessBlocks(uint32_t *h,
+   const uint8_t **data, size_t n)
+{
+   uint_t i;
+   uint_t t;
+   size_t j;
+   __m256i a, b, c, d, e, f, g, hh;
+   __m256i temp1;
+   __m256i temp2;
+   __m256i s[8];
+   __m256i w[16];
+   uint32_t m[16 * 8];
+   const uint8_t *p[8];
+
+   //Load the intermediate hash values
+   for(i = 0; i < 8; i++)
+      s[i] = _mm256_loadu_si256((__m256i *) (h + 8 * i));
+
+   //Point to the first block of each lane
+   for(i = 0; i < 8; i++)
+      p[i] = data[i];
+
+   //Process the blocks
+   for(j = 0; j < n; j++)
+   {
+      //Transpose the message words
+      sha256LoadBlocks(m, p, 8);
+
+      for(t = 0; t < 16; t++)
+         w[t] = _mm256_loadu_si256((__m256i *) (m + 8 * t));
+
+      //Initialize the 8 working registers
+      a = s[0];
+      b = s[1];
+      c = s[2];
+      d = s[3];
+      e = s[4];
+      f = s[5];
+      g = s[6];
+      hh = s[7];
+
+      //SHA-256 hash computation
+      for(t = 0; t < 64; t += 8)
+      {
+         SHA256_AVX2_ROUND(a, b, c, d, e, f, g, hh, t);
+         SHA256_AVX2_ROUND(hh, a, b, c, d, e, f, g, t + 1);
+         SHA256_AVX2_ROUND(g, hh, a, b, c, d, e, f, t + 2);
+         SHA256_AVX2_ROUND(f, g, hh, a, b, c, d, e, t + 3);
+         SHA256_AVX2_ROUND(e, f, g, hh, a, b, c, d, t + 4);
+         SHA256_AVX2_ROUND(d, e, f, g, hh, a, b, c, t + 5);
+         SHA256_AVX2_ROUND(c, d, e, f, g, hh, a, b, t + 6);
+         SHA256_AVX2_ROUND(b, c, d, e, f, g, hh, a, t + 7);
+      }
+
+      //Update the hash values
+      s[0] = _mm256_add_epi32(s[0], a);
+      s[1] = _mm256_add_epi32(s[1], b);
+      s[2] = _mm256_add_epi32(s[2], c);
+      s[3] = _mm256_add_epi32(s[3], d);
+      s[4] = _mm256_add_epi32(s[4], e);
+      s[5] = _mm256_add_epi32(s[5], f);
+      s[6] = _mm256_add_epi32(s[6], g);
+      s[7] = _mm256_add_epi32(s[7], hh);
+
+      //Next blocks
+      for(i = 0; i < 8; i++)
+         p[i] += 64;
+   }
+
+   //Save the intermediate hash values
+   for(i = 0; i < 8; i++)
+      _mm256_storeu_si256((__m256i *) (h + 8 * i), s[i]);
+}
+
+
+/**
+ * @brief Process blocks of 16 independent messages using AVX-512 instructions
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of each lane
+ * @param[in] n Number of consecutive blocks to process in each lane
+ **/
+
+CPU_TARGET("avx512f") static void sha256Avx512ProcessBlocks(uint32_t *h,
+   const uint8_t **data, size_t n)
+{
+   uint_t i;
+   uint_t t;
+   size_t j;
+   __m512i a, b, c, d, e, f, g, hh;
+   __m512i temp1;
+   __m512i temp2;
+   __m512i s[8];
+   __m512i w[16];
+   uint32_t m[16 * 16];
+   const uint8_t *p[16];
+
+   //Load the intermediate hash values
+   for(i = 0; i < 8; i++)
+      s[i] = _mm512_loadu_si512((__m512i *) (h + 16 * i));
+
+   //Point to the first block of each lane
+   for(i = 0; i < 16; i++)
+      p[i] = data[i];
+
+   //Process the blocks
+   for(j = 0; j < n; j++)
+   {
+      //Transpose the message words
+      sha256LoadBlocks(m, p, 16);
+
+      for(t = 0; t < 16; t++)
+         w[t] = _mm512_loadu_si512((__m512i *) (m + 16 * t));
+
+      //Initialize the 8 working registers
+      a = s[0];
+      b = s[1];
+      c = s[2];
+      d = s[3];
+      e = s[4];
+      f = s[5];
+      g = s[6];
+      hh = s[7];
+
+      //SHA-256 hash computation
+      for(t = 0; t < 64; t += 8)
+      {
+         SHA256_AVX512_ROUND(a, b, c, d, e, f, g, hh, t);
+         SHA256_AVX512_ROUND(hh, a, b, c, d, e, f, g, t + 1);
+         SHA256_AVX512_ROUND(g, hh, a, b, c, d, e, f, t + 2);
+         SHA256_AVX512_ROUND(f, g, hh, a, b, c, d, e, t + 3);
+         SHA256_AVX512_ROUND(e, f, g, hh, a, b, c, d, t + 4);
+         SHA256_AVX512_ROUND(d, e, f, g, hh, a, b, c, t + 5);
+         SHA256_AVX512_ROUND(c, d, e, f, g, hh, a, b, t + 6);
+         SHA256_AVX512_ROUND(b, c, d, e, f, g, hh, a, t + 7);
+      }
+
+      //Update the hash values
+      s[0] = _mm512_add_epi32(s[0], a);
+      s[1] = _mm512_add_epi32(s[1], b);
+      s[2] = _mm512_add_epi32(s[2], c);
+      s[3] = _mm512_add_epi32(s[3], d);
+      s[4] = _mm512_add_epi32(s[4], e);
+      s[5] = _mm512_add_epi32(s[5], f);
+      s[6] = _mm512_add_epi32(s[6], g);
+      s[7] = _mm512_add_epi32(s[7], hh);
+
+      //Next blocks
+      for(i = 0; i < 16; i++)
+         p[i] += 64;
+   }
+
+   //Save the intermediate hash values
+   for(i = 0; i < 8; i++)
+      _mm512_storeu_si512((__m512i *) (h + 16 * i), s[i]);
+}
+
+//ARM target with NEON instructions?
+#else
+
+//SHA-256 round function (NEON)
+#define SHA256_NEON_ROR(x, n) vsriq_n_u32(vshlq_n_u32(x, 32 - (n)), x, n)
+#define SHA256_NEON_XOR3(x, y, z) veorq_u32(veorq_u32(x, y), z)
+#define SHA256_NEON_CH(x, y, z) vbslq_u32(x, y, z)
+#define SHA256_NEON_MAJ(x, y, z) vbslq_u32(veorq_u32(x, y), z, y)
+#define SHA256_NEON_SIGMA1(x) SHA256_NEON_XOR3(SHA256_NEON_ROR(x, 2), SHA256_NEON_ROR(x, 13), SHA256_NEON_ROR(x, 22))
+#define SHA256_NEON_SIGMA2(x) SHA256_NEON_XOR3(SHA256_NEON_ROR(x, 6), SHA256_NEON_ROR(x, 11), SHA256_NEON_ROR(x, 25))
+#define SHA256_NEON_SIGMA3(x) SHA256_NEON_XOR3(SHA256_NEON_ROR(x, 7), SHA256_NEON_ROR(x, 18), vshrq_n_u32(x, 3))
+#define SHA256_NEON_SIGMA4(x) SHA256_NEON_XOR3(SHA256_NEON_ROR(x, 17), SHA256_NEON_ROR(x, 19), vshrq_n_u32(x, 10))
+
+#define SHA256_NEON_ROUND(a, b, c, d, e, f, g, h, t) \
+{ \
+   if((t) >= 16) \
+      WV(t) = vaddq_u32(vaddq_u32(SHA256_NEON_SIGMA4(WV((t) + 14)), WV((t) + 9)), \
+         vaddq_u32(SHA256_NEON_SIGMA3(WV((t) + 1)), WV(t))); \
+   temp1 = vaddq_u32(vaddq_u32(h, SHA256_NEON_SIGMA2(e)), vaddq_u32(SHA256_NEON_CH(e, f, g), \
+      vaddq_u32(vdupq_n_u32(k[t]), WV(t)))); \
+   temp2 = vaddq_u32(SHA256_NEON_SIGMA1(a), SHA256_NEON_MAJ(a, b, c)); \
+   d = vaddq_u32(d, temp1); \
+   h = vaddq_u32(temp1, temp2); \
+}
+
+
+/**
+ * @brief Process blocks of 4 independent messages using NEON instructions
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of each lane
+ * @param[in] n Number of consecutive blocks to process in each lane
+ **/
+
+static void sha256NeonProcessBlocks(uint32_t *h, const uint8_t **data, size_t n)
+{
+   uint_t i;
+   uint_t t;
+   size_t j;
+   uint32x4_t a, b, c, d, e, f, g, hh;
+   uint32x4_t temp1;
+   uint32x4_t temp2;
+   uint32x4_t s[8];
+   uint32x4_t w[16];
+   uint32_t m[16 * 4];
+   const uint8_t *p[4];
+
+   //Load the intermediate hash values
+   for(i = 0; i < 8; i++)
+      s[i] = vld1q_u32(h + 4 * i);
+
+   //Point to the first block of each lane
+   for(i = 0; i < 4; i++)
+      p[i] = data[i];
+
+   //Process the blocks
+   for(j = 0; j < n; j++)
+   {
+      //Transpose the message words
+      sha256LoadBlocks(m, p, 4);
+
+      for(t = 0; t < 16; t++)
+         w[t] = vld1q_u32(m + 4 * t);
+
+      //Initialize the 8 working registers
+      a = s[0];
+      b = s[1];
+      c = s[2];
+      d = s[3];
+      e = s[4];
+      f = s[5];
+      g = s[6];
+      hh = s[7];
+
+      //SHA-256 hash computation
+      for(t = 0; t < 64; t += 8)
+      {
+         SHA256_NEON_ROUND(a, b, c, d, e, f, g, hh, t);
+         SHA256_NEON_ROUND(hh, a, b, c, d, e, f, g, t + 1);
+         SHA256_NEON_ROUND(g, hh, a, b, c, d, e, f, t + 2);
+         SHA256_NEON_ROUND(f, g, hh, a, b, c, d, e, t + 3);
+         SHA256_NEON_ROUND(e, f, g, hh, a, b, c, d, t + 4);
+         SHA256_NEON_ROUND(d, e, f, g, hh, a, b, c, t + 5);
+         SHA256_NEON_ROUND(c, d, e, f, g, hh, a, b, t + 6);
+         SHA256_NEON_ROUND(b, c, d, e, f, g, hh, a, t + 7);
+      }
+
+      //Update the hash values
+      s[0] = vaddq_u32(s[0], a);
+      s[1] = vaddq_u32(s[1], b);
+      s[2] = vaddq_u32(s[2], c);
+      s[3] = vaddq_u32(s[3], d);
+      s[4] = vaddq_u32(s[4], e);
+      s[5] = vaddq_u32(s[5], f);
+      s[6] = vaddq_u32(s[6], g);
+      s[7] = vaddq_u32(s[7], hh);
+
+      //Next blocks
+      for(i = 0; i < 4; i++)
+         p[i] += 64;
+   }
+
+   //Save the intermediate hash values
+   for(i = 0; i < 8; i++)
+      vst1q_u32(h + 4 * i, s[i]);
+}
+
+#endif
+
+
+/**
+ * @brief Assign a message to a lane
+ * @param[out] lane Lane of the multi-buffer implementation
+ * @param[out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] j Index of the lane
+ * @param[in] lanes Number of lanes
+ * @param[in] message Message to be hashed
+ **/
+
+static void sha256StartLane(Sha256Lane *lane, uint32_t *h, uint_t j,
+   uint_t lanes, Sha256Message *message)
+{
+   uint_t i;
+   Sha256Context context;
+
+   //Set initial hash value
+   sha256Init(&context);
+
+   for(i = 0; i < 8; i++)
+      h[i * lanes + j] = context.h[i];
+
+   //The complete blocks are processed directly from the message
+   lane->message = message;
+   lane->data = message->data;
+   lane->n = message->length / 64;
+   lane->last = FALSE;
+}
+
+
+/**
+ * @brief Prepare the padded final blocks of a lane
+ * @param[in,out] lane Lane of the multi-buffer implementation
+ **/
+
+static void sha256PadLane(Sha256Lane *lane)
+{
+   size_t r;
+   size_t n;
+   uint64_t totalSize;
+
+   //Number of bytes of the message that do not fill a complete block
+   r = lane->message->length % 64;
+   //The padding brings the length to a multiple of 64 bytes
+   n = (r < 56) ? 64 : 128;
+
+   //Copy the remaining bytes of the message
+   if(r > 0)
+      memcpy(lane->buffer, lane->data, r);
+
+   //Append the padding
+   lane->buffer[r] = 0x80;
+   memset(lane->buffer + r + 1, 0, n - r - 9);
+
+   //Append the length of the original message
+   totalSize = (uint64_t) lane->message->length * 8;
+   STORE64BE(totalSize, lane->buffer + n - 8);
+
+   //Process the final blocks
+   lane->data = lane->buffer;
+   lane->n = n / 64;
+   lane->last = TRUE;
+}
+
+
+/**
+ * @brief Finish hashing the message of a lane with the single-buffer code
+ * @param[in,out] lane Lane of the multi-buffer implementation
+ * @param[in] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] j Index of the lane
+ * @param[in] lanes Number of lanes
+ **/
+
+static void sha256FinishLane(Sha256Lane *lane, const uint32_t *h, uint_t j,
+   uint_t lanes)
+{
+   uint_t i;
+   size_t n;
+   Sha256Context context;
+
+   //Retrieve the intermediate hash value
+   for(i = 0; i < 8; i++)
+      context.h[i] = h[i * lanes + j];
+
+   //Final blocks?
+   if(lane->last)
+   {
+      //Process the remaining padded blocks
+      for(i = 0; i < lane->n; i++)
+      {
+         memcpy(context.buffer, lane->data + i * 64, 64);
+         sha256ProcessBlock(&context);
+      }
+
+      //Copy the resulting digest
+      for(i = 0; i < 8; i++)
+         STORE32BE(context.h[i], lane->message->digest + i * 4);
+   }
+   else
+   {
+      //Number of bytes already processed
+      n = lane->data - (const uint8_t *) lane->message->data;
+
+      //Resume the computation
+      context.size = 0;
+      context.totalSize = n;
+
+      //Digest the rest of the message
+      sha256Update(&context, lane->data, lane->message->length - n);
+      sha256Final(&context, lane->message->digest);
+   }
+
+   //The lane is now idle
+   lane->message = NULL;
+}
+
+
+/**
+ * @brief Select the multi-buffer implementation
+ * @return Number of lanes (0 if the single-buffer code is faster)
+ **/
+
+static uint_t sha256GetLanes(void)
+{
+#if defined(CPU_FEATURES_X86)
+   uint32_t features;
+
+   //Retrieve the instruction set extensions supported by the CPU
+   features = cpuGetFeatures();
+
+   //SHA extensions outperform the 4-way and 8-way implementations
+   if((features & CPU_FEATURE_AVX512F) != 0)
+      return 16;
+#if (SHA_EXT_SUPPORT == ENABLED)
+   else if((features & SHA256_SHANI_FEATURES) == SHA256_SHANI_FEATURES)
+      return 0;
+#endif
+   else if((features & CPU_FEATURE_AVX2) != 0)
+      return 8;
+   else if((features & CPU_FEATURE_SSE2) != 0)
+      return 4;
+   else
+      return 0;
+#elif (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_ARM_SHA))
+   //SHA-256 instructions are faster than the 4-way implementation
+   return 0;
+#else
+   //4-way implementation
+   return 4;
+#endif
+}
+
+
+/**
+ * @brief Process n blocks of each lane
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of the lanes
+ * @param[in] n Number of blocks to be processed in every lane
+ * @param[in] lanes Number of lanes
+ **/
+
+static void sha256ProcessLanes(uint32_t *h, const uint8_t **data, size_t n,
+   uint_t lanes)
+{
+#if defined(CPU_FEATURES_X86)
+   if(lanes == 16)
+      sha256Avx512ProcessBlocks(h, data, n);
+   else if(lanes == 8)
+      sha256Avx2ProcessBlocks(h, data, n);
+   else
+      sha256Sse2ProcessBlocks(h, data, n);
+#else
+   sha256NeonProcessBlocks(h, data, n);
+#endif
+}
+
+#endif
+
+
+/**
+ * @brief Digest several independent messages using SHA-256
+ *
+ * When SIMD instructions are available, the messages are hashed in
+ * parallel, one message per lane. A lane is refilled with the next pending
+ * message as soon as its current message is complete. The digests are
+ * identical to those produced by sha256Compute
+ *
+ * @param[in,out] messages Array of messages
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
+
+error_t sha256ComputeMulti(Sha256Message *messages, uint_t count)
+{
+   error_t error;
+   uint_t i;
+#if (SIMD_SUPPORT == ENABLED)
+   uint_t j;
+   uint_t next;
+   uint_t lanes;
+   uint_t active;
+   size_t n;
+   const uint8_t *busy;
+   const uint8_t *data[SHA256_MAX_LANES];
+   uint32_t h[8 * SHA256_MAX_LANES];
+   Sha256Lane lane[SHA256_MAX_LANES];
+#endif
+
+   //Check parameters
+   if(messages == NULL && count != 0)
+      return ERROR_INVALID_PARAMETER;
+
+#if (SIMD_SUPPORT == ENABLED)
+   //Select the multi-buffer implementation
+   lanes = sha256GetLanes();
+
+   //Multi-buffer implementation available?
+   if(lanes > 0)
+   {
+      //All the lanes are idle
+      for(j = 0; j < lanes; j++)
+         lane[j].message = NULL;
+
+      //Process the messages
+      for(next = 0, active = 0; next < count || active > 0; )
+      {
+         //Assign pending messages to the idle lanes
+         for(j = 0; j < lanes && next < count; j++)
+         {
+            if(lane[j].message == NULL)
+            {
+               sha256StartLane(&lane[j], h, j, lanes, &messages[next++]);
+               active++;
+
+               //Short messages consist of the padded final blocks only
+               if(lane[j].n == 0)
+                  sha256PadLane(&lane[j]);
+            }
+         }
+
+         //When too few lanes remain busy, the single-buffer code is faster
+         if(next >= count && active * 4 <= lanes)
+         {
+            for(j = 0; j < lanes; j++)
+            {
+               if(lane[j].message != NULL)
+                  sha256FinishLane(&lane[j], h, j, lanes);
+            }
+
+            //All the messages have been processed
+            break;
+         }
+
+         //Number of blocks that can be processed in every busy lane
+         for(n = 0, j = 0; j < lanes; j++)
+         {
+            if(lane[j].message != NULL && (n == 0 || lane[j].n < n))
+               n = lane[j].n;
+         }
+
+         //Point to the next blocks of the busy lanes
+         for(j = 0, busy = NULL; j < lanes; j++)
+         {
+            if(lane[j].message != NULL)
+               busy = lane[j].data;
+         }
+
+         //Idle lanes process the blocks of a busy lane, and their results
+         //are discarded
+         for(j = 0; j < lanes; j++)
+            data[j] = (lane[j].message != NULL) ? lane[j].data : busy;
+
+         //Process n blocks of each lane
+         sha256ProcessLanes(h, data, n, lanes);
+
+         //Update the state of the busy lanes
+         for(j = 0; j < lanes; j++)
+         {
+            if(lane[j].message != NULL)
+            {
+               lane[j].data += n * 64;
+               lane[j].n -= n;
+
+               //End of the current segment?
+               if(lane[j].n == 0)
+               {
+                  //Complete blocks processed?
+                  if(!lane[j].last)
+                  {
+                     //Process the padded final blocks
+                     sha256PadLane(&lane[j]);
+                  }
+                  else
+                  {
+                     //Copy the resulting digest
+                     for(i = 0; i < 8; i++)
+                        STORE32BE(h[i * lanes + j], lane[j].message->digest + i * 4);
+
+                     //The lane is now idle
+                     lane[j].message = NULL;
+                     active--;
+                  }
+               }
+            }
+         }
+      }
+
+      //Successful processing
+      return NO_ERROR;
+   }
+#endif
+
+   //Process the messages one after the other
+   for(error = NO_ERROR, i = 0; i < count && !error; i++)
+   {
+      error = sha256Compute(messages[i].data, messages[i].length,
+         messages[i].digest);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Process one block for each of several SHA-256 contexts
+ *
+ * The block held in the buffer of each context is processed and the
+ * intermediate hash value of the context is updated accordingly, as
+ * sha256ProcessBlock would do. The other fields of the contexts are left
+ * unchanged. When SIMD instructions are available, the blocks are processed
+ * in parallel, one context per lane
+ *
+ * @param[in,out] context Array of pointers to the SHA-256 contexts
+ * @param[in] count Number of contexts
+ **/
+
+void sha256ProcessBlockMulti(Sha256Context **context, uint_t count)
+{
+   uint_t i;
+#if (SIMD_SUPPORT == ENABLED)
+   uint_t j;
+   uint_t k;
+   uint_t n;
+   uint_t lanes;
+   uint_t threshold;
+   const uint8_t *data[SHA256_MAX_LANES];
+   uint32_t h[8 * SHA256_MAX_LANES];
+#endif
+
+   //Index of the first context to be processed
+   i = 0;
+
+#if (SIMD_SUPPORT == ENABLED)
+   //Select the multi-buffer implementation
+   lanes = sha256GetLanes();
+   //Minimum number of busy lanes for the multi-buffer code to be faster
+   threshold = lanes / 4 + 1;
+
+#if (SHA_EXT_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //A single block per lane does not amortize the transposition of the
+   //intermediate hash values, so the SHA extensions are faster than the
+   //16-way implementation unless all the lanes are busy
+   if((cpuGetFeatures() & SHA256_SHANI_FEATURES) == SHA256_SHANI_FEATURES)
+      threshold = lanes;
+#endif
+
+   //Multi-buffer implementation available?
+   if(lanes > 0)
+   {
+      //Process the contexts by groups of at most lanes contexts
+      for(; i < count; i += n)
+      {
+         //Number of busy lanes
+         n = MIN(count - i, lanes);
+
+         //When too few lanes would be busy, the single-buffer code is faster
+         if(n < threshold)
+            break;
+
+         //Idle lanes process the block of the first context, and their
+         //results are discarded
+         for(j = 0; j < lanes; j++)
+         {
+            data[j] = context[(j < n) ? i + j : i]->buffer;
+
+            for(k = 0; k < 8; k++)
+               h[k * lanes + j] = context[(j < n) ? i + j : i]->h[k];
+         }
+
+         //Process one block of each lane
+         sha256ProcessLanes(h, data, 1, lanes);
+
+         //Update the intermediate hash values of the contexts
+         for(j = 0; j < n; j++)
+         {
+            for(k = 0; k < 8; k++)
+               context[i + j]->h[k] = h[k * lanes + j];
+         }
+      }
+   }
+#endif
+
+   //Process the remaining contexts one after the other
+   for(; i < count; i++)
+      sha256ProcessBlock(context[i]);
+}
+
 #endif
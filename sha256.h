@@ -36,6 +36,8 @@
 #define SHA256_BLOCK_SIZE 64
 //SHA-256 digest size
 #define SHA256_DIGEST_SIZE 32
+//SHA-256 maximum size of the exported state
+#define SHA256_STATE_SIZE (SHA256_DIGEST_SIZE + 8 + SHA256_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define SHA256_HASH_ALGO (&sha256HashAlgo)
 
@@ -66,6 +68,18 @@ typedef struct
 } Sha256Context;
 
 
+/**
+ * @brief Message descriptor (multi-buffer hashing)
+ **/
+
+typedef struct
+{
+   const void *data; ///<Message to be hashed
+   size_t length;    ///<Length of the message
+   uint8_t *digest;  ///<Resulting digest
+} Sha256Message;
+
+
 //SHA-256 related constants
 extern const HashAlgo sha256HashAlgo;
 
@@ -74,7 +88,12 @@ error_t sha256Compute(const void *data, size_t length, uint8_t *digest);
 void sha256Init(Sha256Context *context);
 void sha256Update(Sha256Context *context, const void *data, size_t length);
 void sha256Final(Sha256Context *context, uint8_t *digest);
+void sha256Clone(Sha256Context *destContext, const Sha256Context *srcContext);
+size_t sha256ExportState(const Sha256Context *context, uint8_t *output);
+error_t sha256ImportState(Sha256Context *context, const uint8_t *input, size_t length);
 void sha256ProcessBlock(Sha256Context *context);
+error_t sha256ComputeMulti(Sha256Message *messages, uint_t count);
+void sha256ProcessBlockMulti(Sha256Context **context, uint_t count);
 
 //C++ guard
 #ifdef __cplusplus
@@ -54,10 +54,14 @@ const HashAlgo sha384HashAlgo =
    sizeof(Sha384Context),
    SHA384_BLOCK_SIZE,
    SHA384_DIGEST_SIZE,
+   SHA384_STATE_SIZE,
    (HashAlgoCompute) sha384Compute,
    (HashAlgoInit) sha384Init,
    (HashAlgoUpdate) sha384Update,
-   (HashAlgoFinal) sha384Final
+   (HashAlgoFinal) sha384Final,
+   (HashAlgoClone) sha512Clone,
+   (HashAlgoExportState) sha512ExportState,
+   (HashAlgoImportState) sha512ImportState
 };
 
 
@@ -145,4 +149,18 @@ void sha384Final(Sha384Context *context, uint8_t *digest)
       memcpy(digest, context->digest, SHA384_DIGEST_SIZE);
 }
 
+
+/**
+ * @brief Digest several independent messages using SHA-384
+ * @param[in,out] messages Array of messages
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
+
+error_t sha384ComputeMulti(Sha384Message *messages, uint_t count)
+{
+   //The messages are processed by the multi-buffer SHA-512 implementation
+   return sha512ComputeMultiEx(SHA384_HASH_ALGO, messages, count);
+}
+
 #endif
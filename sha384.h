@@ -37,6 +37,8 @@
 #define SHA384_BLOCK_SIZE 128
 //SHA-384 digest size
 #define SHA384_DIGEST_SIZE 48
+//SHA-384 maximum size of the exported state
+#define SHA384_STATE_SIZE SHA512_STATE_SIZE
 //Common interface for hash algorithms
 #define SHA384_HASH_ALGO (&sha384HashAlgo)
 
@@ -52,6 +54,12 @@
 
 typedef Sha512Context Sha384Context;
 
+/**
+ * @brief Message descriptor (multi-buffer hashing)
+ **/
+
+typedef Sha512Message Sha384Message;
+
 
 //SHA-384 related constants
 extern const HashAlgo sha384HashAlgo;
@@ -61,6 +69,7 @@ error_t sha384Compute(const void *data, size_t length, uint8_t *digest);
 void sha384Init(Sha384Context *context);
 void sha384Update(Sha384Context *context, const void *data, size_t length);
 void sha384Final(Sha384Context *context, uint8_t *digest);
+error_t sha384ComputeMulti(Sha384Message *messages, uint_t count);
 
 //C++ guard
 #ifdef __cplusplus
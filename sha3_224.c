@@ -54,10 +54,14 @@ const HashAlgo sha3_224HashAlgo =
    sizeof(Sha3_224Context),
    SHA3_224_BLOCK_SIZE,
    SHA3_224_DIGEST_SIZE,
+   SHA3_224_STATE_SIZE,
    (HashAlgoCompute) sha3_224Compute,
    (HashAlgoInit) sha3_224Init,
    (HashAlgoUpdate) sha3_224Update,
-   (HashAlgoFinal) sha3_224Final
+   (HashAlgoFinal) sha3_224Final,
+   (HashAlgoClone) keccakClone,
+   (HashAlgoExportState) keccakExportState,
+   (HashAlgoImportState) sha3_224ImportState
 };
 
 
@@ -133,4 +137,20 @@ void sha3_224Final(Sha3_224Context *context, uint8_t *digest)
    keccakSqueeze(context, digest, SHA3_224_DIGEST_SIZE);
 }
 
+
+/**
+ * @brief Import the state of a SHA3-224 context
+ * @param[out] context Pointer to the SHA3-224 context to initialize
+ * @param[in] input Serialized state (see keccakExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t sha3_224ImportState(Sha3_224Context *context, const uint8_t *input,
+   size_t length)
+{
+   //Restore the state of the sponge function
+   return keccakImportState(context, 2 * 224, input, length);
+}
+
 #endif
@@ -37,6 +37,8 @@
 #define SHA3_224_BLOCK_SIZE 144
 //SHA3-224 digest size
 #define SHA3_224_DIGEST_SIZE 28
+//SHA3-224 maximum size of the exported state
+#define SHA3_224_STATE_SIZE (KECCAK_B / 8 + 8 + SHA3_224_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define SHA3_224_HASH_ALGO (&sha3_224HashAlgo)
 
@@ -61,6 +63,7 @@ error_t sha3_224Compute(const void *data, size_t length, uint8_t *digest);
 void sha3_224Init(Sha3_224Context *context);
 void sha3_224Update(Sha3_224Context *context, const void *data, size_t length);
 void sha3_224Final(Sha3_224Context *context, uint8_t *digest);
+error_t sha3_224ImportState(Sha3_224Context *context, const uint8_t *input, size_t length);
 
 //C++ guard
 #ifdef __cplusplus
@@ -54,10 +54,14 @@ const HashAlgo sha3_256HashAlgo =
    sizeof(Sha3_256Context),
    SHA3_256_BLOCK_SIZE,
    SHA3_256_DIGEST_SIZE,
+   SHA3_256_STATE_SIZE,
    (HashAlgoCompute) sha3_256Compute,
    (HashAlgoInit) sha3_256Init,
    (HashAlgoUpdate) sha3_256Update,
-   (HashAlgoFinal) sha3_256Final
+   (HashAlgoFinal) sha3_256Final,
+   (HashAlgoClone) keccakClone,
+   (HashAlgoExportState) keccakExportState,
+   (HashAlgoImportState) sha3_256ImportState
 };
 
 
@@ -133,4 +137,75 @@ void sha3_256Final(Sha3_256Context *context, uint8_t *digest)
    keccakSqueeze(context, digest, SHA3_256_DIGEST_SIZE);
 }
 
+
+/**
+ * @brief Import the state of a SHA3-256 context
+ * @param[out] context Pointer to the SHA3-256 context to initialize
+ * @param[in] input Serialized state (see keccakExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t sha3_256ImportState(Sha3_256Context *context, const uint8_t *input,
+   size_t length)
+{
+   //Restore the state of the sponge function
+   return keccakImportState(context, 2 * 256, input, length);
+}
+
+
+/**
+ * @brief Digest several independent messages using SHA3-256
+ *
+ * The messages are hashed in parallel when possible (refer to
+ * keccakComputeMulti). The digests are identical to those produced by
+ * sha3_256Compute
+ *
+ * @param[in,out] messages Array of messages
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
+
+error_t sha3_256ComputeMulti(Sha3_256Message *messages, uint_t count)
+{
+   error_t error;
+   uint_t i;
+   uint_t n;
+   KeccakMessage m[16];
+
+   //Check parameters
+   if(messages == NULL && count != 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Process the messages in groups of up to 16
+   while(count > 0 && !error)
+   {
+      //Number of messages in the current group
+      n = MIN(count, arraysize(m));
+
+      //Describe the messages in terms of the sponge function
+      for(i = 0; i < n; i++)
+      {
+         m[i].input = messages[i].data;
+         m[i].inputLen = messages[i].length;
+         m[i].output = messages[i].digest;
+         m[i].outputLen = SHA3_256_DIGEST_SIZE;
+      }
+
+      //The capacity of the sponge is twice the digest length, and the
+      //padding byte is 0x06 for SHA-3
+      error = keccakComputeMulti(2 * 256, KECCAK_SHA3_PAD, m, n);
+
+      //Next group
+      messages += n;
+      count -= n;
+   }
+
+   //Return status code
+   return error;
+}
+
 #endif
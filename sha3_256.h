@@ -37,6 +37,8 @@
 #define SHA3_256_BLOCK_SIZE 136
 //SHA3-256 digest size
 #define SHA3_256_DIGEST_SIZE 32
+//SHA3-256 maximum size of the exported state
+#define SHA3_256_STATE_SIZE (KECCAK_B / 8 + 8 + SHA3_256_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define SHA3_256_HASH_ALGO (&sha3_256HashAlgo)
 
@@ -53,6 +55,18 @@
 typedef KeccakContext Sha3_256Context;
 
 
+/**
+ * @brief Message descriptor (multi-buffer hashing)
+ **/
+
+typedef struct
+{
+   const void *data; ///<Message to be hashed
+   size_t length;    ///<Length of the message
+   uint8_t *digest;  ///<Resulting digest
+} Sha3_256Message;
+
+
 //SHA3-256 related constants
 extern const HashAlgo sha3_256HashAlgo;
 
@@ -61,6 +75,8 @@ error_t sha3_256Compute(const void *data, size_t length, uint8_t *digest);
 void sha3_256Init(Sha3_256Context *context);
 void sha3_256Update(Sha3_256Context *context, const void *data, size_t length);
 void sha3_256Final(Sha3_256Context *context, uint8_t *digest);
+error_t sha3_256ImportState(Sha3_256Context *context, const uint8_t *input, size_t length);
+error_t sha3_256ComputeMulti(Sha3_256Message *messages, uint_t count);
 
 //C++ guard
 #ifdef __cplusplus
@@ -54,10 +54,14 @@ const HashAlgo sha3_384HashAlgo =
    sizeof(Sha3_384Context),
    SHA3_384_BLOCK_SIZE,
    SHA3_384_DIGEST_SIZE,
+   SHA3_384_STATE_SIZE,
    (HashAlgoCompute) sha3_384Compute,
    (HashAlgoInit) sha3_384Init,
    (HashAlgoUpdate) sha3_384Update,
-   (HashAlgoFinal) sha3_384Final
+   (HashAlgoFinal) sha3_384Final,
+   (HashAlgoClone) keccakClone,
+   (HashAlgoExportState) keccakExportState,
+   (HashAlgoImportState) sha3_384ImportState
 };
 
 
@@ -133,4 +137,20 @@ void sha3_384Final(Sha3_384Context *context, uint8_t *digest)
    keccakSqueeze(context, digest, SHA3_384_DIGEST_SIZE);
 }
 
+
+/**
+ * @brief Import the state of a SHA3-384 context
+ * @param[out] context Pointer to the SHA3-384 context to initialize
+ * @param[in] input Serialized state (see keccakExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t sha3_384ImportState(Sha3_384Context *context, const uint8_t *input,
+   size_t length)
+{
+   //Restore the state of the sponge function
+   return keccakImportState(context, 2 * 384, input, length);
+}
+
 #endif
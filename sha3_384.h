@@ -37,6 +37,8 @@
 #define SHA3_384_BLOCK_SIZE 104
 //SHA3-384 digest size
 #define SHA3_384_DIGEST_SIZE 48
+//SHA3-384 maximum size of the exported state
+#define SHA3_384_STATE_SIZE (KECCAK_B / 8 + 8 + SHA3_384_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define SHA3_384_HASH_ALGO (&sha3_384HashAlgo)
 
@@ -61,6 +63,7 @@ error_t sha3_384Compute(const void *data, size_t length, uint8_t *digest);
 void sha3_384Init(Sha3_384Context *context);
 void sha3_384Update(Sha3_384Context *context, const void *data, size_t length);
 void sha3_384Final(Sha3_384Context *context, uint8_t *digest);
+error_t sha3_384ImportState(Sha3_384Context *context, const uint8_t *input, size_t length);
 
 //C++ guard
 #ifdef __cplusplus
@@ -54,10 +54,14 @@ const HashAlgo sha3_512HashAlgo =
    sizeof(Sha3_512Context),
    SHA3_512_BLOCK_SIZE,
    SHA3_512_DIGEST_SIZE,
+   SHA3_512_STATE_SIZE,
    (HashAlgoCompute) sha3_512Compute,
    (HashAlgoInit) sha3_512Init,
    (HashAlgoUpdate) sha3_512Update,
-   (HashAlgoFinal) sha3_512Final
+   (HashAlgoFinal) sha3_512Final,
+   (HashAlgoClone) keccakClone,
+   (HashAlgoExportState) keccakExportState,
+   (HashAlgoImportState) sha3_512ImportState
 };
 
 
@@ -133,4 +137,20 @@ void sha3_512Final(Sha3_512Context *context, uint8_t *digest)
    keccakSqueeze(context, digest, SHA3_512_DIGEST_SIZE);
 }
 
+
+/**
+ * @brief Import the state of a SHA3-512 context
+ * @param[out] context Pointer to the SHA3-512 context to initialize
+ * @param[in] input Serialized state (see keccakExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t sha3_512ImportState(Sha3_512Context *context, const uint8_t *input,
+   size_t length)
+{
+   //Restore the state of the sponge function
+   return keccakImportState(context, 2 * 512, input, length);
+}
+
 #endif
@@ -37,6 +37,8 @@
 #define SHA3_512_BLOCK_SIZE 72
 //SHA3-512 digest size
 #define SHA3_512_DIGEST_SIZE 64
+//SHA3-512 maximum size of the exported state
+#define SHA3_512_STATE_SIZE (KECCAK_B / 8 + 8 + SHA3_512_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define SHA3_512_HASH_ALGO (&sha3_512HashAlgo)
 
@@ -61,6 +63,7 @@ error_t sha3_512Compute(const void *data, size_t length, uint8_t *digest);
 void sha3_512Init(Sha3_512Context *context);
 void sha3_512Update(Sha3_512Context *context, const void *data, size_t length);
 void sha3_512Final(Sha3_512Context *context, uint8_t *digest);
+error_t sha3_512ImportState(Sha3_512Context *context, const uint8_t *input, size_t length);
 
 //C++ guard
 #ifdef __cplusplus
@@ -38,6 +38,12 @@
 #include <string.h>
 #include "crypto.h"
 #include "sha512.h"
+#include "cpu_features.h"
+
+//SIMD support?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   #include <immintrin.h>
+#endif
 
 //Check crypto library configuration
 #if (SHA384_SUPPORT == ENABLED || SHA512_SUPPORT == ENABLED || \
@@ -54,6 +60,60 @@
 #define SIGMA3(x) (ROR64(x, 1) ^ ROR64(x, 8) ^ SHR64(x, 7))
 #define SIGMA4(x) (ROR64(x, 19) ^ ROR64(x, 61) ^ SHR64(x, 6))
 
+//SIMD support on x86 targets?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+//SHA-512 round function (the round constant is already added to W(t))
+#define SHA512_ROUND(a, b, c, d, e, f, g, h, wk) \
+{ \
+   temp1 = h + SIGMA2(e) + (((f ^ g) & e) ^ g) + (wk); \
+   temp2 = SIGMA1(a) + ((a & b) | (c & (a | b))); \
+   d += temp1; \
+   h = temp1 + temp2; \
+}
+
+//SHA-512 auxiliary functions (AVX2)
+#define SHA512_AVX2_ROR(x, n) _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+#define SHA512_AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define SHA512_AVX2_CH(x, y, z) _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define SHA512_AVX2_MAJ(x, y, z) _mm256_or_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_or_si256(x, y)))
+#define SHA512_AVX2_SIGMA1(x) SHA512_AVX2_XOR3(SHA512_AVX2_ROR(x, 28), SHA512_AVX2_ROR(x, 34), SHA512_AVX2_ROR(x, 39))
+#define SHA512_AVX2_SIGMA2(x) SHA512_AVX2_XOR3(SHA512_AVX2_ROR(x, 14), SHA512_AVX2_ROR(x, 18), SHA512_AVX2_ROR(x, 41))
+#define SHA512_AVX2_SIGMA3(x) SHA512_AVX2_XOR3(SHA512_AVX2_ROR(x, 1), SHA512_AVX2_ROR(x, 8), _mm256_srli_epi64(x, 7))
+#define SHA512_AVX2_SIGMA4(x) SHA512_AVX2_XOR3(SHA512_AVX2_ROR(x, 19), SHA512_AVX2_ROR(x, 61), _mm256_srli_epi64(x, 6))
+
+//Compute 4 words of the message schedule, and add the round constants.
+//Only the first two words depend on W(t - 2) and W(t - 1), so SIGMA4 is
+//applied in two steps
+#define SHA512_AVX2_SCHEDULE(t) \
+{ \
+   v = _mm256_add_epi64(_mm256_loadu_si256((__m256i *) (w + (t) - 16)), \
+      _mm256_loadu_si256((__m256i *) (w + (t) - 7))); \
+   v = _mm256_add_epi64(v, SHA512_AVX2_SIGMA3(_mm256_loadu_si256((__m256i *) (w + (t) - 15)))); \
+   x = _mm256_inserti128_si256(_mm256_setzero_si256(), _mm_loadu_si128((__m128i *) (w + (t) - 2)), 0); \
+   v = _mm256_add_epi64(v, SHA512_AVX2_SIGMA4(x)); \
+   x = _mm256_permute2x128_si256(v, v, 0x08); \
+   v = _mm256_add_epi64(v, SHA512_AVX2_SIGMA4(x)); \
+   _mm256_storeu_si256((__m256i *) (w + (t)), v); \
+   v = _mm256_add_epi64(v, _mm256_loadu_si256((__m256i *) (k + (t)))); \
+   _mm256_storeu_si256((__m256i *) (wk + (t)), v); \
+}
+
+//SHA-512 round function (AVX2, one message per lane)
+#define SHA512_AVX2_ROUND(a, b, c, d, e, f, g, h, t) \
+{ \
+   if((t) >= 16) \
+      WV(t) = _mm256_add_epi64(_mm256_add_epi64(SHA512_AVX2_SIGMA4(WV((t) + 14)), WV((t) + 9)), \
+         _mm256_add_epi64(SHA512_AVX2_SIGMA3(WV((t) + 1)), WV(t))); \
+   temp1 = _mm256_add_epi64(_mm256_add_epi64(h, SHA512_AVX2_SIGMA2(e)), _mm256_add_epi64(SHA512_AVX2_CH(e, f, g), \
+      _mm256_add_epi64(_mm256_set1_epi64x(k[t]), WV(t)))); \
+   temp2 = _mm256_add_epi64(SHA512_AVX2_SIGMA1(a), SHA512_AVX2_MAJ(a, b, c)); \
+   d = _mm256_add_epi64(d, temp1); \
+   h = _mm256_add_epi64(temp1, temp2); \
+}
+
+#endif
+
 //SHA-512 padding
 static const uint8_t padding[128] =
 {
@@ -104,10 +164,14 @@ const HashAlgo sha512HashAlgo =
    sizeof(Sha512Context),
    SHA512_BLOCK_SIZE,
    SHA512_DIGEST_SIZE,
+   SHA512_STATE_SIZE,
    (HashAlgoCompute) sha512Compute,
    (HashAlgoInit) sha512Init,
    (HashAlgoUpdate) sha512Update,
-   (HashAlgoFinal) sha512Final
+   (HashAlgoFinal) sha512Final,
+   (HashAlgoClone) sha512Clone,
+   (HashAlgoExportState) sha512ExportState,
+   (HashAlgoImportState) sha512ImportState
 };
 
 
@@ -246,6 +310,189 @@ void sha512Final(Sha512Context *context, uint8_t *digest)
 }
 
 
+/**
+ * @brief Copy a SHA-512 context
+ *
+ * The intermediate hash value, the counters and the pending bytes are copied
+ *
+ * @param[out] destContext Pointer to the destination context
+ * @param[in] srcContext Pointer to the SHA-512 context to be copied
+ **/
+
+void sha512Clone(Sha512Context *destContext, const Sha512Context *srcContext)
+{
+   //Copy the intermediate hash value
+   memcpy(destContext->h, srcContext->h, sizeof(srcContext->h));
+   //Copy the data that have not been processed yet
+   memcpy(destContext->buffer, srcContext->buffer, srcContext->size);
+
+   //Number of bytes in the buffer
+   destContext->size = srcContext->size;
+   //Total length of the message
+   destContext->totalSize = srcContext->totalSize;
+}
+
+
+/**
+ * @brief Export the state of a SHA-512 context
+ *
+ * The serialized state is made of the intermediate hash value (eight
+ * big-endian 64-bit words), the total length of the message (big-endian
+ * 64-bit integer, in bytes) and the data that have not been processed yet
+ *
+ * @param[in] context Pointer to the SHA-512 context
+ * @param[out] output Serialized state (at most SHA512_STATE_SIZE bytes)
+ * @return Length of the serialized state
+ **/
+
+size_t sha512ExportState(const Sha512Context *context, uint8_t *output)
+{
+   uint_t i;
+
+   //Intermediate hash value
+   for(i = 0; i < 8; i++)
+      STORE64BE(context->h[i], output + i * 8);
+
+   //Total length of the message
+   STORE64BE(context->totalSize, output + SHA512_DIGEST_SIZE);
+   //Data that have not been processed yet
+   memcpy(output + SHA512_DIGEST_SIZE + 8, context->buffer, context->size);
+
+   //Return the length of the serialized state
+   return SHA512_DIGEST_SIZE + 8 + context->size;
+}
+
+
+/**
+ * @brief Import the state of a SHA-512 context
+ * @param[out] context Pointer to the SHA-512 context to initialize
+ * @param[in] input Serialized state (see sha512ExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t sha512ImportState(Sha512Context *context, const uint8_t *input,
+   size_t length)
+{
+   uint_t i;
+   size_t n;
+   uint64_t totalSize;
+
+   //Check the length of the serialized state
+   if(length < (SHA512_DIGEST_SIZE + 8))
+      return ERROR_INVALID_LENGTH;
+
+   //Total length of the message
+   totalSize = LOAD64BE(input + SHA512_DIGEST_SIZE);
+   //Number of bytes that have not been processed yet
+   n = (size_t) (totalSize % SHA512_BLOCK_SIZE);
+
+   //The pending bytes must match the length of the message
+   if(length != (SHA512_DIGEST_SIZE + 8 + n))
+      return ERROR_INVALID_LENGTH;
+
+   //Intermediate hash value
+   for(i = 0; i < 8; i++)
+      context->h[i] = LOAD64BE(input + i * 8);
+
+   //Data that have not been processed yet
+   memcpy(context->buffer, input + SHA512_DIGEST_SIZE + 8, n);
+
+   //Number of bytes in the buffer
+   context->size = n;
+   //Total length of the message
+   context->totalSize = totalSize;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+//SIMD support on x86 targets?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+/**
+ * @brief Process a 128-byte block (message schedule computed with AVX2)
+ *
+ * The 80 words of the message schedule, with the round constants already
+ * added, are computed 4 at a time before the rounds are performed
+ *
+ * @param[in] context Pointer to the SHA-512 context
+ **/
+
+CPU_TARGET("avx2") static void sha512Avx2ProcessBlock(Sha512Context *context)
+{
+   uint_t t;
+   uint64_t temp1;
+   uint64_t temp2;
+   uint64_t a, b, c, d, e, f, g, h;
+   uint64_t w[80];
+   uint64_t wk[80];
+   __m256i mask;
+   __m256i v;
+   __m256i x;
+
+   //Byte order mask
+   mask = _mm256_set_epi64x(0x08090A0B0C0D0E0FULL, 0x0001020304050607ULL,
+      0x08090A0B0C0D0E0FULL, 0x0001020304050607ULL);
+
+   //Convert from big-endian byte order to host byte order
+   for(t = 0; t < 16; t += 4)
+   {
+      v = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i *) (context->w + t)), mask);
+      _mm256_storeu_si256((__m256i *) (w + t), v);
+
+      //Add the round constants
+      v = _mm256_add_epi64(v, _mm256_loadu_si256((__m256i *) (k + t)));
+      _mm256_storeu_si256((__m256i *) (wk + t), v);
+   }
+
+   //Initialize the 8 working registers
+   a = context->h[0];
+   b = context->h[1];
+   c = context->h[2];
+   d = context->h[3];
+   e = context->h[4];
+   f = context->h[5];
+   g = context->h[6];
+   h = context->h[7];
+
+   //SHA-512 hash computation
+   for(t = 0; t < 80; t += 8)
+   {
+      //The message schedule is computed 16 rounds ahead, so that the vector
+      //instructions execute in parallel with the scalar rounds
+      if(t < 64)
+      {
+         SHA512_AVX2_SCHEDULE(t + 16);
+         SHA512_AVX2_SCHEDULE(t + 20);
+      }
+
+      //Perform 8 rounds
+      SHA512_ROUND(a, b, c, d, e, f, g, h, wk[t]);
+      SHA512_ROUND(h, a, b, c, d, e, f, g, wk[t + 1]);
+      SHA512_ROUND(g, h, a, b, c, d, e, f, wk[t + 2]);
+      SHA512_ROUND(f, g, h, a, b, c, d, e, wk[t + 3]);
+      SHA512_ROUND(e, f, g, h, a, b, c, d, wk[t + 4]);
+      SHA512_ROUND(d, e, f, g, h, a, b, c, wk[t + 5]);
+      SHA512_ROUND(c, d, e, f, g, h, a, b, wk[t + 6]);
+      SHA512_ROUND(b, c, d, e, f, g, h, a, wk[t + 7]);
+   }
+
+   //Update the hash value
+   context->h[0] += a;
+   context->h[1] += b;
+   context->h[2] += c;
+   context->h[3] += d;
+   context->h[4] += e;
+   context->h[5] += f;
+   context->h[6] += g;
+   context->h[7] += h;
+}
+
+#endif
+
+
 /**
  * @brief Process message in 16-word blocks
  * @param[in] context Pointer to the SHA-512 context
@@ -256,19 +503,37 @@ void sha512ProcessBlock(Sha512Context *context)
    uint_t t;
    uint64_t temp1;
    uint64_t temp2;
+   uint64_t a;
+   uint64_t b;
+   uint64_t c;
+   uint64_t d;
+   uint64_t e;
+   uint64_t f;
+   uint64_t g;
+   uint64_t h;
+   uint64_t *w;
+
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //Compute the message schedule with AVX2 instructions when available
+   if((cpuGetFeatures() & CPU_FEATURE_AVX2) != 0)
+   {
+      sha512Avx2ProcessBlock(context);
+      return;
+   }
+#endif
 
    //Initialize the 8 working registers
-   uint64_t a = context->h[0];
-   uint64_t b = context->h[1];
-   uint64_t c = context->h[2];
-   uint64_t d = context->h[3];
-   uint64_t e = context->h[4];
-   uint64_t f = context->h[5];
-   uint64_t g = context->h[6];
-   uint64_t h = context->h[7];
+   a = context->h[0];
+   b = context->h[1];
+   c = context->h[2];
+   d = context->h[3];
+   e = context->h[4];
+   f = context->h[5];
+   g = context->h[6];
+   h = context->h[7];
 
    //Process message in 16-word blocks
-   uint64_t *w = context->w;
+   w = context->w;
 
    //Convert from big-endian byte order to host byte order
    for(t = 0; t < 16; t++)
@@ -307,4 +572,453 @@ void sha512ProcessBlock(Sha512Context *context)
    context->h[7] += h;
 }
 
+
+//SIMD support on x86 targets?
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+
+//Number of lanes of the multi-buffer implementation
+#define SHA512_LANES 4
+
+//Workspace of the multi-buffer implementation
+#define WV(t) w[(t) & 0x0F]
+
+/**
+ * @brief Lane of the multi-buffer implementation
+ **/
+
+typedef struct
+{
+   Sha512Message *message; ///<Message being hashed (NULL if the lane is idle)
+   const uint8_t *data;    ///<Next block to be processed
+   size_t n;               ///<Number of contiguous blocks left in the current segment
+   bool_t last;            ///<The current segment holds the padded final blocks
+   uint8_t buffer[256];    ///<Padded final blocks
+} Sha512Lane;
+
+
+/**
+ * @brief Process blocks of 4 independent messages using AVX2 instructions
+ * @param[in,out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] data Pointers to the blocks of each lane
+ * @param[in] n Number of consecutive blocks to process in each lane
+ **/
+
+CPU_TARGET("avx2") static void sha512Avx2ProcessBlocks(uint64_t *h,
+   const uint8_t **data, size_t n)
+{
+   uint_t i;
+   uint_t t;
+   size_t j;
+   __m256i a, b, c, d, e, f, g, hh;
+   __m256i temp1;
+   __m256i temp2;
+   __m256i s[8];
+   __m256i w[16];
+   const uint8_t *p[SHA512_LANES];
+
+   //Load the intermediate hash values
+   for(i = 0; i < 8; i++)
+      s[i] = _mm256_loadu_si256((__m256i *) (h + SHA512_LANES * i));
+
+   //Point to the first block of each lane
+   for(i = 0; i < SHA512_LANES; i++)
+      p[i] = data[i];
+
+   //Process the blocks
+   for(j = 0; j < n; j++)
+   {
+      //Convert from big-endian byte order to host byte order
+      for(t = 0; t < 16; t++)
+      {
+         w[t] = _mm256_set_epi64x(LOAD64BE(p[3] + 8 * t), LOAD64BE(p[2] + 8 * t),
+            LOAD64BE(p[1] + 8 * t), LOAD64BE(p[0] + 8 * t));
+      }
+
+      //Initialize the 8 working registers
+      a = s[0];
+      b = s[1];
+      c = s[2];
+      d = s[3];
+      e = s[4];
+      f = s[5];
+      g = s[6];
+      hh = s[7];
+
+      //SHA-512 hash computation
+      for(t = 0; t < 80; t += 8)
+      {
+         SHA512_AVX2_ROUND(a, b, c, d, e, f, g, hh, t);
+         SHA512_AVX2_ROUND(hh, a, b, c, d, e, f, g, t + 1);
+         SHA512_AVX2_ROUND(g, hh, a, b, c, d, e, f, t + 2);
+         SHA512_AVX2_ROUND(f, g, hh, a, b, c, d, e, t + 3);
+         SHA512_AVX2_ROUND(e, f, g, hh, a, b, c, d, t + 4);
+         SHA512_AVX2_ROUND(d, e, f, g, hh, a, b, c, t + 5);
+         SHA512_AVX2_ROUND(c, d, e, f, g, hh, a, b, t + 6);
+         SHA512_AVX2_ROUND(b, c, d, e, f, g, hh, a, t + 7);
+      }
+
+      //Update the hash values
+      s[0] = _mm256_add_epi64(s[0], a);
+      s[1] = _mm256_add_epi64(s[1], b);
+      s[2] = _mm256_add_epi64(s[2], c);
+      s[3] = _mm256_add_epi64(s[3], d);
+      s[4] = _mm256_add_epi64(s[4], e);
+      s[5] = _mm256_add_epi64(s[5], f);
+      s[6] = _mm256_add_epi64(s[6], g);
+      s[7] = _mm256_add_epi64(s[7], hh);
+
+      //Next blocks
+      for(i = 0; i < SHA512_LANES; i++)
+         p[i] += 128;
+   }
+
+   //Save the intermediate hash values
+   for(i = 0; i < 8; i++)
+      _mm256_storeu_si256((__m256i *) (h + SHA512_LANES * i), s[i]);
+}
+
+
+/**
+ * @brief Assign a message to a lane
+ * @param[in] hash Hash algorithm (SHA-512 or truncated variant)
+ * @param[out] lane Lane of the multi-buffer implementation
+ * @param[out] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] j Index of the lane
+ * @param[in] message Message to be hashed
+ **/
+
+static void sha512StartLane(const HashAlgo *hash, Sha512Lane *lane,
+   uint64_t *h, uint_t j, Sha512Message *message)
+{
+   uint_t i;
+   Sha512Context context;
+
+   //Set initial hash value
+   hash->init(&context);
+
+   for(i = 0; i < 8; i++)
+      h[i * SHA512_LANES + j] = context.h[i];
+
+   //The complete blocks are processed directly from the message
+   lane->message = message;
+   lane->data = message->data;
+   lane->n = message->length / 128;
+   lane->last = FALSE;
+}
+
+
+/**
+ * @brief Prepare the padded final blocks of a lane
+ * @param[in,out] lane Lane of the multi-buffer implementation
+ **/
+
+static void sha512PadLane(Sha512Lane *lane)
+{
+   size_t r;
+   size_t n;
+   uint64_t totalSize;
+
+   //Number of bytes of the message that do not fill a complete block
+   r = lane->message->length % 128;
+   //The padding brings the length to a multiple of 128 bytes
+   n = (r < 112) ? 128 : 256;
+
+   //Copy the remaining bytes of the message
+   if(r > 0)
+      memcpy(lane->buffer, lane->data, r);
+
+   //Append the padding
+   lane->buffer[r] = 0x80;
+   memset(lane->buffer + r + 1, 0, n - r - 9);
+
+   //Append the length of the original message
+   totalSize = (uint64_t) lane->message->length * 8;
+   STORE64BE(totalSize, lane->buffer + n - 8);
+
+   //Process the final blocks
+   lane->data = lane->buffer;
+   lane->n = n / 128;
+   lane->last = TRUE;
+}
+
+
+/**
+ * @brief Finish hashing the message of a lane with the single-buffer code
+ * @param[in] hash Hash algorithm (SHA-512 or truncated variant)
+ * @param[in,out] lane Lane of the multi-buffer implementation
+ * @param[in] h Intermediate hash values (structure-of-arrays layout)
+ * @param[in] j Index of the lane
+ **/
+
+static void sha512FinishLane(const HashAlgo *hash, Sha512Lane *lane,
+   const uint64_t *h, uint_t j)
+{
+   uint_t i;
+   size_t n;
+   Sha512Context context;
+
+   //Retrieve the intermediate hash value
+   for(i = 0; i < 8; i++)
+      context.h[i] = h[i * SHA512_LANES + j];
+
+   //Final blocks?
+   if(lane->last)
+   {
+      //Process the remaining padded blocks
+      for(i = 0; i < lane->n; i++)
+      {
+         memcpy(context.buffer, lane->data + i * 128, 128);
+         sha512ProcessBlock(&context);
+      }
+
+      //Convert from host byte order to big-endian byte order
+      for(i = 0; i < 8; i++)
+         context.h[i] = htobe64(context.h[i]);
+
+      //Copy the resulting digest
+      memcpy(lane->message->digest, context.digest, hash->digestSize);
+   }
+   else
+   {
+      //Number of bytes already processed
+      n = lane->data - (const uint8_t *) lane->message->data;
+
+      //Resume the computation
+      context.size = 0;
+      context.totalSize = n;
+
+      //Digest the rest of the message
+      hash->update(&context, lane->data, lane->message->length - n);
+      hash->final(&context, lane->message->digest);
+   }
+
+   //The lane is now idle
+   lane->message = NULL;
+}
+
+#endif
+
+
+/**
+ * @brief Digest several independent messages using SHA-512
+ * @param[in,out] messages Array of messages
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
+
+error_t sha512ComputeMulti(Sha512Message *messages, uint_t count)
+{
+   //Digest the messages
+   return sha512ComputeMultiEx(SHA512_HASH_ALGO, messages, count);
+}
+
+
+/**
+ * @brief Digest several independent messages using SHA-512 or a variant
+ *
+ * When AVX2 instructions are available, 4 messages are hashed in parallel,
+ * one message per lane. A lane is refilled with the next pending message
+ * as soon as its current message is complete. The digests are identical to
+ * those produced by the compute function of the hash algorithm
+ *
+ * @param[in] hash Hash algorithm (SHA-512, SHA-384, SHA-512/224 or SHA-512/256)
+ * @param[in,out] messages Array of messages
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
+
+error_t sha512ComputeMultiEx(const HashAlgo *hash, Sha512Message *messages,
+   uint_t count)
+{
+   error_t error;
+   uint_t i;
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   uint_t j;
+   uint_t next;
+   uint_t active;
+   size_t n;
+   const uint8_t *busy;
+   const uint8_t *data[SHA512_LANES];
+   uint64_t h[8 * SHA512_LANES];
+   Sha512Lane lane[SHA512_LANES];
+#endif
+
+   //Check parameters
+   if(hash == NULL || (messages == NULL && count != 0))
+      return ERROR_INVALID_PARAMETER;
+
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //Multi-buffer implementation available?
+   if((cpuGetFeatures() & CPU_FEATURE_AVX2) != 0)
+   {
+      //All the lanes are idle
+      for(j = 0; j < SHA512_LANES; j++)
+         lane[j].message = NULL;
+
+      //Process the messages
+      for(next = 0, active = 0; next < count || active > 0; )
+      {
+         //Assign pending messages to the idle lanes
+         for(j = 0; j < SHA512_LANES && next < count; j++)
+         {
+            if(lane[j].message == NULL)
+            {
+               sha512StartLane(hash, &lane[j], h, j, &messages[next++]);
+               active++;
+
+               //Short messages consist of the padded final blocks only
+               if(lane[j].n == 0)
+                  sha512PadLane(&lane[j]);
+            }
+         }
+
+         //When a single lane remains busy, the single-buffer code is faster
+         if(next >= count && active <= 1)
+         {
+            for(j = 0; j < SHA512_LANES; j++)
+            {
+               if(lane[j].message != NULL)
+                  sha512FinishLane(hash, &lane[j], h, j);
+            }
+
+            //All the messages have been processed
+            break;
+         }
+
+         //Number of blocks that can be processed in every busy lane
+         for(n = 0, j = 0; j < SHA512_LANES; j++)
+         {
+            if(lane[j].message != NULL && (n == 0 || lane[j].n < n))
+               n = lane[j].n;
+         }
+
+         //Point to the next blocks of the busy lanes
+         for(j = 0, busy = NULL; j < SHA512_LANES; j++)
+         {
+            if(lane[j].message != NULL)
+               busy = lane[j].data;
+         }
+
+         //Idle lanes process the blocks of a busy lane, and their results
+         //are discarded
+         for(j = 0; j < SHA512_LANES; j++)
+            data[j] = (lane[j].message != NULL) ? lane[j].data : busy;
+
+         //Process n blocks of each lane
+         sha512Avx2ProcessBlocks(h, data, n);
+
+         //Update the state of the busy lanes
+         for(j = 0; j < SHA512_LANES; j++)
+         {
+            if(lane[j].message != NULL)
+            {
+               lane[j].data += n * 128;
+               lane[j].n -= n;
+
+               //End of the current segment?
+               if(lane[j].n == 0)
+               {
+                  //Complete blocks processed?
+                  if(!lane[j].last)
+                  {
+                     //Process the padded final blocks
+                     sha512PadLane(&lane[j]);
+                  }
+                  else
+                  {
+                     //Finalize the digest
+                     sha512FinishLane(hash, &lane[j], h, j);
+                     active--;
+                  }
+               }
+            }
+         }
+      }
+
+      //Successful processing
+      return NO_ERROR;
+   }
+#endif
+
+   //Process the messages one after the other
+   for(error = NO_ERROR, i = 0; i < count && !error; i++)
+   {
+      error = hash->compute(messages[i].data, messages[i].length,
+         messages[i].digest);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Process one block for each of several SHA-512 contexts
+ *
+ * The block held in the buffer of each context is processed and the
+ * intermediate hash value of the context is updated accordingly, as
+ * sha512ProcessBlock would do. The other fields of the contexts are left
+ * unchanged. When AVX2 instructions are available, 4 blocks are processed
+ * in parallel, one context per lane
+ *
+ * @param[in,out] context Array of pointers to the SHA-512 contexts
+ * @param[in] count Number of contexts
+ **/
+
+void sha512ProcessBlockMulti(Sha512Context **context, uint_t count)
+{
+   uint_t i;
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   uint_t j;
+   uint_t k;
+   uint_t n;
+   const uint8_t *data[SHA512_LANES];
+   uint64_t h[8 * SHA512_LANES];
+#endif
+
+   //Index of the first context to be processed
+   i = 0;
+
+#if (SIMD_SUPPORT == ENABLED && defined(CPU_FEATURES_X86))
+   //Multi-buffer implementation available?
+   if((cpuGetFeatures() & CPU_FEATURE_AVX2) != 0)
+   {
+      //Process the contexts by groups of at most 4 contexts
+      for(; i < count; i += n)
+      {
+         //Number of busy lanes
+         n = MIN(count - i, SHA512_LANES);
+
+         //When a single lane would be busy, the single-buffer code is faster
+         if(n <= 1)
+            break;
+
+         //Idle lanes process the block of the first context, and their
+         //results are discarded
+         for(j = 0; j < SHA512_LANES; j++)
+         {
+            data[j] = context[(j < n) ? i + j : i]->buffer;
+
+            for(k = 0; k < 8; k++)
+               h[k * SHA512_LANES + j] = context[(j < n) ? i + j : i]->h[k];
+         }
+
+         //Process one block of each lane
+         sha512Avx2ProcessBlocks(h, data, 1);
+
+         //Update the intermediate hash values of the contexts
+         for(j = 0; j < n; j++)
+         {
+            for(k = 0; k < 8; k++)
+               context[i + j]->h[k] = h[k * SHA512_LANES + j];
+         }
+      }
+   }
+#endif
+
+   //Process the remaining contexts one after the other
+   for(; i < count; i++)
+      sha512ProcessBlock(context[i]);
+}
+
 #endif
@@ -36,6 +36,8 @@
 #define SHA512_BLOCK_SIZE 128
 //SHA-512 digest size
 #define SHA512_DIGEST_SIZE 64
+//SHA-512 maximum size of the exported state
+#define SHA512_STATE_SIZE (SHA512_DIGEST_SIZE + 8 + SHA512_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define SHA512_HASH_ALGO (&sha512HashAlgo)
 
@@ -66,6 +68,18 @@ typedef struct
 } Sha512Context;
 
 
+/**
+ * @brief Message descriptor (multi-buffer hashing)
+ **/
+
+typedef struct
+{
+   const void *data; ///<Message to be hashed
+   size_t length;    ///<Length of the message
+   uint8_t *digest;  ///<Resulting digest
+} Sha512Message;
+
+
 //SHA-512 related constants
 extern const HashAlgo sha512HashAlgo;
 
@@ -74,8 +88,18 @@ error_t sha512Compute(const void *data, size_t length, uint8_t *digest);
 void sha512Init(Sha512Context *context);
 void sha512Update(Sha512Context *context, const void *data, size_t length);
 void sha512Final(Sha512Context *context, uint8_t *digest);
+void sha512Clone(Sha512Context *destContext, const Sha512Context *srcContext);
+size_t sha512ExportState(const Sha512Context *context, uint8_t *output);
+error_t sha512ImportState(Sha512Context *context, const uint8_t *input, size_t length);
 void sha512ProcessBlock(Sha512Context *context);
 
+error_t sha512ComputeMulti(Sha512Message *messages, uint_t count);
+
+error_t sha512ComputeMultiEx(const HashAlgo *hash, Sha512Message *messages,
+   uint_t count);
+
+void sha512ProcessBlockMulti(Sha512Context **context, uint_t count);
+
 //C++ guard
 #ifdef __cplusplus
    }
@@ -54,10 +54,14 @@ const HashAlgo sha512_224HashAlgo =
    sizeof(Sha512_224Context),
    SHA512_224_BLOCK_SIZE,
    SHA512_224_DIGEST_SIZE,
+   SHA512_224_STATE_SIZE,
    (HashAlgoCompute) sha512_224Compute,
    (HashAlgoInit) sha512_224Init,
    (HashAlgoUpdate) sha512_224Update,
-   (HashAlgoFinal) sha512_224Final
+   (HashAlgoFinal) sha512_224Final,
+   (HashAlgoClone) sha512Clone,
+   (HashAlgoExportState) sha512ExportState,
+   (HashAlgoImportState) sha512ImportState
 };
 
 
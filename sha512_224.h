@@ -37,6 +37,8 @@
 #define SHA512_224_BLOCK_SIZE 128
 //SHA-512/224 digest size
 #define SHA512_224_DIGEST_SIZE 28
+//SHA-512/224 maximum size of the exported state
+#define SHA512_224_STATE_SIZE SHA512_STATE_SIZE
 //Common interface for hash algorithms
 #define SHA512_224_HASH_ALGO (&sha512_224HashAlgo)
 
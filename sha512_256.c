@@ -54,10 +54,14 @@ const HashAlgo sha512_256HashAlgo =
    sizeof(Sha512_256Context),
    SHA512_256_BLOCK_SIZE,
    SHA512_256_DIGEST_SIZE,
+   SHA512_256_STATE_SIZE,
    (HashAlgoCompute) sha512_256Compute,
    (HashAlgoInit) sha512_256Init,
    (HashAlgoUpdate) sha512_256Update,
-   (HashAlgoFinal) sha512_256Final
+   (HashAlgoFinal) sha512_256Final,
+   (HashAlgoClone) sha512Clone,
+   (HashAlgoExportState) sha512ExportState,
+   (HashAlgoImportState) sha512ImportState
 };
 
 
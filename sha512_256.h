@@ -37,6 +37,8 @@
 #define SHA512_256_BLOCK_SIZE 128
 //SHA-512/256 digest size
 #define SHA512_256_DIGEST_SIZE 32
+//SHA-512/256 maximum size of the exported state
+#define SHA512_256_STATE_SIZE SHA512_STATE_SIZE
 //Common interface for hash algorithms
 #define SHA512_256_HASH_ALGO (&sha512_256HashAlgo)
 
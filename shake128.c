@@ -134,4 +134,24 @@ void shake128Squeeze(Shake128Context *context, uint8_t *output, size_t length)
    keccakSqueeze(context, output, length);
 }
 
+
+/**
+ * @brief Process several independent messages using SHAKE128
+ *
+ * The messages are processed in parallel when possible (refer to
+ * keccakComputeMulti). The outputs are identical to those produced by
+ * shake128Compute
+ *
+ * @param[in,out] messages Array of messages
+ * @param[in] count Number of messages
+ * @return Error code
+ **/
+
+error_t shake128ComputeMulti(Shake128Message *messages, uint_t count)
+{
+   //SHAKE128 supports 128 bits of security strength (padding byte is 0x1F
+   //for XOFs)
+   return keccakComputeMulti(2 * 128, KECCAK_XOF_PAD, messages, count);
+}
+
 #endif
@@ -46,6 +46,13 @@
 typedef KeccakContext Shake128Context;
 
 
+/**
+ * @brief Message descriptor (multi-buffer processing)
+ **/
+
+typedef KeccakMessage Shake128Message;
+
+
 //SHAKE128 related constants
 extern const uint8_t shake128Oid[9];
 
@@ -57,6 +64,7 @@ void shake128Init(Shake128Context *context);
 void shake128Absorb(Shake128Context *context, const void *input, size_t length);
 void shake128Final(Shake128Context *context);
 void shake128Squeeze(Shake128Context *context, uint8_t *output, size_t length);
+error_t shake128ComputeMulti(Shake128Message *messages, uint_t count);
 
 //C++ guard
 #ifdef __cplusplus
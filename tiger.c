@@ -364,10 +364,14 @@ const HashAlgo tigerHashAlgo =
    sizeof(TigerContext),
    TIGER_BLOCK_SIZE,
    TIGER_DIGEST_SIZE,
+   TIGER_STATE_SIZE,
    (HashAlgoCompute) tigerCompute,
    (HashAlgoInit) tigerInit,
    (HashAlgoUpdate) tigerUpdate,
-   (HashAlgoFinal) tigerFinal
+   (HashAlgoFinal) tigerFinal,
+   (HashAlgoClone) tigerClone,
+   (HashAlgoExportState) tigerExportState,
+   (HashAlgoImportState) tigerImportState
 };
 
 
@@ -500,6 +504,104 @@ void tigerFinal(TigerContext *context, uint8_t *digest)
 }
 
 
+/**
+ * @brief Copy a Tiger context
+ *
+ * The intermediate hash value, the counters and the pending bytes are copied
+ *
+ * @param[out] destContext Pointer to the destination context
+ * @param[in] srcContext Pointer to the Tiger context to be copied
+ **/
+
+void tigerClone(TigerContext *destContext, const TigerContext *srcContext)
+{
+   //Copy the intermediate hash value
+   memcpy(destContext->h, srcContext->h, sizeof(srcContext->h));
+   //Copy the data that have not been processed yet
+   memcpy(destContext->buffer, srcContext->buffer, srcContext->size);
+
+   //Number of bytes in the buffer
+   destContext->size = srcContext->size;
+   //Total length of the message
+   destContext->totalSize = srcContext->totalSize;
+}
+
+
+/**
+ * @brief Export the state of a Tiger context
+ *
+ * The serialized state is made of the intermediate hash value (three
+ * little-endian 64-bit words), the total length of the message (big-endian
+ * 64-bit integer, in bytes) and the data that have not been processed yet
+ *
+ * @param[in] context Pointer to the Tiger context
+ * @param[out] output Serialized state (at most TIGER_STATE_SIZE bytes)
+ * @return Length of the serialized state
+ **/
+
+size_t tigerExportState(const TigerContext *context, uint8_t *output)
+{
+   uint_t i;
+
+   //Intermediate hash value
+   for(i = 0; i < 3; i++)
+      STORE64LE(context->h[i], output + i * 8);
+
+   //Total length of the message
+   STORE64BE(context->totalSize, output + TIGER_DIGEST_SIZE);
+   //Data that have not been processed yet
+   memcpy(output + TIGER_DIGEST_SIZE + 8, context->buffer, context->size);
+
+   //Return the length of the serialized state
+   return TIGER_DIGEST_SIZE + 8 + context->size;
+}
+
+
+/**
+ * @brief Import the state of a Tiger context
+ * @param[out] context Pointer to the Tiger context to initialize
+ * @param[in] input Serialized state (see tigerExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t tigerImportState(TigerContext *context, const uint8_t *input,
+   size_t length)
+{
+   uint_t i;
+   size_t n;
+   uint64_t totalSize;
+
+   //Check the length of the serialized state
+   if(length < (TIGER_DIGEST_SIZE + 8))
+      return ERROR_INVALID_LENGTH;
+
+   //Total length of the message
+   totalSize = LOAD64BE(input + TIGER_DIGEST_SIZE);
+   //Number of bytes that have not been processed yet
+   n = (size_t) (totalSize % TIGER_BLOCK_SIZE);
+
+   //The pending bytes must match the length of the message
+   if(length != (TIGER_DIGEST_SIZE + 8 + n))
+      return ERROR_INVALID_LENGTH;
+
+   //Intermediate hash value
+   for(i = 0; i < 3; i++)
+      context->h[i] = LOAD64LE(input + i * 8);
+
+   //Data that have not been processed yet
+   memcpy(context->buffer, input + TIGER_DIGEST_SIZE + 8, n);
+
+   //Number of bytes in the buffer
+   context->size = n;
+   //Total length of the message
+   context->totalSize = totalSize;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Process message in 16-word blocks
  * @param[in] context Pointer to the Tiger context
@@ -36,6 +36,8 @@
 #define TIGER_BLOCK_SIZE 64
 //Tiger digest size
 #define TIGER_DIGEST_SIZE 24
+//Tiger maximum size of the exported state
+#define TIGER_STATE_SIZE (TIGER_DIGEST_SIZE + 8 + TIGER_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define TIGER_HASH_ALGO (&tigerHashAlgo)
 
@@ -74,6 +76,9 @@ error_t tigerCompute(const void *data, size_t length, uint8_t *digest);
 void tigerInit(TigerContext *context);
 void tigerUpdate(TigerContext *context, const void *data, size_t length);
 void tigerFinal(TigerContext *context, uint8_t *digest);
+void tigerClone(TigerContext *destContext, const TigerContext *srcContext);
+size_t tigerExportState(const TigerContext *context, uint8_t *output);
+error_t tigerImportState(TigerContext *context, const uint8_t *input, size_t length);
 void tigerProcessBlock(TigerContext *context);
 
 //C++ guard
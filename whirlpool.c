@@ -161,10 +161,14 @@ const HashAlgo whirlpoolHashAlgo =
    sizeof(WhirlpoolContext),
    WHIRLPOOL_BLOCK_SIZE,
    WHIRLPOOL_DIGEST_SIZE,
+   WHIRLPOOL_STATE_SIZE,
    (HashAlgoCompute) whirlpoolCompute,
    (HashAlgoInit) whirlpoolInit,
    (HashAlgoUpdate) whirlpoolUpdate,
-   (HashAlgoFinal) whirlpoolFinal
+   (HashAlgoFinal) whirlpoolFinal,
+   (HashAlgoClone) whirlpoolClone,
+   (HashAlgoExportState) whirlpoolExportState,
+   (HashAlgoImportState) whirlpoolImportState
 };
 
 
@@ -301,6 +305,105 @@ void whirlpoolFinal(WhirlpoolContext *context, uint8_t *digest)
 }
 
 
+/**
+ * @brief Copy a Whirlpool context
+ *
+ * The intermediate hash value, the counters and the pending bytes are copied
+ *
+ * @param[out] destContext Pointer to the destination context
+ * @param[in] srcContext Pointer to the Whirlpool context to be copied
+ **/
+
+void whirlpoolClone(WhirlpoolContext *destContext,
+   const WhirlpoolContext *srcContext)
+{
+   //Copy the intermediate hash value
+   memcpy(destContext->h, srcContext->h, sizeof(srcContext->h));
+   //Copy the data that have not been processed yet
+   memcpy(destContext->buffer, srcContext->buffer, srcContext->size);
+
+   //Number of bytes in the buffer
+   destContext->size = srcContext->size;
+   //Total length of the message
+   destContext->totalSize = srcContext->totalSize;
+}
+
+
+/**
+ * @brief Export the state of a Whirlpool context
+ *
+ * The serialized state is made of the intermediate hash value (eight
+ * big-endian 64-bit words), the total length of the message (big-endian
+ * 64-bit integer, in bytes) and the data that have not been processed yet
+ *
+ * @param[in] context Pointer to the Whirlpool context
+ * @param[out] output Serialized state (at most WHIRLPOOL_STATE_SIZE bytes)
+ * @return Length of the serialized state
+ **/
+
+size_t whirlpoolExportState(const WhirlpoolContext *context, uint8_t *output)
+{
+   uint_t i;
+
+   //Intermediate hash value
+   for(i = 0; i < 8; i++)
+      STORE64BE(context->h[i], output + i * 8);
+
+   //Total length of the message
+   STORE64BE(context->totalSize, output + WHIRLPOOL_DIGEST_SIZE);
+   //Data that have not been processed yet
+   memcpy(output + WHIRLPOOL_DIGEST_SIZE + 8, context->buffer, context->size);
+
+   //Return the length of the serialized state
+   return WHIRLPOOL_DIGEST_SIZE + 8 + context->size;
+}
+
+
+/**
+ * @brief Import the state of a Whirlpool context
+ * @param[out] context Pointer to the Whirlpool context to initialize
+ * @param[in] input Serialized state (see whirlpoolExportState)
+ * @param[in] length Length of the serialized state
+ * @return Error code
+ **/
+
+error_t whirlpoolImportState(WhirlpoolContext *context, const uint8_t *input,
+   size_t length)
+{
+   uint_t i;
+   size_t n;
+   uint64_t totalSize;
+
+   //Check the length of the serialized state
+   if(length < (WHIRLPOOL_DIGEST_SIZE + 8))
+      return ERROR_INVALID_LENGTH;
+
+   //Total length of the message
+   totalSize = LOAD64BE(input + WHIRLPOOL_DIGEST_SIZE);
+   //Number of bytes that have not been processed yet
+   n = (size_t) (totalSize % WHIRLPOOL_BLOCK_SIZE);
+
+   //The pending bytes must match the length of the message
+   if(length != (WHIRLPOOL_DIGEST_SIZE + 8 + n))
+      return ERROR_INVALID_LENGTH;
+
+   //Intermediate hash value
+   for(i = 0; i < 8; i++)
+      context->h[i] = LOAD64BE(input + i * 8);
+
+   //Data that have not been processed yet
+   memcpy(context->buffer, input + WHIRLPOOL_DIGEST_SIZE + 8, n);
+
+   //Number of bytes in the buffer
+   context->size = n;
+   //Total length of the message
+   context->totalSize = totalSize;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Process message in 16-word blocks
  * @param[in] context Pointer to the Whirlpool context
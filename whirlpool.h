@@ -36,6 +36,8 @@
 #define WHIRLPOOL_BLOCK_SIZE 64
 //Whirlpool digest size
 #define WHIRLPOOL_DIGEST_SIZE 64
+//Whirlpool maximum size of the exported state
+#define WHIRLPOOL_STATE_SIZE (WHIRLPOOL_DIGEST_SIZE + 8 + WHIRLPOOL_BLOCK_SIZE - 1)
 //Common interface for hash algorithms
 #define WHIRLPOOL_HASH_ALGO (&whirlpoolHashAlgo)
 
@@ -79,6 +81,9 @@ error_t whirlpoolCompute(const void *data, size_t length, uint8_t *digest);
 void whirlpoolInit(WhirlpoolContext *context);
 void whirlpoolUpdate(WhirlpoolContext *context, const void *data, size_t length);
 void whirlpoolFinal(WhirlpoolContext *context, uint8_t *digest);
+void whirlpoolClone(WhirlpoolContext *destContext, const WhirlpoolContext *srcContext);
+size_t whirlpoolExportState(const WhirlpoolContext *context, uint8_t *output);
+error_t whirlpoolImportState(WhirlpoolContext *context, const uint8_t *input, size_t length);
 void whirlpoolProcessBlock(WhirlpoolContext *context);
 
 //C++ guard